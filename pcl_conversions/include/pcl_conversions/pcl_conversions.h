@@ -37,7 +37,11 @@
 #ifndef PCL_CONVERSIONS_H__
 #define PCL_CONVERSIONS_H__
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
 
 #include <rclcpp/rclcpp.hpp>
@@ -473,6 +477,147 @@ namespace pcl_conversions {
     moveToPCL(mesh.polygons, pcl_mesh.polygons);
   }
 
+  /** PointCloud2 field projection **/
+
+  /** Get the size in bytes of a PointField, 0 for an unknown datatype **/
+  inline
+  std::uint32_t getPointFieldSize(const sensor_msgs::msg::PointField &pf)
+  {
+    std::uint32_t size = 0;
+    switch (pf.datatype) {
+      case sensor_msgs::msg::PointField::INT8:
+      case sensor_msgs::msg::PointField::UINT8:
+        size = 1;
+        break;
+      case sensor_msgs::msg::PointField::INT16:
+      case sensor_msgs::msg::PointField::UINT16:
+        size = 2;
+        break;
+      case sensor_msgs::msg::PointField::INT32:
+      case sensor_msgs::msg::PointField::UINT32:
+      case sensor_msgs::msg::PointField::FLOAT32:
+        size = 4;
+        break;
+      case sensor_msgs::msg::PointField::FLOAT64:
+        size = 8;
+        break;
+    }
+    return size * std::max<std::uint32_t>(1, pf.count);
+  }
+
+  /** Copy \a count records of Size bytes from a strided buffer into a packed one. The size is a
+   * compile time constant so that each copy is a few register moves. **/
+  template<std::size_t Size>
+  void copyStrided(const std::uint8_t *src, std::size_t src_step, std::uint8_t *dst, std::size_t count)
+  {
+    for (std::size_t i = 0; i < count; ++i) {
+      std::memcpy(dst + i * Size, src + i * src_step, Size);
+    }
+  }
+
+  /** Call copyStrided for the common record sizes, return false for the other ones **/
+  inline
+  bool copyStrided(const std::uint8_t *src, std::size_t src_step, std::uint8_t *dst,
+                   std::uint32_t size, std::size_t count)
+  {
+    switch (size) {
+      case 4:
+        copyStrided<4>(src, src_step, dst, count);
+        return true;
+      case 8:
+        copyStrided<8>(src, src_step, dst, count);
+        return true;
+      case 12:
+        copyStrided<12>(src, src_step, dst, count);
+        return true;
+      case 16:
+        copyStrided<16>(src, src_step, dst, count);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /** Copy the named fields of a PointCloud2 into a cloud whose points only hold these fields,
+   * packed in the order of the input fields without padding. The layout is resolved once, fields
+   * that are next to each other in the input are copied together, and the points are copied in a
+   * single pass. Rows are not padded, the header and organization are kept.
+   * \param cloud the input point cloud
+   * \param field_names the names of the fields to keep
+   * \param projected the resultant point cloud, distinct from \a cloud
+   * \return false if a field is missing, or the layout of \a cloud does not match its data **/
+  inline
+  bool projectFields(const sensor_msgs::msg::PointCloud2 &cloud,
+                     const std::vector<std::string> &field_names,
+                     sensor_msgs::msg::PointCloud2 &projected)
+  {
+    struct Run
+    {
+      std::uint32_t src_offset;
+      std::uint32_t size;
+    };
+    for (const std::string &name : field_names) {
+      if (std::none_of(cloud.fields.begin(), cloud.fields.end(),
+          [&name](const sensor_msgs::msg::PointField &pf) {return pf.name == name;})) {
+        return false;
+      }
+    }
+    std::vector<sensor_msgs::msg::PointField> fields;
+    std::vector<Run> runs;
+    std::uint32_t point_step = 0;
+    for (const sensor_msgs::msg::PointField &pf : cloud.fields) {
+      if (std::find(field_names.begin(), field_names.end(), pf.name) == field_names.end()) {
+        continue;
+      }
+      const std::uint32_t size = getPointFieldSize(pf);
+      if (size == 0 || std::uint64_t(pf.offset) + size > cloud.point_step) {
+        return false;
+      }
+      fields.push_back(pf);
+      fields.back().offset = point_step;
+      if (!runs.empty() && runs.back().src_offset + runs.back().size == pf.offset) {
+        runs.back().size += size;
+      } else {
+        runs.push_back(Run{pf.offset, size});
+      }
+      point_step += size;
+    }
+    if (cloud.width > 0 && cloud.height > 0 &&
+        (std::uint64_t(cloud.width) * cloud.point_step > cloud.row_step ||
+         std::uint64_t(cloud.height) * cloud.row_step > cloud.data.size())) {
+      return false;
+    }
+
+    projected.header = cloud.header;
+    projected.height = cloud.height;
+    projected.width = cloud.width;
+    projected.fields = std::move(fields);
+    projected.is_bigendian = cloud.is_bigendian;
+    projected.point_step = point_step;
+    projected.row_step = cloud.width * point_step;
+    projected.is_dense = cloud.is_dense;
+    projected.data.resize(std::size_t(projected.row_step) * projected.height);
+
+    for (std::size_t row = 0; row < cloud.height; ++row) {
+      const std::uint8_t *src = cloud.data.data() + row * cloud.row_step;
+      std::uint8_t *dst = projected.data.data() + row * projected.row_step;
+      // A single run, typically x, y and z, is a fixed size copy per point
+      if (runs.size() == 1 &&
+          copyStrided(src + runs[0].src_offset, cloud.point_step, dst, point_step, cloud.width)) {
+        continue;
+      }
+      for (std::size_t i = 0; i < cloud.width; ++i) {
+        std::uint8_t *out = dst + i * point_step;
+        for (const Run &run : runs) {
+          std::memcpy(out, src + run.src_offset, run.size);
+          out += run.size;
+        }
+        src += cloud.point_step;
+      }
+    }
+    return true;
+  }
+
 } // namespace pcl_conversions
 
 namespace pcl {
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <string>
 
 #include "gtest/gtest.h"
@@ -102,6 +103,71 @@ TEST_F(PCLConversionTests, pointcloud2Conversion) {
   EXPECT_EQ(pcl_pc2.header.stamp, pcl_pc2_2.header.stamp);
 }
 
+sensor_msgs::msg::PointField makeField(const std::string &name, std::uint32_t offset,
+                                      std::uint8_t datatype) {
+  sensor_msgs::msg::PointField pf;
+  pf.name = name;
+  pf.offset = offset;
+  pf.datatype = datatype;
+  pf.count = 1;
+  return pf;
+}
+
+TEST(PCLConversionProjection, projectFields) {
+  // Two rows of three 32 byte points, with 4 bytes of padding after each row
+  sensor_msgs::msg::PointCloud2 cloud;
+  cloud.header.frame_id = "pcl";
+  cloud.height = 2;
+  cloud.width = 3;
+  cloud.point_step = 32;
+  cloud.row_step = 3 * 32 + 4;
+  cloud.fields.push_back(makeField("x", 0, sensor_msgs::msg::PointField::FLOAT32));
+  cloud.fields.push_back(makeField("y", 4, sensor_msgs::msg::PointField::FLOAT32));
+  cloud.fields.push_back(makeField("z", 8, sensor_msgs::msg::PointField::FLOAT32));
+  cloud.fields.push_back(makeField("intensity", 16, sensor_msgs::msg::PointField::FLOAT32));
+  cloud.fields.push_back(makeField("ring", 20, sensor_msgs::msg::PointField::UINT16));
+  cloud.data.resize(cloud.row_step * cloud.height);
+  for (size_t i = 0; i < cloud.data.size(); ++i) {
+    cloud.data[i] = static_cast<std::uint8_t>(i * 7);
+  }
+
+  sensor_msgs::msg::PointCloud2 xyz;
+  ASSERT_TRUE(pcl_conversions::projectFields(cloud, {"x", "y", "z"}, xyz));
+  EXPECT_EQ(std::string("pcl"), xyz.header.frame_id);
+  EXPECT_EQ(2U, xyz.height);
+  EXPECT_EQ(3U, xyz.width);
+  EXPECT_EQ(12U, xyz.point_step);
+  EXPECT_EQ(36U, xyz.row_step);
+  ASSERT_EQ(3U, xyz.fields.size());
+  EXPECT_EQ(8U, xyz.fields[2].offset);
+  ASSERT_EQ(72U, xyz.data.size());
+  for (size_t row = 0; row < 2; ++row) {
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_EQ(0, memcmp(&xyz.data[row * 36 + i * 12],
+                          &cloud.data[row * cloud.row_step + i * 32], 12));
+    }
+  }
+
+  // The fields keep the order of the input
+  sensor_msgs::msg::PointCloud2 ring_x;
+  ASSERT_TRUE(pcl_conversions::projectFields(cloud, {"ring", "x"}, ring_x));
+  EXPECT_EQ(6U, ring_x.point_step);
+  ASSERT_EQ(2U, ring_x.fields.size());
+  EXPECT_EQ("x", ring_x.fields[0].name);
+  EXPECT_EQ("ring", ring_x.fields[1].name);
+  EXPECT_EQ(4U, ring_x.fields[1].offset);
+  for (size_t row = 0; row < 2; ++row) {
+    for (size_t i = 0; i < 3; ++i) {
+      const std::uint8_t *point = &cloud.data[row * cloud.row_step + i * 32];
+      EXPECT_EQ(0, memcmp(&ring_x.data[row * 18 + i * 6], point, 4));
+      EXPECT_EQ(0, memcmp(&ring_x.data[row * 18 + i * 6 + 4], point + 20, 2));
+    }
+  }
+
+  sensor_msgs::msg::PointCloud2 missing;
+  EXPECT_FALSE(pcl_conversions::projectFields(cloud, {"x", "rgb"}, missing));
+}
+
 } // namespace
 
 
@@ -0,0 +1,177 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__BOX_SET_HPP_
+#define PCL_ROS__FILTERS__BOX_SET_HPP_
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+
+namespace pcl_ros
+{
+/** \brief A box given in its own frame, with an optional pose in the frame of the points. */
+struct OrientedBox
+{
+  /** \brief The minimum corner of the box, in the box frame. */
+  float min_pt[3];
+  /** \brief The maximum corner of the box, in the box frame. */
+  float max_pt[3];
+  /** \brief The x, y, z, roll, pitch and yaw of the box frame, like pcl::CropBox translation and
+    * rotation. All zero for an axis aligned box.
+    */
+  float pose[6];
+  /** \brief Set to true to remove the points inside of the box, instead of keeping them. */
+  bool subtract;
+};
+
+/** \brief @b BoxSet tests points against a set of boxes at once: a point is inside of the set if
+  * it is inside of at least one union box (or if there are none) and outside of all subtract
+  * boxes. Boxes are inclusive, like in pcl::CropBox.
+  *
+  * Points are tested in blocks. The boxes are stored in a bounding volume hierarchy of their
+  * bounding boxes, which is queried once per block with the bounding box of its points, so
+  * blocks outside of the combined bounding box are rejected at once and only the boxes near a
+  * block are tested. Each candidate box is then tested over the whole block in a branch free
+  * loop that the compiler can vectorize.
+  */
+class BoxSet
+{
+public:
+  /** \brief Set the boxes and build the hierarchy.
+    * \param boxes the boxes
+    */
+  void
+  assign(const std::vector<OrientedBox> & boxes);
+
+  /** \brief Test whether the set has no box. */
+  inline bool
+  empty() const {return boxes_.empty();}
+
+  /** \brief Overwrite the x, y and z values of the points of \a cloud that are not in the set
+    * (or that are in the set, if \a negative) with NaN, like pcl::CropBox with keep_organized.
+    * \param cloud the point cloud to filter in place
+    * \param xyz the offsets of the x, y and z fields
+    * \param negative set to true to mask the points inside of the set instead
+    */
+  void
+  mask(sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, bool negative) const;
+
+  /** \brief Select the finite points of \a cloud that are in the set (or that are not in the set,
+    * if \a negative), like pcl::CropBox without keep_organized.
+    * \param cloud the input point cloud
+    * \param xyz the offsets of the x, y and z fields
+    * \param negative set to true to select the points outside of the set instead
+    * \param indices an optional subset of the points to consider (may be nullptr)
+    * \param selected the resultant indices of the selected points
+    */
+  void
+  select(
+    const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, bool negative,
+    const std::vector<int> * indices, std::vector<int> & selected) const;
+
+  /** \brief Test a block of points given as separate coordinate arrays.
+    * \param x the x values of the points
+    * \param y the y values of the points
+    * \param z the z values of the points
+    * \param n the number of points, at most kBlockSize
+    * \param negative set to true to flag the points outside of the set instead
+    * \param inside the resultant flags, 1 for the points in the set
+    */
+  void
+  testBlock(
+    const float * x, const float * y, const float * z, std::size_t n, bool negative,
+    std::uint8_t * inside) const;
+
+  /** \brief Maximum number of points of testBlock (). */
+  static constexpr std::size_t kBlockSize = 256;
+
+private:
+  /** \brief A box as a transform from the point frame into the box frame, and its extent. */
+  struct Box
+  {
+    float rotation[3][3];
+    float offset[3];
+    float min_pt[3];
+    float max_pt[3];
+    bool aligned;
+    bool subtract;
+  };
+
+  /** \brief A node of the hierarchy, a leaf if \a count is not zero. */
+  struct Node
+  {
+    float min_pt[3];
+    float max_pt[3];
+    /** \brief The first child (the second child follows it), or the first box of a leaf. */
+    std::uint32_t first;
+    std::uint32_t count;
+  };
+
+  /** \brief Build the node \a node_id over the boxes \a order [begin; end), reordering them.
+    * \param order the ids of the boxes in \a bounds_
+    * \param node_id the node to build
+    * \param begin the first box of the node in \a order
+    * \param end the end of the boxes of the node in \a order
+    */
+  void
+  build(
+    std::vector<std::uint32_t> & order, std::size_t node_id, std::size_t begin,
+    std::size_t end);
+
+  /** \brief Collect the boxes whose bounding box intersects [min_pt; max_pt]. */
+  void
+  query(const float * min_pt, const float * max_pt, std::vector<std::uint32_t> & found) const;
+
+  /** \brief The boxes, in the order of the leaves of the hierarchy. */
+  std::vector<Box> boxes_;
+
+  /** \brief The bounding boxes of \a boxes_ in the point frame, as min x, y, z, max x, y, z. */
+  std::vector<float> bounds_;
+
+  /** \brief The hierarchy, the root is the bounding box of all the boxes. */
+  std::vector<Node> nodes_;
+
+  /** \brief Set to true if there is at least one union box. */
+  bool has_union_ = false;
+
+  /** \brief Set to true if there is at least one subtract box. */
+  bool has_subtract_ = false;
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__BOX_SET_HPP_
@@ -0,0 +1,128 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PCL_ROS__FILTERS__BUFFER_POOL_HPP_
+#define PCL_ROS__FILTERS__BUFFER_POOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace pcl_ros
+{
+/** \brief @b BufferPool keeps the data buffers of published PointCloud2 messages, so that the
+  * next output of a node can reuse one instead of allocating a new one.
+  *
+  * Free buffers are kept ordered by capacity, and a request takes the smallest buffer large
+  * enough for the requested size, or the largest one available. The total capacity of the free
+  * buffers is bounded, buffers released beyond it are freed.
+  */
+class BufferPool
+{
+public:
+  /** \brief Counters of the pool, since it was created. */
+  struct Statistics
+  {
+    /** \brief Number of buffers handed out by acquire (). */
+    std::uint64_t acquired = 0;
+    /** \brief Number of acquired buffers too small for the data written to them, including the
+      * empty buffers handed out when the pool had none, i.e. outputs that were allocated anyway.
+      */
+    std::uint64_t misses = 0;
+    /** \brief Number of buffers given back with release (). */
+    std::uint64_t released = 0;
+    /** \brief Number of released buffers freed because the pool was full. */
+    std::uint64_t evicted = 0;
+    /** \brief Number and total capacity of the free buffers currently in the pool. */
+    std::size_t pooled_buffers = 0;
+    std::size_t pooled_bytes = 0;
+  };
+
+  /** \brief Constructor.
+    * \param max_bytes the maximum total capacity of the free buffers, 0 disables the pool
+    */
+  explicit BufferPool(std::size_t max_bytes = 0)
+  : max_bytes_(max_bytes) {}
+
+  /** \brief Set the maximum total capacity of the free buffers, freeing the largest buffers if
+    * the pool holds more.
+    * \param max_bytes the maximum total capacity of the free buffers, 0 disables the pool
+    */
+  void
+  setMaxBytes(std::size_t max_bytes);
+
+  /** \brief Return true if the pool keeps any buffer. */
+  bool
+  enabled() const
+  {
+    return max_bytes_ > 0;
+  }
+
+  /** \brief Take a free buffer out of the pool. The buffer is empty, and its capacity is at least
+    * \a size if the pool has such a buffer.
+    * \param size the expected size of the data
+    */
+  std::vector<std::uint8_t>
+  acquire(std::size_t size);
+
+  /** \brief Count whether a buffer handed out by acquire () could hold the data written to it. A
+    * buffer smaller than the data was reallocated, which counts as a miss.
+    * \param capacity the capacity of the buffer when it was acquired
+    * \param size the size of the data written to it
+    */
+  void
+  reportUse(std::size_t capacity, std::size_t size);
+
+  /** \brief Give a buffer back to the pool. The buffer is left empty.
+    * \param buffer the buffer to recycle
+    */
+  void
+  release(std::vector<std::uint8_t> && buffer);
+
+  /** \brief Return a copy of the counters of the pool. */
+  Statistics
+  statistics() const;
+
+private:
+  std::size_t max_bytes_;
+
+  mutable std::mutex mutex_;
+  std::multimap<std::size_t, std::vector<std::uint8_t>> buffers_;
+  Statistics statistics_;
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__BUFFER_POOL_HPP_
@@ -0,0 +1,180 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#ifndef PCL_ROS__FILTERS__CONFIG_SNAPSHOT_HPP_
+#define PCL_ROS__FILTERS__CONFIG_SNAPSHOT_HPP_
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace pcl_ros
+{
+/** \brief @b ConfigSnapshot publishes the configuration of a filter as immutable snapshots.
+  *
+  * The parameter callback edits its own copy of the configuration and stores it when done, the
+  * processing path loads the latest snapshot and keeps using it for the whole frame. Neither
+  * waits for the other, and a frame never sees a half updated configuration.
+  */
+template<typename ConfigT>
+class ConfigSnapshot
+{
+public:
+  using ConstPtr = std::shared_ptr<const ConfigT>;
+
+  ConfigSnapshot()
+  : current_(new ConfigT) {}
+
+  /** \brief Return the latest snapshot. */
+  ConstPtr
+  load() const
+  {
+    return std::atomic_load(&current_);
+  }
+
+  /** \brief Publish a copy of \a config as the latest snapshot.
+    * \param config the new configuration
+    */
+  void
+  store(const ConfigT & config)
+  {
+    // Allocated with new, so that the aligned operator new of PCL and Eigen types is used
+    std::atomic_store(&current_, ConstPtr(new ConfigT(config)));
+  }
+
+private:
+  ConstPtr current_;
+};
+
+/** \brief @b ConfigCopy keeps a mutable copy of a snapshot, for the PCL filters whose
+  * setInputCloud () and filter () modify the object. The copy is only refreshed when a newer
+  * snapshot is given.
+  */
+template<typename ConfigT>
+class ConfigCopy
+{
+public:
+  /** \brief Return the copy of \a config, copying it if it is not the one copied last.
+    * \param config the latest snapshot
+    */
+  ConfigT &
+  get(const std::shared_ptr<const ConfigT> & config)
+  {
+    if (source_ != config) {
+      value_.reset(new ConfigT(*config));
+      source_ = config;
+    }
+    return *value_;
+  }
+
+private:
+  std::shared_ptr<const ConfigT> source_;
+  std::unique_ptr<ConfigT> value_;
+};
+
+/** \brief @b WorkspacePool hands a private workspace (mutable filter objects, scratch buffers) to
+  * each concurrent filter () call, and takes it back for the next calls when done. There are
+  * never more workspaces than concurrent calls, and their buffers keep their capacity.
+  */
+template<typename WorkspaceT>
+class WorkspacePool
+{
+public:
+  /** \brief A workspace taken from the pool, given back when destroyed. */
+  class Handle
+  {
+public:
+    Handle(WorkspacePool * pool, std::unique_ptr<WorkspaceT> workspace)
+    : pool_(pool), workspace_(std::move(workspace)) {}
+
+    Handle(Handle && other) = default;
+
+    ~Handle()
+    {
+      if (workspace_) {
+        pool_->release(std::move(workspace_));
+      }
+    }
+
+    WorkspaceT &
+    operator*() const
+    {
+      return *workspace_;
+    }
+
+    WorkspaceT *
+    operator->() const
+    {
+      return workspace_.get();
+    }
+
+private:
+    WorkspacePool * pool_;
+    std::unique_ptr<WorkspaceT> workspace_;
+  };
+
+  /** \brief Take a free workspace, or create one if all are in use. */
+  Handle
+  acquire()
+  {
+    std::unique_ptr<WorkspaceT> workspace;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_.empty()) {
+        workspace = std::move(free_.back());
+        free_.pop_back();
+      }
+    }
+    if (!workspace) {
+      workspace.reset(new WorkspaceT);
+    }
+    return Handle(this, std::move(workspace));
+  }
+
+private:
+  void
+  release(std::unique_ptr<WorkspaceT> workspace)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(std::move(workspace));
+  }
+
+  // Only held to move a pointer in or out, never while filtering
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<WorkspaceT>> free_;
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__CONFIG_SNAPSHOT_HPP_
@@ -41,8 +41,13 @@
 
 // PCL includes
 #include <pcl/filters/crop_box.h>
+#include <memory>
+#include <string>
 #include <vector>
+#include "pcl_ros/filters/box_set.hpp"
+#include "pcl_ros/filters/config_snapshot.hpp"
 #include "pcl_ros/filters/filter.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
 
 namespace pcl_ros
 {
@@ -62,9 +67,43 @@ protected:
     */
   inline void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) override;
 
+  /** \brief Compute the indices of the passing points directly on the PointCloud2 buffer.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output_indices the resultant indices into \a input
+    */
+  bool
+  filterIndices(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    std::vector<int> & output_indices) override;
+
+  /** \brief Crop the points selected by a received mask directly on the PointCloud2 buffer,
+    * without converting the mask into indices. Only for the single box of the min and max
+    * parameters, the boxes parameter goes through indices.
+    * \param input the input point cloud dataset
+    * \param mask the input set of points to use from \a input
+    * \param output the resultant filtered dataset
+    */
+  void
+  filterMasked(
+    const PointCloud2::ConstSharedPtr & input, const PointMask & mask,
+    PointCloud2 & output) override;
+
+  /** \brief Compute the mask of the passing points directly on the PointCloud2 buffer.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param mask the input set of points to use from \a input, preferred to \a indices (may be
+    * null)
+    * \param output_mask the resultant mask, of the size of \a input
+    */
+  bool
+  filterMask(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    const PointMask * mask, PointMask & output_mask) override;
+
   /** \brief Parameter callback
     * \param params parameter values to set
     */
@@ -74,8 +113,72 @@ protected:
   OnSetParametersCallbackHandle::SharedPtr callback_handle_;
 
 private:
-  /** \brief The PCL filter implementation used. */
-  pcl::CropBox<pcl::PCLPointCloud2> impl_;
+  typedef pcl::CropBox<pcl::PCLPointCloud2> Impl;
+
+  /** \brief The configuration of the filter, edited by config_callback and used by filter () as
+    * immutable snapshots.
+    */
+  struct Config
+  {
+    /** \brief The PCL filter implementation used. */
+    Impl impl;
+
+    /** \brief The boxes evaluated instead of the single box of \a impl, if not empty. */
+    BoxSet box_set;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  typedef std::shared_ptr<const Config> ConfigConstPtr;
+
+  /** \brief The private state of one filter () call. */
+  struct Workspace
+  {
+    /** \brief A copy of the PCL filter, which setInputCloud () modifies. */
+    ConfigCopy<Impl> impl;
+
+    /** \brief The indices of the selected points, reused between messages. */
+    std::vector<int> selected;
+  };
+
+  /** \brief The configuration edited by config_callback, under mutex_, and its snapshots. */
+  Config config_;
+  ConfigSnapshot<Config> snapshot_;
+  WorkspacePool<Workspace> workspaces_;
+
+  /** \brief Mask the points of an input cloud directly in its PointCloud2 buffer, without the
+    * round trip through pcl::PCLPointCloud2. Only valid in keep_organized mode.
+    * \param config the configuration to use
+    * \param input the input point cloud dataset
+    * \param output the resultant filtered dataset
+    * \return false if the cloud layout is not supported and the PCL filter must be used instead
+    */
+  bool
+  filterOrganized(const Config & config, const PointCloud2 & input, PointCloud2 & output);
+
+  /** \brief The box of the PCL filter of \a config, for the direct buffer kernels. */
+  static BoxRegion
+  getBoxRegion(const Config & config);
+
+  /** \brief Filter the input against the boxes of \a config, directly in the PointCloud2 buffers.
+    * \param config the configuration to use
+    * \param workspace the workspace of the call
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output the resultant filtered dataset
+    */
+  void
+  filterBoxes(
+    const Config & config, Workspace & workspace, const PointCloud2 & input,
+    const IndicesConstPtr & indices, PointCloud2 & output);
+
+  /** \brief Rebuild the boxes of \a config_ from the boxes, box_poses and box_modes parameters. */
+  void
+  updateBoxes();
+
+  /** \brief The raw values of the boxes, box_poses and box_modes parameters. */
+  std::vector<double> boxes_param_;
+  std::vector<double> box_poses_param_;
+  std::vector<std::string> box_modes_param_;
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -0,0 +1,149 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__CROP_POLYGON_HPP_
+#define PCL_ROS__FILTERS__CROP_POLYGON_HPP_
+
+#include <geometry_msgs/msg/polygon_stamped.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pcl_ros/filters/config_snapshot.hpp"
+#include "pcl_ros/filters/filter.hpp"
+#include "pcl_ros/filters/polygon_grid.hpp"
+
+namespace pcl_ros
+{
+/** \brief @b CropPolygon is a filter that keeps the points inside of a 2.5D prism: a static polygon
+  * in the x-y plane, given as a parameter or on a latched topic, extruded between two z values.
+  * It replaces ExtractPolygonalPrismData for static regions of interest, without a hull topic.
+  */
+class CropPolygon : public Filter
+{
+protected:
+  /** \brief Call the actual filter.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output the resultant filtered dataset
+    */
+  void
+  filter(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    PointCloud2 & output) override;
+
+  /** \brief Compute the indices of the passing points.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output_indices the resultant indices into \a input
+    */
+  bool
+  filterIndices(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    std::vector<int> & output_indices) override;
+
+  /** \brief Parameter callback
+    * \param params parameter values to set
+    */
+  rcl_interfaces::msg::SetParametersResult
+  config_callback(const std::vector<rclcpp::Parameter> & params);
+
+  OnSetParametersCallbackHandle::SharedPtr callback_handle_;
+
+private:
+  /** \brief The configuration of the filter, edited by config_callback and polygon_callback and
+    * used by filter () as immutable snapshots.
+    */
+  struct Config
+  {
+    /** \brief The polygon acceleration grid. */
+    PolygonGrid polygon;
+
+    /** \brief The frame of the latched polygon, empty if the polygon comes from the parameters. */
+    std::string polygon_frame;
+
+    /** \brief The z limits of the prism. */
+    double min_z = -1000.0;
+    double max_z = 1000.0;
+
+    /** \brief Set to true to keep the points outside of the prism instead. */
+    bool negative = false;
+
+    /** \brief Set to true to set the removed points to NaN instead of removing them. */
+    bool keep_organized = false;
+
+    /** \brief The number of threads testing the points, 0 for all cores. */
+    int num_threads = 0;
+  };
+
+  /** \brief The private state of one filter () call. */
+  struct Workspace
+  {
+    /** \brief The flags of the passing points and their indices, reused between messages. */
+    std::vector<std::uint8_t> keep;
+    std::vector<int> selected;
+  };
+
+  /** \brief Flag the passing points of \a input in the keep flags of \a workspace.
+    * \param config the configuration to use
+    * \param workspace the workspace of the call
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \return false if the polygon is not set or the cloud layout is not supported
+    */
+  bool
+  markPassing(
+    const Config & config, Workspace & workspace, const PointCloud2 & input,
+    const IndicesConstPtr & indices);
+
+  /** \brief Latched polygon callback. */
+  void
+  polygon_callback(const geometry_msgs::msg::PolygonStamped::ConstSharedPtr & polygon);
+
+  /** \brief The configuration edited under mutex_, and its snapshots. */
+  Config config_;
+  ConfigSnapshot<Config> snapshot_;
+  WorkspacePool<Workspace> workspaces_;
+
+  /** \brief The latched polygon subscriber, if use_polygon_topic is set. */
+  rclcpp::Subscription<geometry_msgs::msg::PolygonStamped>::SharedPtr sub_polygon_;
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  explicit CropPolygon(const rclcpp::NodeOptions & options);
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__CROP_POLYGON_HPP_
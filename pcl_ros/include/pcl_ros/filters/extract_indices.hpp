@@ -40,9 +40,12 @@
 
 // PCL includes
 #include <pcl/filters/extract_indices.h>
+#include <memory>
 #include <mutex>
 #include <vector>
+#include "pcl_ros/filters/config_snapshot.hpp"
 #include "pcl_ros/filters/filter.hpp"
+#include "pcl_ros/filters/point_mask.hpp"
 
 namespace pcl_ros
 {
@@ -60,9 +63,41 @@ protected:
     */
   inline void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) override;
 
+  /** \brief Compute the indices of the passing points without copying any point.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output_indices the resultant indices into \a input
+    */
+  bool
+  filterIndices(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    std::vector<int> & output_indices) override;
+
+  /** \brief Extract the points selected by a received mask, run by run without indices.
+    * \param input the input point cloud dataset
+    * \param mask the input set of points to use from \a input
+    * \param output the resultant filtered dataset
+    */
+  void
+  filterMasked(
+    const PointCloud2::ConstSharedPtr & input, const PointMask & mask,
+    PointCloud2 & output) override;
+
+  /** \brief Compute the mask of the passing points without going through indices.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param mask the input set of points to use from \a input, preferred to \a indices (may be
+    * null)
+    * \param output_mask the resultant mask, of the size of \a input
+    */
+  bool
+  filterMask(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    const PointMask * mask, PointMask & output_mask) override;
+
   /** \brief Parameter callback
     * \param params parameter values to set
     */
@@ -72,8 +107,49 @@ protected:
   OnSetParametersCallbackHandle::SharedPtr callback_handle_;
 
 private:
-  /** \brief The PCL filter implementation used. */
-  pcl::ExtractIndices<pcl::PCLPointCloud2> impl_;
+  typedef pcl::ExtractIndices<pcl::PCLPointCloud2> Impl;
+
+  /** \brief The configuration of the filter, edited by config_callback and used by filter () as
+    * immutable snapshots.
+    */
+  struct Config
+  {
+    /** \brief The PCL filter implementation used. */
+    Impl impl;
+
+    /** \brief The number of threads copying the selected points, 0 for all cores. */
+    int num_threads = 0;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  typedef std::shared_ptr<const Config> ConfigConstPtr;
+
+  /** \brief The private state of one filter () call. */
+  struct Workspace
+  {
+    /** \brief A copy of the PCL filter, which setInputCloud () modifies. */
+    ConfigCopy<Impl> impl;
+
+    /** \brief The selected points, reused between messages. */
+    PointMask mask;
+  };
+
+  /** \brief The configuration edited by config_callback, under mutex_, and its snapshots. */
+  Config config_;
+  ConfigSnapshot<Config> snapshot_;
+  WorkspacePool<Workspace> workspaces_;
+
+  /** \brief Set \a mask to the points selected by \a indices, or by all the points if \a indices
+    * is null, inverted if the negative flag of \a config is set.
+    * \param config the configuration to use
+    * \param nr_points the number of points of the input cloud
+    * \param indices the input set of indices (may be null)
+    * \param mask the resultant selected points
+    */
+  void
+  selectMask(
+    const Config & config, std::size_t nr_points, const IndicesConstPtr & indices,
+    PointMask & mask);
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -39,9 +39,19 @@
 #define PCL_ROS__FILTERS__FILTER_HPP_
 
 #include <pcl/filters/filter.h>
+#include <pcl_ros_interfaces/msg/bounded_point_cloud2.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
+#include "pcl_ros/filters/buffer_pool.hpp"
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/filters/point_mask.hpp"
 #include "pcl_ros/pcl_node.hpp"
 
 namespace pcl_ros
@@ -56,6 +66,7 @@ class Filter : public PCLNode<sensor_msgs::msg::PointCloud2>
 {
 public:
   typedef sensor_msgs::msg::PointCloud2 PointCloud2;
+  typedef sensor_msgs::msg::Image Image;
 
   typedef pcl::IndicesPtr IndicesPtr;
   typedef pcl::IndicesConstPtr IndicesConstPtr;
@@ -66,6 +77,19 @@ public:
     */
   Filter(std::string node_name, const rclcpp::NodeOptions & options);
 
+  /** \brief Stop the worker threads, see the num_workers parameter. The workers only use the
+    * node through a strong reference taken for each frame, so it is never destroyed while they
+    * filter, and children need no destructor of their own.
+    */
+  ~Filter() override;
+
+  /** \brief Return the counters of the output buffer pool, see the max_pool_bytes parameter. */
+  BufferPool::Statistics
+  poolStatistics() const
+  {
+    return output_pool_.statistics();
+  }
+
 protected:
   /** \brief declare and subscribe to param callback for input_frame and output_frame params */
   void
@@ -98,15 +122,14 @@ protected:
     */
   std::string tf_input_frame_;
 
-  /** \brief The original data input TF frame. */
-  std::string tf_input_orig_frame_;
-
   /** \brief The output TF frame the data should be transformed into,
     * if input.header.frame_id is different.
     */
   std::string tf_output_frame_;
 
-  /** \brief Internal mutex. */
+  /** \brief Internal mutex, serializing the parameter callbacks. Filters publish their
+    * configuration to filter () as ConfigSnapshot, so that filter () does not take it.
+    */
   std::mutex mutex_;
 
   /** \brief Virtual abstract filter method. To be implemented by every child.
@@ -116,7 +139,7 @@ protected:
     */
   virtual void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) = 0;
 
   /** \brief Lazy transport subscribe routine. */
@@ -127,14 +150,202 @@ protected:
   virtual void
   unsubscribe();
 
+  /** \brief Compute the indices of the input points that pass the filter, for output_mode set to
+    * indices or mask. Only filters whose output is a subset of their input points can implement it.
+    * \param input the input point cloud dataset.
+    * \param indices a pointer to the vector of point indices to use.
+    * \param output_indices the resultant indices into \a input
+    * \return false if the filter or this input is not supported, the cloud is published instead
+    */
+  virtual bool
+  filterIndices(
+    const PointCloud2::ConstSharedPtr & /*input*/, const IndicesConstPtr & /*indices*/,
+    std::vector<int> & /*output_indices*/)
+  {
+    return false;
+  }
+
+  /** \brief Filter the points of \a input selected by a mask received with mask_indices. The
+    * default converts the mask into indices for filter (), children that can read the mask in
+    * place override it.
+    * \param input the input point cloud dataset.
+    * \param mask the points to use, of the size of \a input
+    * \param output the resultant filtered PointCloud2
+    */
+  virtual void
+  filterMasked(
+    const PointCloud2::ConstSharedPtr & input, const PointMask & mask, PointCloud2 & output);
+
+  /** \brief Compute the input points that pass the filter as a mask, for output_mode set to mask
+    * or for a mask received with mask_indices. The default goes through filterIndices (),
+    * children that can produce the mask directly override it.
+    * \param input the input point cloud dataset.
+    * \param indices a pointer to the vector of point indices to use.
+    * \param mask the points to use instead of \a indices, if not null
+    * \param output_mask the resultant mask, of the size of \a input
+    * \return false if the filter or this input is not supported, the cloud is published instead
+    */
+  virtual bool
+  filterMask(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    const PointMask * mask, PointMask & output_mask);
+
+  /** \brief Call the child filter () method and optionally transform the result.
+    * \param input the input point cloud dataset.
+    * \param indices a pointer to the vector of point indices to use.
+    * \param input_frame the frame \a input was received in, the result is transformed back to
+    * it if no output frame is set.
+    * \param output the resultant filtered PointCloud2, whose buffers are reused if it is not empty
+    * \param mask the points to use instead of \a indices, if not null, see filterMasked ()
+    * \return false if the result could not be transformed into the output frame
+    */
+  bool
+  computeOutput(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    const std::string & input_frame, PointCloud2 & output, const PointMask * mask = nullptr);
+
+  /** \brief Keep only the fields of a received point cloud listed by the keep_fields parameter.
+    * \param cloud the received point cloud
+    * \return the repacked point cloud, \a cloud itself if keep_fields is empty, or nullptr if a
+    * field is missing
+    */
+  PointCloud2::ConstSharedPtr
+  projectInput(const PointCloud2::ConstSharedPtr & cloud);
+
   /** \brief Call the child filter () method, optionally transform the result, and publish it.
     * \param input the input point cloud dataset.
     * \param indices a pointer to the vector of point indices to use.
+    * \param input_frame the frame of the input as received, the frame of the output indices.
+    * \param mask the points to use instead of \a indices, if not null
     */
   void
-  computePublish(const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices);
+  computePublish(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    const std::string & input_frame, const PointMask * mask = nullptr);
+
+  /** \brief PointCloud2 + Indices data callback. */
+  void
+  input_indices_callback(
+    const PointCloud2::ConstSharedPtr & cloud,
+    const PointIndices::ConstSharedPtr & indices);
+
+  /** \brief Copy \a indices for a PCL filter, whose setIndices () only takes mutable indices.
+    * The direct paths read the indices of filter () in place instead.
+    * \param indices the indices given to filter (), may be null
+    */
+  static IndicesPtr
+  copyIndices(const IndicesConstPtr & indices)
+  {
+    return indices ? std::make_shared<pcl::Indices>(*indices) : IndicesPtr();
+  }
 
 private:
+  /** \brief Set to true to publish the indices of the passing points instead of a filtered cloud,
+    * see the output_mode parameter.
+    */
+  bool output_indices_;
+
+  /** \brief Set to true to publish the passing points as a mask, if \a output_indices_ is set. */
+  bool output_mask_;
+
+  /** \brief Set to true to receive the indices as a mask, see the mask_indices parameter. */
+  bool mask_indices_;
+
+  /** \brief The fields kept from the input point clouds, all of them if empty. */
+  std::vector<std::string> keep_fields_;
+
+  /** \brief The output PointIndices publisher, used if \a output_indices_ is set. */
+  rclcpp::Publisher<PointIndices>::SharedPtr pub_indices_;
+
+  /** \brief The output mask publisher, used if \a output_mask_ is set. */
+  rclcpp::Publisher<Image>::SharedPtr pub_mask_;
+
+  /** \brief The publisher of the output clouds in loaned messages, see the loan_output
+    * parameter. Only used if \a loan_output_ is set.
+    */
+  rclcpp::Publisher<pcl_ros_interfaces::msg::BoundedPointCloud2>::SharedPtr pub_bounded_;
+
+  /** \brief Set to true if loan_output is set and the middleware can loan the messages of
+    * \a pub_bounded_.
+    */
+  bool loan_output_;
+
+  /** \brief Set to true to reuse \a output_ and \a indices_output_ for every frame, see the
+    * realtime parameter.
+    */
+  bool realtime_;
+
+  /** \brief The output messages published in realtime mode. */
+  PointCloud2 output_;
+  PointIndices indices_output_;
+  PointMask point_mask_output_;
+  Image mask_output_;
+
+  /** \brief The data buffers of the published clouds, reused for the next outputs. */
+  BufferPool output_pool_;
+
+  /** \brief Set to true if the published clouds are serialized by publish (), so that their
+    * buffers can be recycled right after it. Intra-process subscribers own the message instead.
+    */
+  bool recycle_output_;
+
+  /** \brief The time the counters of \a output_pool_ were last published. */
+  std::atomic<std::int64_t> last_diagnostics_{0};
+
+  /** \brief The input and output frames used by the processing path, swapped as a whole by
+    * config_callback so that the workers can read them without locking.
+    */
+  struct TfFrames
+  {
+    std::string input_frame;
+    std::string output_frame;
+  };
+  std::shared_ptr<const TfFrames> tf_frames_;
+
+  /** \brief The output of one frame, a cloud, indices or a mask, or nothing if it failed. */
+  struct Output
+  {
+    PointCloud2::UniquePtr cloud;
+    PointIndices::UniquePtr indices;
+    Image::UniquePtr mask;
+  };
+
+  /** \brief A received frame waiting for a worker, with the node that received it. */
+  struct Frame
+  {
+    std::weak_ptr<Filter> filter;
+    PointCloud2::ConstSharedPtr cloud;
+    IndicesConstPtr indices;
+    std::shared_ptr<const PointMask> mask;
+  };
+
+  /** \brief The received frames waiting for the workers, numbered when a worker takes them.
+    * Shared with the workers, so that it outlives the node when its last reference is dropped
+    * by a worker. Protected by \a mutex.
+    */
+  struct WorkQueue
+  {
+    std::deque<Frame> frames;
+    std::uint64_t next_sequence = 0;
+    bool stop = false;
+    std::mutex mutex;
+    std::condition_variable condition;
+  };
+
+  /** \brief The threads the children split the work of one frame on, see parallelFor (). */
+  ThreadPool thread_pool_;
+
+  /** \brief The worker threads, and their queue. */
+  std::vector<std::thread> workers_;
+  std::shared_ptr<WorkQueue> work_queue_;
+
+  /** \brief The outputs computed ahead of an earlier frame, by number, and the number of the
+    * next output to publish. Protected by \a reorder_mutex_.
+    */
+  std::map<std::uint64_t, Output> reorder_buffer_;
+  std::uint64_t next_published_;
+  std::mutex reorder_mutex_;
+
   /** \brief Pointer to parameters callback handle. */
   OnSetParametersCallbackHandle::SharedPtr callback_handle_;
 
@@ -144,17 +355,122 @@ private:
   std::shared_ptr<message_filters::Synchronizer<sync_policies::ApproximateTime<PointCloud2,
     PointIndices>>> sync_input_indices_a_;
 
+  /** \brief Synchronized input, and indices received as a mask. */
+  message_filters::Subscriber<Image> sub_mask_filter_;
+  std::shared_ptr<message_filters::Synchronizer<sync_policies::ExactTime<PointCloud2,
+    Image>>> sync_input_mask_e_;
+  std::shared_ptr<message_filters::Synchronizer<sync_policies::ApproximateTime<PointCloud2,
+    Image>>> sync_input_mask_a_;
+
+  /** \brief The latched indices subscriber, used if transient_local_indices is set. */
+  rclcpp::Subscription<PointIndices>::SharedPtr sub_indices_latched_;
+  rclcpp::Subscription<Image>::SharedPtr sub_mask_latched_;
+
+  /** \brief The most recent latched indices, or mask with mask_indices, protected by
+    * \a latched_indices_mutex_.
+    */
+  PointIndices::ConstSharedPtr latched_indices_;
+  std::shared_ptr<const PointMask> latched_mask_;
+  std::mutex latched_indices_mutex_;
+
   /** \brief Parameter callback
     * \param params parameter values to set
     */
   rcl_interfaces::msg::SetParametersResult
   config_callback(const std::vector<rclcpp::Parameter> & params);
 
-  /** \brief PointCloud2 + Indices data callback. */
+  /** \brief PointCloud2 + mask data callback. */
   void
-  input_indices_callback(
+  input_mask_callback(
     const PointCloud2::ConstSharedPtr & cloud,
-    const PointIndices::ConstSharedPtr & indices);
+    const Image::ConstSharedPtr & mask);
+
+  /** \brief PointCloud2 + decoded mask data callback, see filterMasked (). */
+  void
+  input_point_mask_callback(
+    const PointCloud2::ConstSharedPtr & cloud,
+    const std::shared_ptr<const PointMask> & mask);
+
+  /** \brief Decode a received mask.
+    * \param mask the received mask
+    * \return the mask, or nullptr if \a mask is not supported
+    */
+  std::shared_ptr<const PointMask>
+  decodeMask(const Image & mask);
+
+  /** \brief Process an accepted input, on the workers if any or right away.
+    * \param cloud the received point cloud
+    * \param indices a pointer to the vector of point indices to use.
+    * \param mask the points to use instead of \a indices, if not null
+    */
+  void
+  processInput(
+    const PointCloud2::ConstSharedPtr & cloud, const IndicesConstPtr & indices,
+    const std::shared_ptr<const PointMask> & mask);
+
+  /** \brief PointCloud2 data callback, with the latched indices. */
+  void
+  input_latched_indices_callback(const PointCloud2::ConstSharedPtr & cloud);
+
+  /** \brief Project a received point cloud on keep_fields, and transform it into the input
+    * frame, if set.
+    * \param cloud the received point cloud
+    * \return the resultant point cloud, \a cloud itself if not needed, or nullptr on error
+    */
+  PointCloud2::ConstSharedPtr
+  transformInput(const PointCloud2::ConstSharedPtr & cloud);
+
+  /** \brief Compute the output of one frame, see computeOutput.
+    * \param input the input point cloud dataset, in the input frame.
+    * \param indices a pointer to the vector of point indices to use.
+    * \param input_frame the frame \a input was received in
+    * \param mask the points to use instead of \a indices, if not null
+    */
+  Output
+  computeFrame(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    const std::string & input_frame, const PointMask * mask);
+
+  /** \brief Publish an output cloud in a BoundedPointCloud2 loaned by the middleware, if
+    * \a loan_output_ is set and the cloud fits in the message.
+    * \param cloud the output cloud
+    * \return false if the cloud must be published on output instead
+    */
+  bool
+  publishLoaned(const PointCloud2 & cloud);
+
+  /** \brief Publish the output of one frame, if any. */
+  void
+  publishOutput(Output & result);
+
+  /** \brief Queue a received frame for the workers, dropping the oldest one if the queue is full.
+    * A node that is not owned by a shared pointer processes the frame right away instead.
+    * \param cloud the received point cloud
+    * \param indices a pointer to the vector of point indices to use.
+    * \param mask the points to use instead of \a indices, if not null
+    */
+  void
+  dispatch(
+    const PointCloud2::ConstSharedPtr & cloud, const IndicesConstPtr & indices,
+    const std::shared_ptr<const PointMask> & mask);
+
+  /** \brief Process the frames of \a queue until it stops. Each frame is processed through a
+    * strong reference to its node, frames whose node is being destroyed are dropped.
+    * \param queue the queue of the node
+    */
+  static void
+  workerLoop(const std::shared_ptr<WorkQueue> & queue);
+
+  /** \brief Process one frame taken by a worker, and publish the outputs that are due in order.
+    * \param frame the frame to process
+    * \param sequence the number of the frame
+    */
+  void
+  processFrame(const Frame & frame, std::uint64_t sequence);
+
+  /** \brief Publish the counters of \a output_pool_ on diagnostics, at most once per second. */
+  void
+  publishPoolStatistics();
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__FILTER_CHAIN_HPP_
+#define PCL_ROS__FILTERS__FILTER_CHAIN_HPP_
+
+// PCL includes
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/search/kdtree.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "pcl_ros/filters/config_snapshot.hpp"
+#include "pcl_ros/filters/filter.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+
+namespace pcl_ros
+{
+/** \brief @b FilterChain runs the usual CropBox -> PassThrough -> VoxelGrid ->
+  * StatisticalOutlierRemoval / RadiusOutlierRemoval pre-processing chain inside one node.
+  *
+  * The enabled stages are listed in the read-only \a stages parameter and always run in the order
+  * above. The crop_box and passthrough predicates are fused into a single pass over the input
+  * buffer. The voxel_grid stage and the outlier stages then work on that same intermediate
+  * buffer, and all outlier stages query one shared search tree built on the (voxelized) cloud.
+  * The radius stage only tests and counts as neighbors the points kept by the statistical stage,
+  * like a RadiusOutlierRemoval run on the output of StatisticalOutlierRemoval.
+  * Stage parameters are prefixed with the stage name, e.g. "voxel_grid.leaf_size".
+  */
+class FilterChain : public Filter
+{
+protected:
+  /** \brief Call the actual filter.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output the resultant filtered dataset
+    */
+  inline void
+  filter(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    PointCloud2 & output) override;
+
+  /** \brief Parameter callback
+    * \param params parameter values to set
+    */
+  rcl_interfaces::msg::SetParametersResult
+  config_callback(const std::vector<rclcpp::Parameter> & params);
+
+  OnSetParametersCallbackHandle::SharedPtr callback_handle_;
+
+private:
+  /** \brief Stage flags, set from the read-only \a stages parameter. */
+  bool use_crop_box_, use_passthrough_, use_voxel_grid_, use_statistical_, use_radius_;
+
+  typedef pcl::VoxelGrid<pcl::PCLPointCloud2> VoxelGridImpl;
+
+  /** \brief The stage parameters, edited by config_callback and used by filter () as immutable
+    * snapshots.
+    */
+  struct Config
+  {
+    /** \brief The crop_box stage. */
+    BoxRegion crop_box {{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}, false};
+
+    /** \brief The passthrough stage field name; its offset is resolved for every input layout. */
+    std::string passthrough_field_name;
+
+    /** \brief The passthrough stage limits. */
+    FieldRange passthrough_range {0, sensor_msgs::msg::PointField::FLOAT32, 0.0, 1.0, false};
+
+    /** \brief The PCL voxel grid implementation used by the voxel_grid stage. */
+    VoxelGridImpl voxel_grid;
+
+    /** \brief The statistical_outlier_removal stage parameters. */
+    int mean_k = 2;
+    double stddev_mult = 0.0;
+
+    /** \brief The radius_outlier_removal stage parameters. */
+    double radius_search = 0.1;
+    int min_neighbors = 5;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief The private state of one filter () call, reused across messages. */
+  struct Workspace
+  {
+    /** \brief A copy of the voxel grid, which setInputCloud () modifies. */
+    ConfigCopy<VoxelGridImpl> voxel_grid;
+
+    /** \brief XYZ view of the intermediate buffer, and the search tree shared by the outlier
+      * stages.
+      */
+    pcl::PointCloud<pcl::PointXYZ>::Ptr xyz_cloud {new pcl::PointCloud<pcl::PointXYZ>};
+    pcl::search::KdTree<pcl::PointXYZ>::Ptr tree {new pcl::search::KdTree<pcl::PointXYZ>};
+
+    /** \brief Combined result of the outlier stages, one entry per intermediate point, and the
+      * result of the statistical stage alone, which the radius stage runs on.
+      */
+    std::vector<std::uint8_t> keep;
+    std::vector<std::uint8_t> survivors;
+  };
+
+  /** \brief The configuration edited by config_callback, under mutex_, and its snapshots. */
+  Config config_;
+  ConfigSnapshot<Config> snapshot_;
+  WorkspacePool<Workspace> workspaces_;
+
+  /** \brief Set the stage flags from the \a stages parameter.
+    * \param stages the stage names, in order
+    * \return false if a stage is unknown, repeated or out of order
+    */
+  bool
+  setStages(const std::vector<std::string> & stages);
+
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  explicit FilterChain(const rclcpp::NodeOptions & options);
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__FILTER_CHAIN_HPP_
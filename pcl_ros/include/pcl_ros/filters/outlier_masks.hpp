@@ -0,0 +1,132 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__OUTLIER_MASKS_HPP_
+#define PCL_ROS__FILTERS__OUTLIER_MASKS_HPP_
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/search.h>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstdint>
+#include <vector>
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+
+namespace pcl_ros
+{
+/** \brief Running mean and variance of the mean neighbor distances of the statistical outlier
+  * test, blended over consecutive frames with an exponentially weighted moving average.
+  */
+struct DistanceStatistics
+{
+  /** \brief The weight of the newest frame, in (0; 1]. */
+  double alpha = 0.1;
+  /** \brief The running mean distance. */
+  double mean = 0.0;
+  /** \brief The running variance of the distances. */
+  double variance = 0.0;
+  /** \brief False until the first frame was blended in. */
+  bool initialized = false;
+};
+
+/** \brief Statistical outlier test of pcl::StatisticalOutlierRemoval, run against an already
+  * built search structure so that it can be shared with other consumers. Points that fail the
+  * test get their \a keep entry cleared; other entries are left untouched, so several tests can
+  * be combined on the same mask.
+  *
+  * As in the PCLPointCloud2 version of pcl::StatisticalOutlierRemoval, the mean distance of a
+  * point is taken over the mean_k - 1 nearest other points, and non finite points do not count in
+  * the statistics and are tested with a distance of 0: they are kept, unless \a negative.
+  *
+  * The mean distances are computed on \a num_threads threads, which query \a search concurrently.
+  *
+  * With \a running statistics, points are classified against the threshold of the previous frames
+  * while their distances are computed, and the statistics of this frame are blended in afterwards.
+  * This saves the second pass over the cloud. The first frame initializes the statistics.
+  * \param search a search structure built on \a cloud
+  * \param cloud the input point cloud
+  * \param mean_k the number of neighbors used for the mean distance estimation
+  * \param stddev_mult the standard deviation multiplier of the distance threshold
+  * \param negative true if the outliers should be kept instead of the inliers
+  * \param num_threads the maximum number of threads to use
+  * \param running the running statistics to use and update, or null
+  * \param keep one entry per point of \a cloud, non zero if the point is kept
+  */
+void
+markStatisticalOutliers(
+  const pcl::search::Search<pcl::PointXYZ> & search, const pcl::PointCloud<pcl::PointXYZ> & cloud,
+  int mean_k, double stddev_mult, bool negative, unsigned int num_threads,
+  DistanceStatistics * running, std::vector<std::uint8_t> & keep);
+
+/** \brief Approximation of markStatisticalOutliers () for organized clouds, which takes the
+  * nearest neighbors of a point among the pixels of a small image window around it instead of
+  * searching the whole cloud. The window is the smallest square holding twice \a mean_k
+  * neighbors, shifted inside the image at its borders. Points without \a mean_k - 1 finite
+  * neighbors in their window fail the test.
+  * \param cloud the input organized point cloud, see isDirectlyAccessible ()
+  * \param xyz the offsets of the x, y and z fields
+  * \param mean_k the number of neighbors used for the mean distance estimation
+  * \param stddev_mult the standard deviation multiplier of the distance threshold
+  * \param negative true if the outliers should be kept instead of the inliers
+  * \param num_threads the maximum number of threads to use
+  * \param running the running statistics to use and update, or null
+  * \param keep one entry per point of \a cloud, non zero if the point is kept
+  */
+void
+markStatisticalOutliersOrganized(
+  const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, int mean_k,
+  double stddev_mult, bool negative, unsigned int num_threads, DistanceStatistics * running,
+  std::vector<std::uint8_t> & keep);
+
+/** \brief Radius outlier test of pcl::RadiusOutlierRemoval, run against an already built search
+  * structure. See markStatisticalOutliers () for the handling of \a keep.
+  * \param search a search structure built on \a cloud
+  * \param cloud the input point cloud
+  * \param radius the radius of the sphere that determines which points are neighbors
+  * \param min_neighbors the number of neighbors an inlier needs inside \a radius
+  * \param negative true if the outliers should be kept instead of the inliers
+  * \param survivors if not null, one entry per point of \a cloud: only the points with a non zero
+  * entry are tested and counted as neighbors, as if the test ran on the output of a previous one
+  * \param keep one entry per point of \a cloud, non zero if the point is kept
+  */
+void
+markRadiusOutliers(
+  const pcl::search::Search<pcl::PointXYZ> & search, const pcl::PointCloud<pcl::PointXYZ> & cloud,
+  double radius, int min_neighbors, bool negative, const std::vector<std::uint8_t> * survivors,
+  std::vector<std::uint8_t> & keep);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__OUTLIER_MASKS_HPP_
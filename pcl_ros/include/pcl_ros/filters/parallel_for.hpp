@@ -0,0 +1,271 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__PARALLEL_FOR_HPP_
+#define PCL_ROS__FILTERS__PARALLEL_FOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pcl_ros
+{
+/** \brief Resolve a num_threads parameter value: 0 selects the number of hardware threads. */
+inline unsigned int
+resolveNumThreads(int num_threads)
+{
+  if (num_threads > 0) {
+    return static_cast<unsigned int>(num_threads);
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/** \brief @b ThreadPool keeps worker threads alive between parallelFor () calls, so that a
+  * filter does not create and join threads for every point cloud. The workers are started on
+  * demand, up to the largest number of threads requested so far, and joined by the destructor.
+  * The calling thread always takes part in its own calls: concurrent and nested calls share the
+  * workers without deadlocking, at worst they run serially.
+  *
+  * parallelFor () runs on the pool bound to the calling thread by a ThreadPool::Scope, or on a
+  * pool shared by the whole process if none is bound. Worker threads are bound to their pool.
+  */
+class ThreadPool
+{
+public:
+  ThreadPool()
+  : stop_(false) {}
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_condition_.notify_all();
+    for (std::thread & worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /** \brief Call \a task (i) for each i in [0, \a nr_tasks), from the calling thread and up to
+    * \a nr_tasks - 1 workers, and return once all tasks are done. The first exception thrown by
+    * a task is rethrown here, after the other tasks are done.
+    */
+  void
+  run(std::size_t nr_tasks, const std::function<void(std::size_t)> & task)
+  {
+    if (nr_tasks <= 1) {
+      if (nr_tasks == 1) {
+        task(0);
+      }
+      return;
+    }
+
+    Job job(task, nr_tasks);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (workers_.size() < nr_tasks - 1) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+      }
+      jobs_.push_back(&job);
+    }
+    work_condition_.notify_all();
+
+    runTasks(job);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    // No worker may pick the job up once it leaves the queue, only wait for those running it
+    removeJob(job);
+    job.done_condition.wait(lock, [&job]() {return job.nr_workers == 0;});
+    lock.unlock();
+    if (job.error) {
+      std::rethrow_exception(job.error);
+    }
+  }
+
+  /** \brief The pool used by parallelFor () on the calling thread. */
+  static ThreadPool &
+  current()
+  {
+    ThreadPool * bound = boundPool();
+    if (bound) {
+      return *bound;
+    }
+    static ThreadPool shared;
+    return shared;
+  }
+
+  /** \brief Binds a pool to the calling thread for the lifetime of the scope. */
+  class Scope
+  {
+  public:
+    explicit Scope(ThreadPool & pool)
+    : previous_(boundPool())
+    {
+      boundPool() = &pool;
+    }
+
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+    ~Scope()
+    {
+      boundPool() = previous_;
+    }
+
+  private:
+    ThreadPool * previous_;
+  };
+
+private:
+  /** \brief The state of one run () call, which lives on the stack of its caller. The tasks are
+    * claimed through \a next, \a nr_workers and \a error are protected by the pool mutex.
+    */
+  struct Job
+  {
+    Job(const std::function<void(std::size_t)> & task, std::size_t nr_tasks)
+    : task(task), nr_tasks(nr_tasks), next(0), nr_workers(0) {}
+
+    const std::function<void(std::size_t)> & task;
+    const std::size_t nr_tasks;
+    std::atomic<std::size_t> next;
+    std::size_t nr_workers;
+    std::exception_ptr error;
+    std::condition_variable done_condition;
+  };
+
+  static ThreadPool * &
+  boundPool()
+  {
+    static thread_local ThreadPool * pool = nullptr;
+    return pool;
+  }
+
+  /** \brief Run the tasks of \a job until none is left to claim. */
+  void
+  runTasks(Job & job)
+  {
+    for (std::size_t i = job.next++; i < job.nr_tasks; i = job.next++) {
+      try {
+        job.task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!job.error) {
+          job.error = std::current_exception();
+        }
+      }
+    }
+  }
+
+  /** \brief Remove \a job from the queue if it is still there, with the mutex held. */
+  void
+  removeJob(Job & job)
+  {
+    const auto it = std::find(jobs_.begin(), jobs_.end(), &job);
+    if (it != jobs_.end()) {
+      jobs_.erase(it);
+    }
+  }
+
+  void
+  workerLoop()
+  {
+    boundPool() = this;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      work_condition_.wait(lock, [this]() {return stop_ || !jobs_.empty();});
+      if (stop_) {
+        return;
+      }
+      Job & job = *jobs_.front();
+      ++job.nr_workers;
+      lock.unlock();
+      runTasks(job);
+      lock.lock();
+      // Every task is claimed by now, nobody else needs to pick the job up
+      removeJob(job);
+      if (--job.nr_workers == 0) {
+        job.done_condition.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::deque<Job *> jobs_;
+  bool stop_;
+  std::mutex mutex_;
+  std::condition_variable work_condition_;
+};
+
+/** \brief Split [0, \a size) in contiguous chunks and call \a body (begin, end) on each of them,
+  * from up to \a num_threads threads of ThreadPool::current (). The calling thread processes
+  * chunks too, and the call returns once all chunks are done.
+  * \param size the number of items
+  * \param num_threads the maximum number of threads to use
+  * \param min_chunk the minimum number of items per chunk, so that small inputs stay serial
+  * \param body the function to call on each chunk
+  */
+template<typename Body>
+void
+parallelFor(std::size_t size, unsigned int num_threads, std::size_t min_chunk, const Body & body)
+{
+  const std::size_t max_chunks =
+    std::max<std::size_t>(1, size / std::max<std::size_t>(1, min_chunk));
+  const std::size_t max_threads = std::min<std::size_t>(std::max(1u, num_threads), max_chunks);
+  if (max_threads <= 1) {
+    body(std::size_t(0), size);
+    return;
+  }
+
+  const std::size_t chunk = (size + max_threads - 1) / max_threads;
+  ThreadPool::current().run(
+    (size + chunk - 1) / chunk, [&body, chunk, size](std::size_t i) {
+      const std::size_t begin = i * chunk;
+      body(begin, std::min(begin + chunk, size));
+    });
+}
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__PARALLEL_FOR_HPP_
@@ -40,13 +40,22 @@
 
 // PCL includes
 #include <pcl/filters/passthrough.h>
+#include <memory>
+#include <string>
 #include <vector>
+#include "pcl_ros/filters/config_snapshot.hpp"
 #include "pcl_ros/filters/filter.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
 
 namespace pcl_ros
 {
 /** \brief @b PassThrough uses the base Filter class methods to pass through all data that satisfies the user given
   * constraints.
+  *
+  * Besides the single filter_field_name range, a list of additional ranges can be given with the
+  * filter_field_names, filter_limits_min, filter_limits_max and filter_limits_negative array
+  * parameters. A point passes if it satisfies all of the ranges, which are evaluated together in
+  * one pass over the PointCloud2 buffer.
   * \author Radu Bogdan Rusu
   */
 class PassThrough : public Filter
@@ -59,9 +68,42 @@ protected:
     */
   inline void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) override;
 
+  /** \brief Compute the indices of the passing points directly on the PointCloud2 buffer.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output_indices the resultant indices into \a input
+    */
+  bool
+  filterIndices(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    std::vector<int> & output_indices) override;
+
+  /** \brief Filter the points selected by a received mask directly on the PointCloud2 buffer,
+    * without converting the mask into indices.
+    * \param input the input point cloud dataset
+    * \param mask the input set of points to use from \a input
+    * \param output the resultant filtered dataset
+    */
+  void
+  filterMasked(
+    const PointCloud2::ConstSharedPtr & input, const PointMask & mask,
+    PointCloud2 & output) override;
+
+  /** \brief Compute the mask of the passing points directly on the PointCloud2 buffer.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param mask the input set of points to use from \a input, preferred to \a indices (may be
+    * null)
+    * \param output_mask the resultant mask, of the size of \a input
+    */
+  bool
+  filterMask(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    const PointMask * mask, PointMask & output_mask) override;
+
   /** \brief Parameter callback
     * \param params parameter values to set
     */
@@ -71,8 +113,91 @@ protected:
   OnSetParametersCallbackHandle::SharedPtr callback_handle_;
 
 private:
-  /** \brief The PCL filter implementation used. */
-  pcl::PassThrough<pcl::PCLPointCloud2> impl_;
+  typedef pcl::PassThrough<pcl::PCLPointCloud2> Impl;
+
+  /** \brief The configuration of the filter, edited by config_callback and used by filter () as
+    * immutable snapshots.
+    */
+  struct Config
+  {
+    /** \brief The PCL filter implementation used. */
+    Impl impl;
+
+    /** \brief The field names and ranges of the additional predicates. */
+    std::vector<std::string> predicate_fields;
+    std::vector<FieldRange> predicate_ranges;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  typedef std::shared_ptr<const Config> ConfigConstPtr;
+
+  /** \brief The private state of one filter () call. */
+  struct Workspace
+  {
+    /** \brief A copy of the PCL filter, which setInputCloud () modifies. */
+    ConfigCopy<Impl> impl;
+
+    /** \brief All ranges to evaluate (filter_field_name first, if set), with their offsets
+      * resolved for the configuration \a ranges_config and the point layout \a ranges_layout.
+      */
+    std::vector<FieldRange> ranges;
+    ConfigConstPtr ranges_config;
+    std::vector<sensor_msgs::msg::PointField> ranges_layout;
+  };
+
+  /** \brief The configuration edited by config_callback, under mutex_, and its snapshots. */
+  Config config_;
+  ConfigSnapshot<Config> snapshot_;
+  WorkspacePool<Workspace> workspaces_;
+
+  /** \brief The filter_field_names, filter_limits_min, filter_limits_max and
+    * filter_limits_negative parameter values. config_callback rejects the updates that would
+    * leave their lengths inconsistent.
+    */
+  std::vector<std::string> field_names_param_;
+  std::vector<double> limits_min_param_, limits_max_param_;
+  std::vector<bool> limits_negative_param_;
+
+  /** \brief Rebuild the additional predicates from the array parameters. */
+  void
+  updatePredicates();
+
+  /** \brief Resolve the field offsets of the ranges of \a config for the layout of \a input, into
+    * \a workspace. This is only done when the configuration or the point layout change, never
+    * per point.
+    * \param config the configuration to use
+    * \param workspace the workspace of the call
+    * \param input the input point cloud dataset
+    * \return false if a field is missing or not numeric
+    */
+  bool
+  resolveRanges(const ConfigConstPtr & config, Workspace & workspace, const PointCloud2 & input);
+
+  /** \brief Mask the points of an input cloud directly in its PointCloud2 buffer, without the
+    * round trip through pcl::PCLPointCloud2. Only valid in keep_organized mode.
+    * \param config the configuration to use
+    * \param workspace the workspace of the call
+    * \param input the input point cloud dataset
+    * \param output the resultant filtered dataset
+    * \return false if the cloud layout is not supported and the PCL filter must be used instead
+    */
+  bool
+  filterOrganized(
+    const ConfigConstPtr & config, Workspace & workspace, const PointCloud2 & input,
+    PointCloud2 & output);
+
+  /** \brief Evaluate all ranges directly on the PointCloud2 buffer. Used whenever additional
+    * predicates are set, as pcl::PassThrough only supports a single field.
+    * \param config the configuration to use
+    * \param workspace the workspace of the call
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output the resultant filtered dataset
+    */
+  void
+  filterPredicates(
+    const ConfigConstPtr & config, Workspace & workspace, const PointCloud2 & input,
+    const IndicesConstPtr & indices, PointCloud2 & output);
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -0,0 +1,249 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__POINT_CLOUD2_OPS_HPP_
+#define PCL_ROS__FILTERS__POINT_CLOUD2_OPS_HPP_
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pcl_ros/filters/point_mask.hpp"
+
+namespace pcl_ros
+{
+/** \brief Byte offsets of the x, y and z fields inside a point record. */
+struct XYZOffsets
+{
+  std::uint32_t x;
+  std::uint32_t y;
+  std::uint32_t z;
+};
+
+/** \brief A range test on a single numeric field, with the semantics of pcl::PassThrough. */
+struct FieldRange
+{
+  /** \brief The offset of the field inside a point record. */
+  std::uint32_t offset;
+  /** \brief The sensor_msgs::msg::PointField datatype of the field. */
+  std::uint8_t datatype;
+  /** \brief The minimum allowed field value. */
+  double limit_min;
+  /** \brief The maximum allowed field value. */
+  double limit_max;
+  /** \brief Set to true to keep the values outside (\a limit_min; \a limit_max) instead. */
+  bool negative;
+};
+
+/** \brief An axis aligned box test on x, y and z, with the semantics of pcl::CropBox. */
+struct BoxRegion
+{
+  /** \brief The minimum corner of the box. */
+  float min_pt[3];
+  /** \brief The maximum corner of the box. */
+  float max_pt[3];
+  /** \brief Set to true to keep the points outside of the box instead. */
+  bool negative;
+};
+
+/** \brief Test whether the data of a PointCloud2 can be read and written in place by the direct
+  * buffer kernels below (host byte order, consistent size).
+  * \param cloud the point cloud to test
+  */
+bool
+isDirectlyAccessible(const sensor_msgs::msg::PointCloud2 & cloud);
+
+/** \brief Get the byte offset of a single FLOAT32 field.
+  * \param cloud the point cloud to inspect
+  * \param field_name the name of the field
+  * \param offset the resultant offset of the field inside a point record
+  * \return false if the field does not exist or is not a single FLOAT32 value
+  */
+bool
+getFloatFieldOffset(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & field_name,
+  std::uint32_t & offset);
+
+/** \brief Get the byte offsets of the x, y and z FLOAT32 fields.
+  * \param cloud the point cloud to inspect
+  * \param offsets the resultant offsets
+  * \return false if any of x, y or z is missing or is not FLOAT32
+  */
+bool
+getXYZOffsets(const sensor_msgs::msg::PointCloud2 & cloud, XYZOffsets & offsets);
+
+/** \brief Resolve the offset and datatype of the field tested by \a range. This only depends on
+  * the layout of \a cloud, so it can be done once per layout rather than per point.
+  * \param cloud the point cloud to inspect
+  * \param field_name the name of the field
+  * \param range the range whose offset and datatype are set
+  * \return false if the field does not exist or is not a single numeric value
+  */
+bool
+resolveFieldRange(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & field_name,
+  FieldRange & range);
+
+/** \brief Apply range and box tests with the keep_organized semantics of pcl::PassThrough and
+  * pcl::CropBox directly on the data of \a cloud: the x, y and z values of every point that does
+  * not pass all the tests are overwritten with NaN. Like in PCL, NaN range values pass both
+  * positive and negative tests.
+  * \param cloud the point cloud to filter in place
+  * \param xyz the offsets of the x, y and z fields
+  * \param ranges the field range tests to apply
+  * \param boxes the box tests to apply
+  * \return the number of points that were masked
+  */
+std::size_t
+maskFailing(
+  sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes);
+
+/** \brief Copy the points of \a input that pass every range and box test into \a output, in a
+  * single pass over the input buffer. Points with a non finite x, y or z are removed, like
+  * pcl::PassThrough and pcl::CropBox do for unorganized output, while a NaN range value passes its
+  * test as in PCL. The output is unorganized and dense.
+  *
+  * The tests run test-major over small blocks of points that stay in cache, so every inner loop
+  * is a branch free comparison of one field that the compiler can vectorize.
+  * \param input the input point cloud
+  * \param xyz the offsets of the x, y and z fields of \a input
+  * \param ranges the field range tests to apply
+  * \param boxes the box tests to apply
+  * \param indices an optional subset of the input points to consider (may be nullptr)
+  * \param output the resultant point cloud, its buffer is reused if large enough
+  * \return the number of points copied to \a output
+  */
+std::size_t
+extractPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const std::vector<int> * indices, sensor_msgs::msg::PointCloud2 & output);
+
+/** \brief Like extractPassing (), but only consider the points selected by a mask, which is read
+  * in place rather than converted into indices.
+  * \param input the input point cloud
+  * \param xyz the offsets of the x, y and z fields of \a input
+  * \param ranges the field range tests to apply
+  * \param boxes the box tests to apply
+  * \param mask the subset of the input points to consider, of the size of \a input
+  * \param output the resultant point cloud, its buffer is reused if large enough
+  * \return the number of points copied to \a output
+  */
+std::size_t
+extractPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const PointMask & mask, sensor_msgs::msg::PointCloud2 & output);
+
+/** \brief Like extractPassing (), but only return the indices of the passing points instead of
+  * copying them.
+  * \param input the input point cloud
+  * \param xyz the offsets of the x, y and z fields of \a input
+  * \param ranges the field range tests to apply
+  * \param boxes the box tests to apply
+  * \param indices an optional subset of the input points to consider (may be nullptr)
+  * \param selected the resultant indices of the passing points
+  * \return the number of passing points
+  */
+std::size_t
+selectPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const std::vector<int> * indices, std::vector<int> & selected);
+
+/** \brief Like selectPassing (), but return the passing points as a mask.
+  * \param input the input point cloud
+  * \param xyz the offsets of the x, y and z fields of \a input
+  * \param ranges the field range tests to apply
+  * \param boxes the box tests to apply
+  * \param indices an optional subset of the input points to consider (may be nullptr)
+  * \param mask an optional subset of the input points to consider instead of \a indices, of the
+  * size of \a input (may be nullptr)
+  * \param selected the resultant mask of the passing points, of the size of \a input
+  * \return the number of passing points
+  */
+std::size_t
+selectPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const std::vector<int> * indices, const PointMask * mask, PointMask & selected);
+
+/** \brief Copy the points of \a input selected by \a indices into \a output, in the order of
+  * \a indices and with duplicates, like pcl::ExtractIndices. Consecutive indices are copied as a
+  * single run, so sorted indices, e.g. of clusters, cost one memcpy per contiguous range. Indices
+  * out of range are skipped. The output is unorganized.
+  * \param input the input point cloud
+  * \param indices the indices of the points to copy
+  * \param num_threads the maximum number of threads to copy large sets of indices with
+  * \param output the resultant point cloud, its buffer is reused if large enough
+  * \return the number of points copied to \a output
+  */
+std::size_t
+gatherPoints(
+  const sensor_msgs::msg::PointCloud2 & input, const std::vector<int> & indices,
+  unsigned int num_threads, sensor_msgs::msg::PointCloud2 & output);
+
+/** \brief Convert a keep mask into the indices of the kept points.
+  * \param keep one entry per point, non zero if the point is kept
+  * \param indices the resultant indices, in increasing order
+  */
+void
+maskToIndices(const std::vector<std::uint8_t> & keep, std::vector<int> & indices);
+
+/** \brief Overwrite the x, y and z values of the points whose \a keep entry is zero with NaN, for
+  * the keep_organized output of filters that compute a keep mask.
+  * \param cloud the point cloud to mask in place
+  * \param xyz the offsets of the x, y and z fields
+  * \param keep one entry per point, non zero if the point is kept
+  * \return the number of points that were masked
+  */
+std::size_t
+maskPoints(
+  sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz,
+  const std::vector<std::uint8_t> & keep);
+
+/** \brief Remove the points whose \a keep entry is zero from \a cloud, compacting the buffer in
+  * place without reallocating it. The cloud becomes unorganized.
+  * \param cloud the point cloud to compact
+  * \param keep one entry per point, non zero if the point is kept
+  * \return the number of points left in \a cloud
+  */
+std::size_t
+compactPoints(sensor_msgs::msg::PointCloud2 & cloud, const std::vector<std::uint8_t> & keep);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__POINT_CLOUD2_OPS_HPP_
@@ -0,0 +1,278 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__POINT_MASK_HPP_
+#define PCL_ROS__FILTERS__POINT_MASK_HPP_
+
+#include <pcl_msgs/msg/point_indices.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pcl_ros
+{
+namespace detail
+{
+/** \brief Index of the lowest set bit of a non zero \a word. */
+inline unsigned
+lowestBit(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+  unsigned bit = 0;
+  while (!(word & 1u)) {
+    word >>= 1;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+}  // namespace detail
+
+/** \brief @b PointMask is a compact representation of a set of point indices: one bit per point
+  * of a cloud, 16 times smaller than the equivalent std::vector<int> when the set is dense. Set
+  * bits can be visited one by one or as runs of consecutive points, so the points of a cloud can
+  * be copied run by run rather than index by index.
+  *
+  * Unlike PointIndices, a mask has no order and no duplicates: the points are always visited in
+  * increasing index order.
+  *
+  * On the wire, a mask is an Image with the layout of the cloud and the kBitmaskEncoding
+  * encoding: one bit per point, row by row. Each row takes step = (width + 7) / 8 bytes, point u
+  * of a row is bit u % 8 of byte u / 8, least significant bit first, and the padding bits at the
+  * end of a row are 0.
+  */
+class PointMask
+{
+public:
+  /** \brief Number of points per word of the mask. */
+  static constexpr std::size_t kWordBits = 64;
+
+  /** \brief Encoding of the bit-packed mask images, see toImage (). */
+  static constexpr const char * kBitmaskEncoding = "bitmask";
+
+  /** \brief Empty constructor. */
+  PointMask()
+  : size_(0) {}
+
+  /** \brief Create a mask for \a size points.
+    * \param size the number of points of the cloud the mask refers to
+    * \param value the initial state of every point
+    */
+  explicit PointMask(std::size_t size, bool value = false);
+
+  /** \brief Create a mask from a list of indices, see assign ().
+    * \param indices the indices of the selected points
+    * \param size the number of points of the cloud the indices refer to
+    */
+  PointMask(const std::vector<std::int32_t> & indices, std::size_t size);
+
+  /** \brief Create a mask from a PointIndices message, see assign ().
+    * \param indices the indices of the selected points
+    * \param size the number of points of the cloud the indices refer to
+    */
+  PointMask(const pcl_msgs::msg::PointIndices & indices, std::size_t size);
+
+  /** \brief Set the mask to \a size points, all in the same state. The capacity is kept.
+    * \param size the number of points of the cloud the mask refers to
+    * \param value the state of every point
+    */
+  void
+  assign(std::size_t size, bool value);
+
+  /** \brief Set the mask to the given list of indices. Duplicates are merged, indices out of the
+    * range [0; \a size) are ignored.
+    * \param indices the indices of the selected points
+    * \param size the number of points of the cloud the indices refer to
+    * \return the number of indices that were out of range
+    */
+  std::size_t
+  assign(const std::vector<std::int32_t> & indices, std::size_t size);
+
+  /** \brief Set the mask to an image with one bit or one pixel per point, for the clouds of
+    * \a image.width by \a image.height points. Set bits or non zero pixels are selected.
+    * \param image the mask image, kBitmaskEncoding as written by toImage (), or mono8 or 8UC1
+    * \return false, leaving the mask unchanged, if the encoding or the layout of \a image is not
+    * supported
+    */
+  bool
+  assign(const sensor_msgs::msg::Image & image);
+
+  /** \brief Convert the mask into a list of indices, in increasing order.
+    * \param indices the resultant indices
+    */
+  void
+  toIndices(std::vector<std::int32_t> & indices) const;
+
+  /** \brief Convert the mask into a PointIndices message. The header is left untouched.
+    * \param indices the resultant message
+    */
+  void
+  toPointIndices(pcl_msgs::msg::PointIndices & indices) const;
+
+  /** \brief Convert the mask into a bit-packed image in the kBitmaskEncoding encoding, 8 times
+    * smaller than a mono8 image. The header is left untouched.
+    * \param width the width of the cloud the mask refers to, \a size () / \a width rows
+    * \param image the resultant image, its buffer is reused if large enough
+    */
+  void
+  toImage(std::uint32_t width, sensor_msgs::msg::Image & image) const;
+
+  /** \brief Get the number of points of the cloud the mask refers to. */
+  inline std::size_t
+  size() const {return size_;}
+
+  /** \brief Count the selected points. */
+  std::size_t
+  count() const;
+
+  /** \brief Test whether the point at \a index is selected. */
+  inline bool
+  test(std::size_t index) const
+  {
+    return (words_[index / kWordBits] >> (index % kWordBits)) & 1u;
+  }
+
+  /** \brief Select the point at \a index. */
+  inline void
+  set(std::size_t index)
+  {
+    words_[index / kWordBits] |= std::uint64_t(1) << (index % kWordBits);
+  }
+
+  /** \brief Deselect the point at \a index. */
+  inline void
+  reset(std::size_t index)
+  {
+    words_[index / kWordBits] &= ~(std::uint64_t(1) << (index % kWordBits));
+  }
+
+  /** \brief Invert the selection, e.g. for negative filters. */
+  void
+  flip();
+
+  /** \brief Get the words of the mask, bit i of word w is point w * kWordBits + i. */
+  inline const std::vector<std::uint64_t> &
+  words() const {return words_;}
+
+  /** \brief Call \a f (index) for every selected point, in increasing order. */
+  template<typename F>
+  void
+  forEachSet(F f) const
+  {
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      std::uint64_t word = words_[w];
+      while (word) {
+        f(w * kWordBits + detail::lowestBit(word));
+        word &= word - 1;
+      }
+    }
+  }
+
+  /** \brief Call \a f (begin, end) for every maximal run [begin; end) of selected points, in
+    * increasing order. This is the run length encoded view of the mask: full and empty words
+    * are skipped as a whole.
+    */
+  template<typename F>
+  void
+  forEachRun(F f) const
+  {
+    bool open = false;
+    std::size_t begin = 0;
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      const std::uint64_t word = words_[w];
+      // Whole words that do not end or start a run
+      if ((open && word == ~std::uint64_t(0)) || (!open && word == 0)) {
+        continue;
+      }
+      unsigned bit = 0;
+      while (bit < kWordBits) {
+        const std::uint64_t rest = (open ? ~word : word) >> bit;
+        if (!rest) {
+          break;
+        }
+        bit += detail::lowestBit(rest);
+        if (open) {
+          f(begin, w * kWordBits + bit);
+        } else {
+          begin = w * kWordBits + bit;
+        }
+        open = !open;
+      }
+    }
+    if (open) {
+      f(begin, size_);
+    }
+  }
+
+private:
+  /** \brief Clear the bits past the last point, which all the operations rely on. */
+  void
+  clearTail();
+
+  /** \brief Get the 8 points starting at \a index, as the bits of a byte, lowest point first. */
+  std::uint8_t
+  getByte(std::size_t index) const;
+
+  /** \brief Select the points starting at \a index whose bit is set in \a byte. The points must
+    * be in the mask.
+    */
+  void
+  orByte(std::size_t index, std::uint8_t byte);
+
+  /** \brief The number of points of the cloud the mask refers to. */
+  std::size_t size_;
+
+  /** \brief The bits of the mask, kWordBits points per word. */
+  std::vector<std::uint64_t> words_;
+};
+
+/** \brief Copy the points of \a input selected by \a mask into \a output, one memcpy per run of
+  * consecutive selected points. The output is unorganized.
+  * \param input the input point cloud, its size must match the size of \a mask
+  * \param mask the points to copy
+  * \param output the resultant point cloud, its buffer is reused if large enough
+  * \return the number of points copied to \a output
+  */
+std::size_t
+extractMasked(
+  const sensor_msgs::msg::PointCloud2 & input, const PointMask & mask,
+  sensor_msgs::msg::PointCloud2 & output);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__POINT_MASK_HPP_
@@ -0,0 +1,103 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__POINT_PROJECTION_HPP_
+#define PCL_ROS__FILTERS__POINT_PROJECTION_HPP_
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstddef>
+#include <vector>
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+
+namespace pcl_ros
+{
+/** \brief A plane or line model that points are projected on, with the semantics of
+  * pcl::SampleConsensusModelPlane and pcl::SampleConsensusModelLine ::projectPoints ().
+  */
+struct ProjectionModel
+{
+  enum Type
+  {
+    Plane,
+    Line
+  };
+
+  /** \brief The type of the model. */
+  Type type;
+  /** \brief A point of the line, unused for planes. */
+  float point[3];
+  /** \brief The unit normal of the plane, or the direction of the line. */
+  float direction[3];
+  /** \brief The offset of the plane, or 1 / |direction|^2 for lines. */
+  float scale;
+};
+
+/** \brief Build a projection model from pcl::ProjectInliers parameters.
+  * \param model_type the pcl::SacModel type, only SACMODEL_PLANE and SACMODEL_LINE are supported
+  * \param values the model coefficients, [a, b, c, d] for planes and [point, direction] for lines
+  * \param model the resultant model
+  * \return false if the model type is not supported or the coefficients are invalid
+  */
+bool
+makeProjectionModel(int model_type, const std::vector<float> & values, ProjectionModel & model);
+
+/** \brief Project points of \a cloud on \a model in place. The x, y and z values are loaded in
+  * blocks, so that the projection itself is a vectorizable loop over contiguous arrays.
+  * \param cloud the point cloud whose points are projected
+  * \param xyz the offsets of the x, y and z fields of \a cloud
+  * \param model the model to project on
+  * \param indices the points to project, all of them if nullptr. Indices out of range are skipped
+  * \param num_threads the maximum number of threads to use, only with unique indices
+  */
+void
+projectPoints(
+  sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, const ProjectionModel & model,
+  const std::vector<int> * indices, unsigned int num_threads);
+
+/** \brief Copy the x, y and z fields of points of \a input into \a output, in the layout of
+  * pcl::PointXYZ. The output is organized like the input if \a indices is nullptr, and
+  * unorganized otherwise.
+  * \param input the input point cloud
+  * \param xyz the offsets of the x, y and z fields of \a input
+  * \param indices the points to copy, all of them if nullptr. Indices out of range are skipped
+  * \param output the resultant point cloud, its buffer is reused if large enough
+  */
+void
+extractXYZ(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<int> * indices, sensor_msgs::msg::PointCloud2 & output);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__POINT_PROJECTION_HPP_
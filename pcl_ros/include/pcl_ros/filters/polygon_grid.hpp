@@ -0,0 +1,128 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__POLYGON_GRID_HPP_
+#define PCL_ROS__FILTERS__POLYGON_GRID_HPP_
+
+#include <Eigen/Core>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+
+namespace pcl_ros
+{
+/** \brief @b PolygonGrid answers point in polygon queries in constant time on average. The
+  * bounding box of the polygon is divided into a grid; each cell stores whether a reference
+  * point inside of it is in the polygon, and the edges that cross the cell. A query only counts
+  * the crossings of those edges with the segment from the reference point of its cell, so cells
+  * that no edge crosses are answered by a single lookup.
+  *
+  * The polygon is closed automatically and may be concave or self intersecting, in which case
+  * the even-odd rule applies.
+  */
+class PolygonGrid
+{
+public:
+  /** \brief Set the polygon and build the grid.
+    * \param vertices the x and y coordinates of the vertices, x0, y0, x1, y1, ...
+    * \return false if there are less than 3 vertices or a coordinate is not finite, in which
+    * case the grid is left unchanged
+    */
+  bool
+  assign(const std::vector<double> & vertices);
+
+  /** \brief Test whether the grid has no polygon. */
+  inline bool
+  empty() const {return edges_.empty();}
+
+  /** \brief Test whether (\a x, \a y) is inside of the polygon. */
+  bool
+  contains(float x, float y) const;
+
+private:
+  /** \brief An edge of the polygon. */
+  struct Edge
+  {
+    double x0, y0, x1, y1;
+  };
+
+  /** \brief The reference point of the cell (\a ix, \a iy). */
+  void
+  referencePoint(std::size_t ix, std::size_t iy, double & x, double & y) const;
+
+  /** \brief The edges of the polygon. */
+  std::vector<Edge> edges_;
+
+  /** \brief The bounding box of the polygon. */
+  double min_x_ = 0.0, min_y_ = 0.0, max_x_ = 0.0, max_y_ = 0.0;
+
+  /** \brief The size of a cell, and its inverse. */
+  double cell_x_ = 0.0, cell_y_ = 0.0, inv_cell_x_ = 0.0, inv_cell_y_ = 0.0;
+
+  /** \brief The number of cells along x and y. */
+  std::size_t nx_ = 0, ny_ = 0;
+
+  /** \brief For each cell, 1 if its reference point is inside of the polygon. */
+  std::vector<std::uint8_t> reference_inside_;
+
+  /** \brief The edges crossing each cell, cell c owns [cell_begin_[c]; cell_begin_[c + 1]). */
+  std::vector<std::uint32_t> cell_begin_;
+  std::vector<std::uint32_t> cell_edges_;
+};
+
+/** \brief Flag the points inside of the prism of \a polygon extruded between \a min_z and
+  * \a max_z (or outside of it, if \a negative). Non finite points are never flagged.
+  * \param cloud the input point cloud
+  * \param xyz the offsets of the x, y and z fields of \a cloud
+  * \param polygon the polygon, in the x and y coordinates of the prism frame
+  * \param min_z the minimum z of the prism
+  * \param max_z the maximum z of the prism
+  * \param negative set to true to flag the points outside of the prism instead
+  * \param transform the transform from the frame of \a cloud to the prism frame, each point is
+  * transformed before being tested (may be nullptr if the prism is given in the frame of \a cloud)
+  * \param indices an optional subset of the points to consider (may be nullptr)
+  * \param num_threads the maximum number of threads to use
+  * \param keep the resultant flags, one per point or per index in \a indices
+  */
+void
+markInPrism(
+  const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, const PolygonGrid & polygon,
+  double min_z, double max_z, bool negative, const Eigen::Matrix4f * transform,
+  const std::vector<int> * indices, unsigned int num_threads, std::vector<std::uint8_t> & keep);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__POLYGON_GRID_HPP_
@@ -42,6 +42,7 @@
 #include <pcl/filters/project_inliers.h>
 #include <message_filters/subscriber.h>
 #include <memory>
+#include <mutex>
 #include "pcl_ros/filters/filter.hpp"
 
 
@@ -67,13 +68,14 @@ protected:
     */
   inline void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) override;
 
-private:
-  /** \brief A pointer to the vector of model coefficients. */
+  /** \brief The model coefficients of the cloud given to filter (), set by the data callbacks. */
   ModelCoefficientsConstPtr model_;
 
+private:
+
   /** \brief The message filter subscriber for model coefficients. */
   message_filters::Subscriber<ModelCoefficients> sub_model_;
 
@@ -82,9 +84,33 @@ private:
     PointIndices, ModelCoefficients>>> sync_input_indices_model_e_;
   std::shared_ptr<message_filters::Synchronizer<sync_policies::ApproximateTime<PointCloud2,
     PointIndices, ModelCoefficients>>> sync_input_indices_model_a_;
+  /** \brief Set to true if the model topic has transient_local durability, in which case the
+    * most recent model is applied to every cloud instead of being synchronized with it. The
+    * indices are latched the same way if transient_local_indices is also set.
+    */
+  bool transient_local_model_;
+
+  /** \brief Subscribers for the latched model and indices. */
+  rclcpp::Subscription<ModelCoefficients>::SharedPtr sub_model_latched_;
+  rclcpp::Subscription<PointIndices>::SharedPtr sub_indices_latched_;
+
+  /** \brief The most recent latched model and indices, protected by \a latched_mutex_. */
+  ModelCoefficientsConstPtr latched_model_;
+  PointIndicesConstPtr latched_indices_;
+  std::mutex latched_mutex_;
+
+  /** \brief Synchronized input and indices, with a latched model. */
+  std::shared_ptr<message_filters::Synchronizer<sync_policies::ExactTime<PointCloud2,
+    PointIndices>>> sync_input_indices_latched_e_;
+  std::shared_ptr<message_filters::Synchronizer<sync_policies::ApproximateTime<PointCloud2,
+    PointIndices>>> sync_input_indices_latched_a_;
+
   /** \brief The PCL filter implementation used. */
   pcl::ProjectInliers<pcl::PCLPointCloud2> impl_;
 
+  /** \brief The number of threads of the direct plane and line projection, 0 for all cores. */
+  int num_threads_;
+
   void subscribe() override;
   void unsubscribe() override;
 
@@ -95,6 +121,16 @@ private:
     const PointIndicesConstPtr & indices,
     const ModelCoefficientsConstPtr & model);
 
+  /** \brief PointCloud2 + Indices data callback, with the latched model. */
+  void
+  input_indices_latched_callback(
+    const PointCloud2::ConstSharedPtr & cloud,
+    const PointIndicesConstPtr & indices);
+
+  /** \brief PointCloud2 data callback, with the latched indices and model. */
+  void
+  input_latched_callback(const PointCloud2::ConstSharedPtr & cloud);
+
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -40,13 +40,24 @@
 
 // PCL includes
 #include <pcl/filters/radius_outlier_removal.h>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
+#include "pcl_ros/filters/config_snapshot.hpp"
 #include "pcl_ros/filters/filter.hpp"
+#include "pcl_ros/filters/search_cache.hpp"
 
 namespace pcl_ros
 {
 /** \brief @b RadiusOutlierRemoval is a simple filter that removes outliers if the number of neighbors in a certain
   * search radius is smaller than a given K.
+  *
+  * The \a engine parameter selects how neighbors are counted: "kdtree" runs
+  * pcl::RadiusOutlierRemoval, "voxel_hash" counts them exactly on a uniform grid with a cell size
+  * of radius_search, and "cell_count" only counts the points of the 27 cells around each point,
+  * which keeps every inlier but may keep some outliers too. The grid engines run on num_threads
+  * threads.
   * \note setFilterFieldName (), setFilterLimits (), and setFilterLimitNegative () are ignored.
   * \author Radu Bogdan Rusu
   */
@@ -60,9 +71,19 @@ protected:
     */
   inline void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) override;
 
+  /** \brief Compute the indices of the passing points directly on the PointCloud2 buffer.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output_indices the resultant indices into \a input
+    */
+  bool
+  filterIndices(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    std::vector<int> & output_indices) override;
+
   /** \brief Parameter callback
     * \param params parameter values to set
     */
@@ -72,8 +93,69 @@ protected:
   OnSetParametersCallbackHandle::SharedPtr callback_handle_;
 
 private:
-  /** \brief The PCL filter implementation used. */
-  pcl::RadiusOutlierRemoval<pcl::PCLPointCloud2> impl_;
+  /** \brief The neighbor counting engines. */
+  enum class Engine
+  {
+    KdTree,
+    VoxelHash,
+    CellCount
+  };
+
+  typedef pcl::RadiusOutlierRemoval<pcl::PCLPointCloud2> Impl;
+
+  /** \brief The configuration of the filter, edited by config_callback and used by filter () as
+    * immutable snapshots.
+    */
+  struct Config
+  {
+    /** \brief The PCL filter implementation used. */
+    Impl impl;
+
+    /** \brief The selected neighbor counting engine. */
+    Engine engine = Engine::KdTree;
+
+    /** \brief The number of threads of the grid engines, 0 for the number of hardware threads. */
+    int num_threads = 0;
+
+    /** \brief Set to true to get the search tree from the process wide SearchCache. */
+    bool shared_search = false;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  typedef std::shared_ptr<const Config> ConfigConstPtr;
+
+  /** \brief The private state of one filter () call. */
+  struct Workspace
+  {
+    /** \brief A copy of the PCL filter, which setInputCloud () modifies. */
+    ConfigCopy<Impl> impl;
+
+    /** \brief The x, y and z values and search tree of the direct kdtree path, when not shared. */
+    pcl::PointCloud<pcl::PointXYZ>::Ptr xyz_cloud {new pcl::PointCloud<pcl::PointXYZ>};
+    pcl::search::KdTree<pcl::PointXYZ>::Ptr tree {new pcl::search::KdTree<pcl::PointXYZ>};
+
+    /** \brief The keep mask of the direct paths. */
+    std::vector<std::uint8_t> keep;
+  };
+
+  /** \brief The configuration edited by config_callback, under mutex_, and its snapshots. */
+  Config config_;
+  ConfigSnapshot<Config> snapshot_;
+  WorkspacePool<Workspace> workspaces_;
+
+  /** \brief Run the test directly on the PointCloud2 buffer, with the selected engine, and store
+    * its result in the keep mask of \a workspace. The kdtree engine only supports inputs without
+    * indices.
+    * \param config the configuration to use
+    * \param workspace the workspace of the call
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \return false if the input is not supported and the PCL filter must be used instead
+    */
+  bool
+  markDirect(
+    const ConfigConstPtr & config, Workspace & workspace, const PointCloud2 & input,
+    const IndicesConstPtr & indices);
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
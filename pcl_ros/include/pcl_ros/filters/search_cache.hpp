@@ -0,0 +1,115 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__SEARCH_CACHE_HPP_
+#define PCL_ROS__FILTERS__SEARCH_CACHE_HPP_
+
+// PCL includes
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace pcl_ros
+{
+/** \brief @b SearchCache shares the xyz cloud and search tree built for a PointCloud2 between the
+  * components of a process, so that several consumers of the same frame (e.g.
+  * StatisticalOutlierRemoval and RadiusOutlierRemoval subscribed to the same topic in one
+  * container) build it only once.
+  *
+  * Entries are keyed on the header stamp and frame, the dimensions of the cloud and a hash of its
+  * data, so that different clouds published with the same stamp do not collide. Only the most
+  * recent entries are kept.
+  */
+class SearchCache
+{
+public:
+  /** \brief The shared data built for one cloud. Both members are read-only once built. */
+  struct Entry
+  {
+    /** \brief The x, y and z values of the cloud, organized like the input. */
+    pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud;
+    /** \brief A search tree built on \a cloud. */
+    pcl::search::KdTree<pcl::PointXYZ>::ConstPtr search;
+  };
+  using EntryConstPtr = std::shared_ptr<const Entry>;
+
+  /** \brief The number of frames kept in the cache. */
+  static constexpr std::size_t kCapacity = 4;
+
+  /** \brief The cache shared by all components loaded in this process. */
+  static SearchCache &
+  instance();
+
+  /** \brief Return the entry of \a cloud, building it if no other consumer did yet. Concurrent
+    * callers with the same cloud wait for a single build.
+    * \param cloud the input point cloud, with x, y and z fields
+    */
+  EntryConstPtr
+  get(const sensor_msgs::msg::PointCloud2 & cloud);
+
+private:
+  struct Key
+  {
+    std::int32_t sec;
+    std::uint32_t nanosec;
+    std::string frame_id;
+    std::uint32_t width, height, point_step;
+    std::uint64_t hash;
+
+    bool
+    operator==(const Key & other) const;
+  };
+
+  struct Slot
+  {
+    Key key;
+    std::once_flag built;
+    EntryConstPtr entry;
+  };
+
+  SearchCache() = default;
+
+  std::mutex mutex_;
+  std::deque<std::shared_ptr<Slot>> slots_;
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__SEARCH_CACHE_HPP_
@@ -40,8 +40,15 @@
 
 // PCL includes
 #include <pcl/filters/statistical_outlier_removal.h>
+#include <pcl/search/organized.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
+#include "pcl_ros/filters/config_snapshot.hpp"
 #include "pcl_ros/filters/filter.hpp"
+#include "pcl_ros/filters/outlier_masks.hpp"
+#include "pcl_ros/filters/search_cache.hpp"
 
 namespace pcl_ros
 {
@@ -53,6 +60,15 @@ namespace pcl_ros
   *      Robotics and Autonomous Systems Journal (Special Issue on Semantic Knowledge), 2008.
   * </ul>
   *
+  * The \a engine parameter selects how the mean distances are computed: "kdtree" runs
+  * pcl::StatisticalOutlierRemoval, "parallel" runs the same test on num_threads threads, and
+  * "organized" takes the nearest neighbors of organized clouds from a small window of the image
+  * instead of a search tree, which approximates them well on dense range images.
+  *
+  * For a fixed sensor, running_statistics_alpha > 0 keeps the mean and standard deviation of the
+  * distances across frames as an exponentially weighted moving average, and classifies each point
+  * as soon as its distance is known instead of in a second pass.
+  *
   * \note setFilterFieldName (), setFilterLimits (), and setFilterLimitNegative () are ignored.
   * \author Radu Bogdan Rusu
   */
@@ -66,9 +82,19 @@ protected:
     */
   inline void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) override;
 
+  /** \brief Compute the indices of the passing points directly on the PointCloud2 buffer.
+    * \param input the input point cloud dataset
+    * \param indices the input set of indices to use from \a input
+    * \param output_indices the resultant indices into \a input
+    */
+  bool
+  filterIndices(
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+    std::vector<int> & output_indices) override;
+
   /** \brief Parameter callback
     * \param params parameter values to set
     */
@@ -78,8 +104,81 @@ protected:
   OnSetParametersCallbackHandle::SharedPtr callback_handle_;
 
 private:
-  /** \brief The PCL filter implementation used. */
-  pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2> impl_;
+  /** \brief The mean distance engines. */
+  enum class Engine
+  {
+    KdTree,
+    Parallel,
+    Organized
+  };
+
+  typedef pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2> Impl;
+
+  /** \brief The configuration of the filter, edited by config_callback and used by filter () as
+    * immutable snapshots.
+    */
+  struct Config
+  {
+    /** \brief The PCL filter implementation used. */
+    Impl impl;
+
+    /** \brief The selected mean distance engine. */
+    Engine engine = Engine::KdTree;
+
+    /** \brief The number of threads of the parallel engines, 0 for the number of hardware
+      * threads.
+      */
+    int num_threads = 0;
+
+    /** \brief Set to true to get the search tree from the process wide SearchCache. */
+    bool shared_search = false;
+
+    /** \brief The weight of each new frame in the running statistics, 0 to disable them. */
+    double statistics_alpha = 0.0;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  typedef std::shared_ptr<const Config> ConfigConstPtr;
+
+  /** \brief The private state of one filter () call. */
+  struct Workspace
+  {
+    /** \brief A copy of the PCL filter, which setInputCloud () modifies. */
+    ConfigCopy<Impl> impl;
+
+    /** \brief The x, y and z values and search trees of the direct path, when not shared. As in
+      * pcl::StatisticalOutlierRemoval, organized clouds are searched in their image.
+      */
+    pcl::PointCloud<pcl::PointXYZ>::Ptr xyz_cloud {new pcl::PointCloud<pcl::PointXYZ>};
+    pcl::search::KdTree<pcl::PointXYZ>::Ptr tree {new pcl::search::KdTree<pcl::PointXYZ>};
+    pcl::search::OrganizedNeighbor<pcl::PointXYZ>::Ptr organized_tree {
+      new pcl::search::OrganizedNeighbor<pcl::PointXYZ>};
+
+    /** \brief The keep mask of the direct path. */
+    std::vector<std::uint8_t> keep;
+  };
+
+  /** \brief The configuration edited by config_callback, under mutex_, and its snapshots. */
+  Config config_;
+  ConfigSnapshot<Config> snapshot_;
+  WorkspacePool<Workspace> workspaces_;
+
+  /** \brief The running distance statistics, used if running_statistics_alpha > 0, and the
+    * configuration they were started with. Frames using them are processed one at a time.
+    */
+  DistanceStatistics statistics_;
+  ConfigConstPtr statistics_config_;
+  std::mutex statistics_mutex_;
+
+  /** \brief Run the test directly on the PointCloud2 buffer, with the selected engine and search
+    * tree, and store its result in the keep mask of \a workspace.
+    * \param config the configuration to use
+    * \param workspace the workspace of the call
+    * \param input the input point cloud dataset
+    * \return false if the cloud layout is not supported and the PCL filter must be used instead
+    */
+  bool
+  markDirect(const ConfigConstPtr & config, Workspace & workspace, const PointCloud2 & input);
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
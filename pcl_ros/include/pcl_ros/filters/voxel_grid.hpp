@@ -41,6 +41,7 @@
 // PCL includes
 #include <pcl/filters/voxel_grid.h>
 #include <vector>
+#include "pcl_ros/filters/config_snapshot.hpp"
 #include "pcl_ros/filters/filter.hpp"
 
 namespace pcl_ros
@@ -58,7 +59,7 @@ protected:
     */
   inline void
   filter(
-    const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+    const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
     PointCloud2 & output) override;
 
   /** \brief Parameter callback
@@ -70,8 +71,16 @@ protected:
   OnSetParametersCallbackHandle::SharedPtr callback_handle_;
 
 private:
-  /** \brief The PCL filter implementation used. */
-  pcl::VoxelGrid<pcl::PCLPointCloud2> impl_;
+  typedef pcl::VoxelGrid<pcl::PCLPointCloud2> Impl;
+
+  /** \brief The PCL filter configured by config_callback, under mutex_. */
+  Impl impl_;
+
+  /** \brief The configurations of \a impl_ used by filter (), and the private copies of the
+    * concurrent filter () calls.
+    */
+  ConfigSnapshot<Impl> snapshot_;
+  WorkspacePool<ConfigCopy<Impl>> workspaces_;
 
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -0,0 +1,72 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__FILTERS__VOXEL_HASH_HPP_
+#define PCL_ROS__FILTERS__VOXEL_HASH_HPP_
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstdint>
+#include <vector>
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+
+namespace pcl_ros
+{
+/** \brief Radius outlier test of pcl::RadiusOutlierRemoval on a uniform grid instead of a search
+  * tree. Points are hashed into cubic cells with a side of \a radius, so that all neighbors of a
+  * point lie in the 27 cells around its own, and the cells are processed in parallel. See
+  * markStatisticalOutliers () for the handling of \a keep.
+  *
+  * In \a cell_count_only mode the neighbors are not tested against \a radius at all: every point
+  * of the 27 cells counts, which overestimates the number of neighbors by up to a factor of
+  * (3 * sqrt(3))^3 / (4 / 3 * pi) and thus only removes points that are certainly outliers.
+  * \param cloud the input point cloud, see isDirectlyAccessible ()
+  * \param xyz the offsets of the x, y and z fields
+  * \param indices if not null, only these points are tested and considered as neighbors
+  * \param radius the radius of the sphere that determines which points are neighbors, no point is
+  * kept if it is not greater than 0
+  * \param min_neighbors the number of neighbors an inlier needs inside \a radius
+  * \param negative true if the outliers should be kept instead of the inliers
+  * \param cell_count_only true to count the points of the neighboring cells instead
+  * \param num_threads the maximum number of threads to use
+  * \param keep one entry per point of \a cloud, non zero if the point is kept
+  */
+void
+markRadiusOutliersVoxelHash(
+  const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz,
+  const std::vector<int> * indices, double radius, int min_neighbors, bool negative,
+  bool cell_count_only, unsigned int num_threads, std::vector<std::uint8_t> & keep);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__FILTERS__VOXEL_HASH_HPP_
@@ -51,8 +51,6 @@
 #include <pcl/pcl_base.h>
 #include <pcl/point_types.h>
 #include <pcl_conversions/pcl_conversions.h>
-// ROS Nodelet includes
-// #include <nodelet_topic_tools/nodelet_lazy.h>  // TODO(daisukes): lazy subscription
 #include <message_filters/subscriber.h>
 #include <message_filters/synchronizer.h>
 #include <message_filters/sync_policies/exact_time.h>
@@ -63,14 +61,36 @@
 #include <tf2_ros/buffer.h>
 
 // STL
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 // ROS2 includes
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include <rclcpp/rclcpp.hpp>
+#if __has_include(<rclcpp/version.h>)
+#include <rclcpp/version.h>
+#endif
 
 // #include "pcl_ros/point_cloud.hpp"
 
+// rclcpp/version.h exists from Humble on, Subscription::take is used from there on and the
+// matched events of publishers (rclcpp 21) from Iron on
+#ifdef RCLCPP_VERSION_GTE
+#if RCLCPP_VERSION_GTE(16, 0, 0)
+#define PCL_ROS_HAS_SUBSCRIPTION_TAKE 1
+#endif
+#if RCLCPP_VERSION_GTE(21, 0, 0)
+#define PCL_ROS_HAS_MATCHED_EVENTS 1
+#endif
+#endif
+
 using pcl_conversions::fromPCL;
 
 namespace pcl_ros
@@ -79,7 +99,24 @@ namespace pcl_ros
 ////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////
 /** \brief @b PCLNode represents the base PCL Node class. All PCL node should inherit from
- *  this class. */
+ *  this class.
+ *
+ *  The callbacks of a node are split into callback groups, which a MultiThreadedExecutor runs
+ *  independently of each other:
+ *  - The input subscriptions, and the matched events of the output publishers or the timer
+ *    polling them in lazy mode, are in the data callback group. It is mutually exclusive by
+ *    default: a node processes one point cloud at a time and publishes in order, while the
+ *    other nodes of the container process theirs in parallel. If data_callback_group is
+ *    reentrant, the executor threads process several point clouds of the node at once, which
+ *    may then be published out of order.
+ *  - The parameter services stay in the default callback group, so that parameter updates are
+ *    not queued behind the processing of a point cloud. rclcpp creates them there and has no
+ *    option to put them in another group, so this one is not configurable.
+ *  - TF is received in a callback group of its own. By default it is spun by the thread of the
+ *    TransformListener, so that transforms keep arriving while all the executor threads are
+ *    busy. With tf_callback_group set to mutually_exclusive or reentrant, the executor of the
+ *    node spins it instead, which saves a thread per node in large containers.
+ */
 template<typename T, typename PublisherT = rclcpp::Publisher<T>>
 class PCLNode : public rclcpp::Node
 {
@@ -105,9 +142,9 @@ public:
   PCLNode(std::string node_name, const rclcpp::NodeOptions & options)
   : rclcpp::Node(node_name, options),
     use_indices_(false), transient_local_indices_(false),
-    max_queue_size_(3), approximate_sync_(false),
-    tf_buffer_(this->get_clock()),
-    tf_listener_(tf_buffer_)
+    max_queue_size_(3), approximate_sync_(false), keep_latest_(false), max_input_age_(0.0),
+    lazy_(false), nr_accepted_(0), nr_dropped_queued_(0), nr_dropped_stale_(0),
+    tf_buffer_(this->get_clock())
   {
     {
       rcl_interfaces::msg::ParameterDescriptor desc;
@@ -131,7 +168,9 @@ public:
       rcl_interfaces::msg::ParameterDescriptor desc;
       desc.name = "transient_local_indices";
       desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
-      desc.description = "Does indices topic use transient local documentation";
+      desc.description =
+        "Use the most recent message of a transient local indices topic for every point cloud, "
+        "instead of synchronizing the indices with the point clouds";
       desc.read_only = true;
       transient_local_indices_ = declare_parameter(desc.name, transient_local_indices_, desc);
     }
@@ -146,16 +185,124 @@ public:
       approximate_sync_ = declare_parameter(desc.name, approximate_sync_, desc);
     }
 
+    {
+      rcl_interfaces::msg::ParameterDescriptor desc;
+      desc.name = "keep_latest";
+      desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+      desc.description =
+        "Process only the newest point cloud, dropping the ones queued while the previous one was "
+        "processed. Not applied to point clouds synchronized with indices.";
+      desc.read_only = true;
+      keep_latest_ = declare_parameter(desc.name, keep_latest_, desc);
+#ifndef PCL_ROS_HAS_SUBSCRIPTION_TAKE
+      if (keep_latest_) {
+        RCLCPP_INFO(
+          get_logger(), "keep_latest only keeps the newest point cloud in the input queue, "
+          "this rclcpp cannot take the queued ones.");
+      }
+#endif
+    }
+
+    {
+      rcl_interfaces::msg::ParameterDescriptor desc;
+      desc.name = "max_input_age";
+      desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+      desc.description =
+        "Drop the point clouds whose header stamp is older than this many seconds when their "
+        "processing starts, 0 to process them all.";
+      desc.read_only = true;
+      rcl_interfaces::msg::FloatingPointRange range;
+      range.from_value = 0.0;
+      range.to_value = 3600.0;
+      desc.floating_point_range.push_back(range);
+      max_input_age_ = declare_parameter(desc.name, max_input_age_, desc);
+    }
+
+    {
+      rcl_interfaces::msg::ParameterDescriptor desc;
+      desc.name = "lazy";
+      desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+      desc.description =
+        "Only subscribe to the inputs, and process them, while the outputs have subscribers.";
+      desc.read_only = true;
+      lazy_ = declare_parameter(desc.name, lazy_, desc);
+    }
+
+    {
+      rcl_interfaces::msg::ParameterDescriptor desc;
+      desc.name = "data_callback_group";
+      desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+      desc.description =
+        "Type of the callback group of the input subscriptions: mutually_exclusive processes one "
+        "point cloud at a time, reentrant lets a multi-threaded executor process several at once "
+        "and publish them out of order.";
+      desc.read_only = true;
+      const std::string type =
+        declare_parameter(desc.name, std::string("mutually_exclusive"), desc);
+      if (type == "reentrant") {
+        if (lazy_) {
+          // unsubscribe () would release a subscription in use by another executor thread
+          throw std::runtime_error("lazy cannot be used with a reentrant data_callback_group");
+        }
+        data_callback_group_ = create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+      } else if (type == "mutually_exclusive") {
+        data_callback_group_ =
+          create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+      } else {
+        const std::string reason = "Unknown data_callback_group " + type +
+          ", expected mutually_exclusive or reentrant";
+        throw std::runtime_error(reason);
+      }
+    }
+
+    {
+      rcl_interfaces::msg::ParameterDescriptor desc;
+      desc.name = "tf_callback_group";
+      desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+      desc.description =
+        "Type of the callback group of the TF subscriptions: dedicated receives TF on a thread "
+        "of its own, mutually_exclusive and reentrant leave it to the executor of the node.";
+      desc.read_only = true;
+      const std::string type = declare_parameter(desc.name, std::string("dedicated"), desc);
+      if (type == "dedicated") {
+        tf_listener_.reset(new tf2_ros::TransformListener(tf_buffer_, this, true));
+      } else if (type == "mutually_exclusive" || type == "reentrant") {
+        tf_callback_group_ = create_callback_group(
+          type == "reentrant" ? rclcpp::CallbackGroupType::Reentrant :
+          rclcpp::CallbackGroupType::MutuallyExclusive);
+        rclcpp::SubscriptionOptions options;
+        options.callback_group = tf_callback_group_;
+        tf_listener_.reset(
+          new tf2_ros::TransformListener(
+            tf_buffer_, this, false, tf2_ros::DynamicListenerQoS(),
+            tf2_ros::StaticListenerQoS(), options, options));
+      } else {
+        const std::string reason = "Unknown tf_callback_group " + type +
+          ", expected dedicated, mutually_exclusive or reentrant";
+        throw std::runtime_error(reason);
+      }
+    }
+
+    if (keep_latest_ || max_input_age_ > 0.0) {
+      enableDiagnostics();
+    }
+
     RCLCPP_DEBUG(
       this->get_logger(), "PCL Node successfully created with the following parameters:\n"
       " - approximate_sync          : %s\n"
       " - use_indices               : %s\n"
       " - transient_local_indices_  : %s\n"
-      " - max_queue_size            : %d",
+      " - max_queue_size            : %d\n"
+      " - keep_latest               : %s\n"
+      " - max_input_age             : %f\n"
+      " - lazy                      : %s",
       (approximate_sync_) ? "true" : "false",
       (use_indices_) ? "true" : "false",
       (transient_local_indices_) ? "true" : "false",
-      max_queue_size_);
+      max_queue_size_,
+      (keep_latest_) ? "true" : "false",
+      max_input_age_,
+      (lazy_) ? "true" : "false");
   }
 
 protected:
@@ -198,9 +345,38 @@ protected:
     **/
   bool approximate_sync_;
 
-  /** \brief TF listener object. */
-  tf2_ros::TransformListener tf_listener_;
+  /** \brief Set to true to process only the newest point cloud, see \ref takeLatest. */
+  bool keep_latest_;
+
+  /** \brief The point clouds older than this many seconds are dropped, 0 to process them all.
+    * See \ref acceptInput.
+    */
+  double max_input_age_;
+
+  /** \brief Set to true to only subscribe to the inputs while the outputs have subscribers. See
+    * \ref createOutputPublisher and \ref lazySubscribe.
+    */
+  bool lazy_;
+
+  /** \brief Number of point clouds accepted for processing, dropped because newer ones were
+    * queued behind them, and dropped because they were older than \a max_input_age_.
+    */
+  std::atomic<std::uint64_t> nr_accepted_;
+  std::atomic<std::uint64_t> nr_dropped_queued_;
+  std::atomic<std::uint64_t> nr_dropped_stale_;
+
+  /** \brief The publisher of the counters of this node on diagnostics, if enabled. */
+  rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr pub_diagnostics_;
+
+  /** \brief The callback group of the input subscriptions and of the output publishers. */
+  rclcpp::CallbackGroup::SharedPtr data_callback_group_;
+
+  /** \brief TF buffer, and the listener filling it from its own callback group, spun by its own
+    * thread or by the executor, see tf_callback_group.
+    */
   tf2_ros::Buffer tf_buffer_;
+  rclcpp::CallbackGroup::SharedPtr tf_callback_group_;
+  std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
   
   /** \brief Test whether a given PointCloud message is "valid" (i.e., has points, and width and height are non-zero).
     * \param cloud the point cloud to test
@@ -283,12 +459,282 @@ protected:
     return true;
   }
 
+  /** \brief Extract the points of \a cloud selected by \a indices, e.g. received from a filter
+    * running with output_mode set to indices. Consumers that can process a subset of a cloud
+    * directly should rather set use_indices and subscribe to both topics, which avoids the copy.
+    * \param cloud the point cloud the indices refer to
+    * \param indices the indices of the points to extract
+    * \param output the resultant unorganized point cloud
+    * \return false if an index is out of range
+    */
+  inline bool
+  applyIndices(const PointCloud2 & cloud, const PointIndices & indices, PointCloud2 & output)
+  {
+    const std::size_t nr_points = static_cast<std::size_t>(cloud.width) * cloud.height;
+    output.header = cloud.header;
+    output.fields = cloud.fields;
+    output.is_bigendian = cloud.is_bigendian;
+    output.point_step = cloud.point_step;
+    output.is_dense = cloud.is_dense;
+    output.height = 1;
+    output.width = static_cast<uint32_t>(indices.indices.size());
+    output.row_step = output.width * output.point_step;
+    output.data.resize(static_cast<std::size_t>(output.row_step));
+    for (std::size_t i = 0; i < indices.indices.size(); ++i) {
+      const int32_t index = indices.indices[i];
+      if (index < 0 || static_cast<std::size_t>(index) >= nr_points) {
+        RCLCPP_WARN(
+          this->get_logger(), "Index %d out of range of a PointCloud with %zu points!", index,
+          nr_points);
+        return false;
+      }
+      std::memcpy(
+        &output.data[i * output.point_step], &cloud.data[index * cloud.point_step],
+        cloud.point_step);
+    }
+    return true;
+  }
+
+  /** \brief With keep_latest set, take the point clouds queued behind \a cloud out of
+    * \a subscription and keep only the newest one. The others are counted as dropped.
+    * Intra-process messages are not queued in the middleware and are not taken.
+    * \param subscription the subscription \a cloud was received on
+    * \param cloud the received point cloud, replaced by the newest one queued
+    */
+  void
+  takeLatest(rclcpp::Subscription<PointCloud2> & subscription, PointCloud2::ConstSharedPtr & cloud)
+  {
+#ifdef PCL_ROS_HAS_SUBSCRIPTION_TAKE
+    if (!keep_latest_) {
+      return;
+    }
+    rclcpp::MessageInfo message_info;
+    auto newer = std::make_shared<PointCloud2>();
+    while (subscription.take(*newer, message_info)) {
+      ++nr_dropped_queued_;
+      cloud = newer;
+      newer = std::make_shared<PointCloud2>();
+    }
+#else
+    // The input history depth is 1 instead, see inputQueueSize
+    (void)subscription;
+    (void)cloud;
+#endif
+  }
+
+  /** \brief Return the history depth of the unsynchronized input point cloud subscriptions.
+    * Where rclcpp cannot take the queued point clouds, keep_latest keeps only the newest one in
+    * the queue of the subscription instead.
+    */
+  int
+  inputQueueSize() const
+  {
+#ifndef PCL_ROS_HAS_SUBSCRIPTION_TAKE
+    if (keep_latest_) {
+      return 1;
+    }
+#endif
+    return max_queue_size_;
+  }
+
+  /** \brief Check a point cloud against max_input_age before processing it, and count it.
+    * Point clouds without stamp are always accepted.
+    * \param header the header of the point cloud
+    * \return false if the point cloud is too old and must be dropped
+    */
+  bool
+  acceptInput(const std_msgs::msg::Header & header)
+  {
+    if (max_input_age_ > 0.0 && (header.stamp.sec != 0 || header.stamp.nanosec != 0)) {
+      const rclcpp::Time stamp(header.stamp, this->get_clock()->get_clock_type());
+      if ((this->now() - stamp).seconds() > max_input_age_) {
+        ++nr_dropped_stale_;
+        RCLCPP_DEBUG(
+          this->get_logger(), "Dropping a PointCloud with stamp %d.%09d older than %f s.",
+          header.stamp.sec, header.stamp.nanosec, max_input_age_);
+        publishInputStatistics();
+        return false;
+      }
+    }
+    ++nr_accepted_;
+    publishInputStatistics();
+    return true;
+  }
+
+  /** \brief Create the diagnostics publisher, if not done yet. */
+  void
+  enableDiagnostics()
+  {
+    if (!pub_diagnostics_) {
+      pub_diagnostics_ = this->template create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+        "diagnostics", rclcpp::QoS(1));
+    }
+  }
+
+  /** \brief Publish a status of this node with a list of counters on diagnostics.
+    * \param name the name of the status, appended to the name of the node
+    * \param counters the names and values of the counters
+    */
+  void
+  publishDiagnostics(
+    const std::string & name,
+    const std::vector<std::pair<const char *, std::uint64_t>> & counters)
+  {
+    diagnostic_msgs::msg::DiagnosticArray::UniquePtr diagnostics(
+      new diagnostic_msgs::msg::DiagnosticArray);
+    diagnostics->header.stamp = this->now();
+    diagnostics->status.resize(1);
+    diagnostic_msgs::msg::DiagnosticStatus & status = diagnostics->status[0];
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = std::string(this->get_fully_qualified_name()) + ": " + name;
+    status.message = "OK";
+    for (const auto & counter : counters) {
+      diagnostic_msgs::msg::KeyValue value;
+      value.key = counter.first;
+      value.value = std::to_string(counter.second);
+      status.values.push_back(value);
+    }
+    pub_diagnostics_->publish(std::move(diagnostics));
+  }
+
+  /** \brief Create an output publisher in the data callback group. In lazy mode, the inputs are
+    * subscribed to when the first subscription to an output appears, and unsubscribed from when
+    * the last one goes away: on the matched events of the publishers where rclcpp has them,
+    * otherwise by polling their subscription counts, see \ref lazySubscribe.
+    * \param topic the output topic
+    */
+  template<typename MessageT>
+  typename rclcpp::Publisher<MessageT>::SharedPtr
+  createOutputPublisher(const std::string & topic)
+  {
+    rclcpp::PublisherOptions options;
+    options.callback_group = data_callback_group_;
+#ifdef PCL_ROS_HAS_MATCHED_EVENTS
+    if (lazy_) {
+      options.event_callbacks.matched_callback =
+        [this](rclcpp::MatchedInfo & info) {
+          outputMatched(info.current_count_change);
+        };
+    }
+#endif
+    auto publisher =
+      this->template create_publisher<MessageT>(topic, max_queue_size_, options);
+    output_publishers_.push_back(publisher);
+    return publisher;
+  }
+
+  /** \brief Return the options of the input subscriptions, in the data callback group. */
+  rclcpp::SubscriptionOptions
+  inputSubscriptionOptions() const
+  {
+    rclcpp::SubscriptionOptions options;
+    options.callback_group = data_callback_group_;
+    return options;
+  }
+
+  /** \brief Subscribe to the inputs, or in lazy mode, leave it to the matched events of the
+    * output publishers. To be called at the end of the constructor of every node.
+    */
+  void
+  lazySubscribe()
+  {
+    if (!lazy_) {
+      subscribe();
+      return;
+    }
+#ifndef PCL_ROS_HAS_MATCHED_EVENTS
+    // Without matched events, poll the output publishers in place of them
+    output_poll_timer_ = this->create_wall_timer(
+      std::chrono::milliseconds(200),
+      [this]() {
+        int count = 0;
+        for (const auto & publisher : output_publishers_) {
+          count += static_cast<int>(publisher->get_subscription_count());
+        }
+        const int change = count - nr_output_subscriptions_.load();
+        if (change != 0) {
+          outputMatched(change);
+        }
+      }, data_callback_group_);
+#endif
+    RCLCPP_DEBUG(this->get_logger(), "Waiting for subscribers to the outputs.");
+  }
+
+  /** \brief Test whether the outputs have subscribers. Always true when not lazy. */
+  bool
+  hasOutputSubscribers() const
+  {
+    return !lazy_ || nr_output_subscriptions_.load() > 0;
+  }
+
   /** \brief Lazy transport subscribe/unsubscribe routine.
     * It is optional for backward compatibility.
     **/
   virtual void subscribe() {}
   virtual void unsubscribe() {}
 
+private:
+  /** \brief The publishers created by \ref createOutputPublisher. */
+  std::vector<rclcpp::PublisherBase::SharedPtr> output_publishers_;
+
+  /** \brief The timer polling the subscription counts of the output publishers, in lazy mode
+    * where rclcpp has no matched events.
+    */
+  rclcpp::TimerBase::SharedPtr output_poll_timer_;
+
+  /** \brief The number of subscriptions matched by the output publishers, in lazy mode. */
+  std::atomic<int> nr_output_subscriptions_{0};
+
+  /** \brief Set to true while subscribed to the inputs in lazy mode, protected by
+    * \a lazy_mutex_.
+    */
+  bool subscribed_ = false;
+  std::mutex lazy_mutex_;
+
+  /** \brief Matched event of an output publisher, in lazy mode.
+    * \param change the change in the number of subscriptions matched by the publisher
+    */
+  void
+  outputMatched(int change)
+  {
+    std::lock_guard<std::mutex> lock(lazy_mutex_);
+    const int count = nr_output_subscriptions_ += change;
+    if (count > 0 && !subscribed_) {
+      RCLCPP_DEBUG(this->get_logger(), "The outputs have subscribers, subscribing to the inputs.");
+      subscribe();
+      subscribed_ = true;
+    } else if (count <= 0 && subscribed_) {
+      RCLCPP_DEBUG(
+        this->get_logger(), "The outputs have no subscribers, unsubscribing from the inputs.");
+      unsubscribe();
+      subscribed_ = false;
+    }
+  }
+
+  /** \brief The time the input counters were last published. */
+  std::atomic<std::int64_t> last_input_statistics_{0};
+
+  /** \brief Publish the input counters on diagnostics, at most once per second. */
+  void
+  publishInputStatistics()
+  {
+    if (!pub_diagnostics_) {
+      return;
+    }
+    const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::int64_t last = last_input_statistics_.load();
+    // Only one of concurrent callers publishes
+    if (now - last < 1000000000 || !last_input_statistics_.compare_exchange_strong(last, now)) {
+      return;
+    }
+    publishDiagnostics(
+      "input", {
+        {"accepted", nr_accepted_.load()},
+        {"dropped_queued", nr_dropped_queued_.load()},
+        {"dropped_stale", nr_dropped_stale_.load()}});
+  }
+
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
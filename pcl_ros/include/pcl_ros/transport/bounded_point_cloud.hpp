@@ -0,0 +1,73 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__TRANSPORT__BOUNDED_POINT_CLOUD_HPP_
+#define PCL_ROS__TRANSPORT__BOUNDED_POINT_CLOUD_HPP_
+
+#include <pcl_ros_interfaces/msg/bounded_point_cloud2.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace pcl_ros
+{
+/** \brief Test whether a point cloud fits in a BoundedPointCloud2: its frame id, field names,
+  * number of fields and data are within the capacities of the message.
+  * \param cloud the point cloud to test
+  */
+bool
+fitsBounded(const sensor_msgs::msg::PointCloud2 & cloud);
+
+/** \brief Copy a point cloud into a BoundedPointCloud2, e.g. a message loaned by the middleware.
+  * Only the used part of the buffers is written, the rest of the message is left as is.
+  * \param cloud the point cloud to copy
+  * \param bounded the resultant message
+  * \return false, leaving \a bounded unchanged, if \a cloud does not fit, see fitsBounded ()
+  */
+bool
+toBounded(
+  const sensor_msgs::msg::PointCloud2 & cloud,
+  pcl_ros_interfaces::msg::BoundedPointCloud2 & bounded);
+
+/** \brief Copy a BoundedPointCloud2 into a point cloud.
+  * \param bounded the message to copy
+  * \param cloud the resultant point cloud, whose buffers are reused if large enough
+  * \return false if the sizes of \a bounded exceed its capacities
+  */
+bool
+fromBounded(
+  const pcl_ros_interfaces::msg::BoundedPointCloud2 & bounded,
+  sensor_msgs::msg::PointCloud2 & cloud);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__TRANSPORT__BOUNDED_POINT_CLOUD_HPP_
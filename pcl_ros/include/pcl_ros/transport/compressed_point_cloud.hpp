@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__TRANSPORT__COMPRESSED_POINT_CLOUD_HPP_
+#define PCL_ROS__TRANSPORT__COMPRESSED_POINT_CLOUD_HPP_
+
+#include <point_cloud_interfaces/msg/compressed_point_cloud2.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <rclcpp/rclcpp.hpp>
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/transport/point_cloud_codec.hpp"
+
+namespace pcl_ros
+{
+/** \brief Declare the read-only parameters of the point cloud codec on a node, and return the
+  * options they select. The parameters are named \a prefix.precision, .compressor,
+  * .compression_level, .field_codecs, .block_points and .num_threads.
+  * Throws std::runtime_error on an unknown compressor or field codec.
+  * \param node the node to declare the parameters on
+  * \param prefix the prefix of the parameter names
+  */
+CodecOptions
+declareCodecParameters(rclcpp::Node & node, const std::string & prefix);
+
+/** \brief @b CompressedPublisher publishes point clouds encoded by encodePointCloud on the
+  * \a topic/quantized sub-topic of a point cloud topic, as CompressedPointCloud2 messages in the
+  * format of point_cloud_transport. The raw point clouds stay on the publisher of the topic.
+  */
+class CompressedPublisher
+{
+public:
+  /** \brief Constructor.
+    * \param node the node publishing
+    * \param topic the topic of the raw point clouds
+    * \param qos the quality of service of the compressed topic
+    * \param options the codec options
+    * \param publisher_options the options of the publisher
+    */
+  CompressedPublisher(
+    rclcpp::Node & node, const std::string & topic, const rclcpp::QoS & qos,
+    const CodecOptions & options,
+    const rclcpp::PublisherOptions & publisher_options = rclcpp::PublisherOptions());
+
+  /** \brief Encode and publish a point cloud, if the compressed topic has subscribers. */
+  void
+  publish(const sensor_msgs::msg::PointCloud2 & cloud);
+
+  /** \brief Get the number of subscribers of the compressed topic. */
+  std::size_t
+  getNumSubscribers() const;
+
+private:
+  CodecOptions options_;
+  rclcpp::Logger logger_;
+  rclcpp::Publisher<point_cloud_interfaces::msg::CompressedPointCloud2>::SharedPtr publisher_;
+};
+
+/** \brief @b CompressedSubscriber subscribes to the point clouds of a topic, either raw or from
+  * its \a topic/quantized sub-topic, and hands them decoded to a callback.
+  */
+class CompressedSubscriber
+{
+public:
+  typedef std::function<void (const sensor_msgs::msg::PointCloud2::ConstSharedPtr &)> Callback;
+
+  /** \brief Constructor.
+    * \param node the node subscribing
+    * \param topic the topic of the raw point clouds
+    * \param transport raw to subscribe to \a topic, or quantized to its compressed sub-topic.
+    * Throws std::runtime_error otherwise.
+    * \param qos the quality of service of the subscription
+    * \param callback the function to call with every point cloud
+    * \param num_threads the number of threads decoding each point cloud, 0 for the number of
+    * hardware threads
+    * \param subscription_options the options of the subscription
+    */
+  CompressedSubscriber(
+    rclcpp::Node & node, const std::string & topic, const std::string & transport,
+    const rclcpp::QoS & qos, Callback callback, int num_threads = 1,
+    const rclcpp::SubscriptionOptions & subscription_options = rclcpp::SubscriptionOptions());
+
+  /** \brief Get the topic subscribed to. */
+  std::string
+  getTopic() const;
+
+private:
+  rclcpp::SubscriptionBase::SharedPtr subscription_;
+
+  /** \brief The threads decoding the point clouds, shared with the subscription callback. */
+  std::shared_ptr<ThreadPool> thread_pool_;
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__TRANSPORT__COMPRESSED_POINT_CLOUD_HPP_
@@ -0,0 +1,75 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__TRANSPORT__COMPRESSED_RELAY_HPP_
+#define PCL_ROS__TRANSPORT__COMPRESSED_RELAY_HPP_
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <memory>
+#include <rclcpp/rclcpp.hpp>
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/transport/compressed_point_cloud.hpp"
+
+namespace pcl_ros
+{
+/** \brief @b CompressedRelay republishes the point clouds received on \a input compressed on
+  * \a output/quantized, with the codec set by its compression.* parameters. Run it in the
+  * container of a filter to compress its output without the filter knowing about the codec.
+  * The clouds are only encoded while \a output/quantized has subscribers.
+  */
+class CompressedRelay : public rclcpp::Node
+{
+public:
+  explicit CompressedRelay(const rclcpp::NodeOptions & options);
+
+private:
+  /** \brief Input point cloud callback.
+    * \param cloud the pointer to the input point cloud
+    */
+  void
+  input_callback(const sensor_msgs::msg::PointCloud2::ConstSharedPtr & cloud);
+
+  /** \brief The threads encoding each point cloud. */
+  ThreadPool thread_pool_;
+
+  /** \brief The publisher of the compressed point clouds. */
+  std::unique_ptr<CompressedPublisher> pub_output_;
+
+  /** \brief The input PointCloud subscriber. */
+  rclcpp::Subscription<sensor_msgs::msg::PointCloud2>::SharedPtr sub_input_;
+};
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__TRANSPORT__COMPRESSED_RELAY_HPP_
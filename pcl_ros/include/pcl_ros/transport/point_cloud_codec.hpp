@@ -0,0 +1,133 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_ROS__TRANSPORT__POINT_CLOUD_CODEC_HPP_
+#define PCL_ROS__TRANSPORT__POINT_CLOUD_CODEC_HPP_
+
+#include <point_cloud_interfaces/msg/compressed_point_cloud2.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace pcl_ros
+{
+/** \brief The format of the CompressedPointCloud2 messages encoded by encodePointCloud. */
+extern const char * const kQuantizedFormat;
+
+/** \brief How the values of a field are coded before compression. */
+enum class FieldCodec : std::uint8_t
+{
+  /** \brief The values are copied as they are. */
+  Raw = 0,
+  /** \brief Each value is replaced by its difference with the previous point, losslessly. */
+  Delta = 1,
+  /** \brief FLOAT32 and FLOAT64 values are rounded to a multiple of the precision, then delta
+    * coded. Other datatypes are delta coded.
+    */
+  Quantized = 2
+};
+
+/** \brief The general purpose compressor applied to the coded values. */
+enum class Compressor : std::uint8_t
+{
+  None = 0,
+  Lz4 = 1,
+  Zstd = 2
+};
+
+/** \brief The options of encodePointCloud. */
+struct CodecOptions
+{
+  /** \brief The step in meters of the Quantized fields, 0 to delta code them losslessly. */
+  double precision = 0.001;
+  /** \brief The compressor of the coded values. */
+  Compressor compressor = Compressor::Zstd;
+  /** \brief The zstd compression level, or the LZ4 acceleration. */
+  int compression_level = 1;
+  /** \brief The codec of each field by name. x, y and z default to Quantized, and the other
+    * fields to Raw.
+    */
+  std::map<std::string, FieldCodec> field_codecs;
+  /** \brief The number of points coded and compressed together, the unit of parallelism. */
+  std::size_t block_points = 32768;
+  /** \brief The number of threads encoding the blocks, 0 for the number of hardware threads. */
+  int num_threads = 1;
+};
+
+/** \brief Parse the name of a field codec: raw, delta or quantized.
+  * \return false if \a name is unknown
+  */
+bool
+parseFieldCodec(const std::string & name, FieldCodec & codec);
+
+/** \brief Parse the name of a compressor: none, lz4 or zstd.
+  * \return false if \a name is unknown
+  */
+bool
+parseCompressor(const std::string & name, Compressor & compressor);
+
+/** \brief Encode a point cloud. Every field is coded as a separate column of values, split into
+  * blocks of points which are coded and compressed independently, in parallel.
+  *
+  * The padding bytes between and after the fields are not kept. The encoded data is in the byte
+  * order of the host, like the data of the point cloud, and can only be decoded by a host of the
+  * same byte order.
+  * \param cloud the point cloud to encode
+  * \param options the codecs and compressor to use
+  * \param compressed the resultant message, with the layout of \a cloud
+  * \return false if the layout of \a cloud does not match its data
+  */
+bool
+encodePointCloud(
+  const sensor_msgs::msg::PointCloud2 & cloud, const CodecOptions & options,
+  point_cloud_interfaces::msg::CompressedPointCloud2 & compressed);
+
+/** \brief Decode a point cloud encoded by encodePointCloud, decompressing its blocks in parallel.
+  * The padding bytes of the points are set to zero, and the rows are not padded.
+  * \param compressed the encoded message
+  * \param cloud the resultant point cloud
+  * \param num_threads the number of threads, 0 for the number of hardware threads
+  * \return false if \a compressed is not in kQuantizedFormat or is corrupted
+  */
+bool
+decodePointCloud(
+  const point_cloud_interfaces::msg::CompressedPointCloud2 & compressed,
+  sensor_msgs::msg::PointCloud2 & cloud, int num_threads = 1);
+}  // namespace pcl_ros
+
+#endif  // PCL_ROS__TRANSPORT__POINT_CLOUD_CODEC_HPP_
@@ -0,0 +1,330 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/box_set.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+/** \brief Maximum number of boxes in a leaf of the hierarchy. */
+const std::size_t kLeafSize = 4;
+
+/** \brief Maximum depth of the hierarchy, far more than kLeafSize * 2^kMaxDepth boxes need. */
+const std::size_t kMaxDepth = 48;
+
+/** \brief Load the x, y and z values of a block of points into separate arrays. */
+inline void
+loadBlock(
+  const std::uint8_t * const * points, std::size_t n, const pcl_ros::XYZOffsets & xyz,
+  float * x, float * y, float * z)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    std::memcpy(&x[i], points[i] + xyz.x, sizeof(float));
+    std::memcpy(&y[i], points[i] + xyz.y, sizeof(float));
+    std::memcpy(&z[i], points[i] + xyz.z, sizeof(float));
+  }
+}
+}  // namespace
+
+constexpr std::size_t pcl_ros::BoxSet::kBlockSize;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BoxSet::assign(const std::vector<OrientedBox> & boxes)
+{
+  std::vector<Box> transformed(boxes.size());
+  bounds_.resize(6 * boxes.size());
+  has_union_ = has_subtract_ = false;
+  for (std::size_t b = 0; b < boxes.size(); ++b) {
+    const OrientedBox & in = boxes[b];
+    Box & box = transformed[b];
+    box.subtract = in.subtract;
+    has_union_ |= !in.subtract;
+    has_subtract_ |= in.subtract;
+
+    // Rotation of the box frame, like pcl::getTransformation (): Rz (yaw) Ry (pitch) Rx (roll)
+    const float cr = std::cos(in.pose[3]), sr = std::sin(in.pose[3]);
+    const float cp = std::cos(in.pose[4]), sp = std::sin(in.pose[4]);
+    const float cy = std::cos(in.pose[5]), sy = std::sin(in.pose[5]);
+    const float r[3][3] = {
+      {cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr},
+      {sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr},
+      {-sp, cp * sr, cp * cr}};
+    box.aligned = true;
+    for (int i = 0; i < 6; ++i) {
+      box.aligned &= in.pose[i] == 0.0f;
+    }
+    // A point p is in the box frame at R^T (p - t)
+    for (int j = 0; j < 3; ++j) {
+      box.offset[j] = 0.0f;
+      for (int i = 0; i < 3; ++i) {
+        box.rotation[j][i] = r[i][j];
+        box.offset[j] -= r[i][j] * in.pose[i];
+      }
+      box.min_pt[j] = in.min_pt[j];
+      box.max_pt[j] = in.max_pt[j];
+    }
+    // Bounding box in the point frame, from the center and half extents of the box
+    for (int i = 0; i < 3; ++i) {
+      float center = in.pose[i];
+      float extent = 0.0f;
+      for (int j = 0; j < 3; ++j) {
+        center += r[i][j] * 0.5f * (in.min_pt[j] + in.max_pt[j]);
+        extent += std::fabs(r[i][j]) * 0.5f * (in.max_pt[j] - in.min_pt[j]);
+      }
+      bounds_[6 * b + i] = center - extent;
+      bounds_[6 * b + 3 + i] = center + extent;
+    }
+  }
+
+  nodes_.clear();
+  std::vector<std::uint32_t> order(boxes.size());
+  for (std::size_t b = 0; b < order.size(); ++b) {
+    order[b] = static_cast<std::uint32_t>(b);
+  }
+  if (!order.empty()) {
+    nodes_.resize(1);
+    build(order, 0, 0, order.size());
+  }
+
+  // Store the boxes in leaf order, so that every leaf is a contiguous range
+  boxes_.resize(order.size());
+  std::vector<float> bounds(bounds_.size());
+  for (std::size_t b = 0; b < order.size(); ++b) {
+    boxes_[b] = transformed[order[b]];
+    std::copy_n(&bounds_[6 * order[b]], 6, &bounds[6 * b]);
+  }
+  bounds_.swap(bounds);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BoxSet::build(
+  std::vector<std::uint32_t> & order, std::size_t node_id, std::size_t begin, std::size_t end)
+{
+  float min_pt[3], max_pt[3];
+  for (int i = 0; i < 3; ++i) {
+    min_pt[i] = std::numeric_limits<float>::max();
+    max_pt[i] = std::numeric_limits<float>::lowest();
+    for (std::size_t b = begin; b < end; ++b) {
+      min_pt[i] = std::min(min_pt[i], bounds_[6 * order[b] + i]);
+      max_pt[i] = std::max(max_pt[i], bounds_[6 * order[b] + 3 + i]);
+    }
+    nodes_[node_id].min_pt[i] = min_pt[i];
+    nodes_[node_id].max_pt[i] = max_pt[i];
+  }
+
+  if (end - begin <= kLeafSize) {
+    nodes_[node_id].first = static_cast<std::uint32_t>(begin);
+    nodes_[node_id].count = static_cast<std::uint32_t>(end - begin);
+    return;
+  }
+
+  // Split at the median center along the longest axis
+  int axis = 0;
+  for (int i = 1; i < 3; ++i) {
+    if (max_pt[i] - min_pt[i] > max_pt[axis] - min_pt[axis]) {
+      axis = i;
+    }
+  }
+  const std::size_t middle = begin + (end - begin) / 2;
+  std::nth_element(
+    order.begin() + begin, order.begin() + middle, order.begin() + end,
+    [this, axis](std::uint32_t a, std::uint32_t b) {
+      return bounds_[6 * a + axis] + bounds_[6 * a + 3 + axis] <
+      bounds_[6 * b + axis] + bounds_[6 * b + 3 + axis];
+    });
+
+  const std::size_t first = nodes_.size();
+  nodes_[node_id].first = static_cast<std::uint32_t>(first);
+  nodes_[node_id].count = 0;
+  nodes_.resize(first + 2);
+  build(order, first, begin, middle);
+  build(order, first + 1, middle, end);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BoxSet::query(
+  const float * min_pt, const float * max_pt, std::vector<std::uint32_t> & found) const
+{
+  found.clear();
+  if (nodes_.empty()) {
+    return;
+  }
+  std::uint32_t stack[2 * kMaxDepth];
+  std::size_t top = 0;
+  stack[top++] = 0;
+  while (top) {
+    const Node & node = nodes_[stack[--top]];
+    if (max_pt[0] < node.min_pt[0] || min_pt[0] > node.max_pt[0] ||
+      max_pt[1] < node.min_pt[1] || min_pt[1] > node.max_pt[1] ||
+      max_pt[2] < node.min_pt[2] || min_pt[2] > node.max_pt[2])
+    {
+      continue;
+    }
+    if (node.count) {
+      for (std::uint32_t b = node.first; b < node.first + node.count; ++b) {
+        found.push_back(b);
+      }
+    } else {
+      stack[top++] = node.first;
+      stack[top++] = node.first + 1;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BoxSet::testBlock(
+  const float * x, const float * y, const float * z, std::size_t n, bool negative,
+  std::uint8_t * inside) const
+{
+  // Bounding box of the finite points of the block
+  float min_pt[3] = {
+    std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+    std::numeric_limits<float>::max()};
+  float max_pt[3] = {
+    std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+    std::numeric_limits<float>::lowest()};
+  for (std::size_t i = 0; i < n; ++i) {
+    if (std::isfinite(x[i]) && std::isfinite(y[i]) && std::isfinite(z[i])) {
+      min_pt[0] = std::min(min_pt[0], x[i]);
+      min_pt[1] = std::min(min_pt[1], y[i]);
+      min_pt[2] = std::min(min_pt[2], z[i]);
+      max_pt[0] = std::max(max_pt[0], x[i]);
+      max_pt[1] = std::max(max_pt[1], y[i]);
+      max_pt[2] = std::max(max_pt[2], z[i]);
+    }
+  }
+
+  thread_local std::vector<std::uint32_t> candidates;
+  query(min_pt, max_pt, candidates);
+
+  std::uint8_t in_union[kBlockSize], in_subtract[kBlockSize];
+  std::fill_n(in_union, n, has_union_ ? 0 : 1);
+  std::fill_n(in_subtract, n, 0);
+  for (const std::uint32_t b : candidates) {
+    const Box & box = boxes_[b];
+    std::uint8_t * acc = box.subtract ? in_subtract : in_union;
+    if (box.aligned) {
+      for (std::size_t i = 0; i < n; ++i) {
+        acc[i] |= (x[i] >= box.min_pt[0]) & (x[i] <= box.max_pt[0]) &
+          (y[i] >= box.min_pt[1]) & (y[i] <= box.max_pt[1]) &
+          (z[i] >= box.min_pt[2]) & (z[i] <= box.max_pt[2]);
+      }
+    } else {
+      const float (& m)[3][3] = box.rotation;
+      for (std::size_t i = 0; i < n; ++i) {
+        const float lx = m[0][0] * x[i] + m[0][1] * y[i] + m[0][2] * z[i] + box.offset[0];
+        const float ly = m[1][0] * x[i] + m[1][1] * y[i] + m[1][2] * z[i] + box.offset[1];
+        const float lz = m[2][0] * x[i] + m[2][1] * y[i] + m[2][2] * z[i] + box.offset[2];
+        acc[i] |= (lx >= box.min_pt[0]) & (lx <= box.max_pt[0]) &
+          (ly >= box.min_pt[1]) & (ly <= box.max_pt[1]) &
+          (lz >= box.min_pt[2]) & (lz <= box.max_pt[2]);
+      }
+    }
+  }
+  const std::uint8_t flip = negative ? 1 : 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    inside[i] = (in_union[i] & (in_subtract[i] ^ 1)) ^ flip;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BoxSet::mask(
+  sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, bool negative) const
+{
+  const std::size_t nr_points = static_cast<std::size_t>(cloud.width) * cloud.height;
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::uint8_t * data = cloud.data.data();
+  const std::uint8_t * points[kBlockSize];
+  float x[kBlockSize], y[kBlockSize], z[kBlockSize];
+  std::uint8_t inside[kBlockSize];
+  for (std::size_t start = 0; start < nr_points; start += kBlockSize) {
+    const std::size_t n = std::min(kBlockSize, nr_points - start);
+    for (std::size_t i = 0; i < n; ++i) {
+      points[i] = data + (start + i) * cloud.point_step;
+    }
+    loadBlock(points, n, xyz, x, y, z);
+    testBlock(x, y, z, n, negative, inside);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!inside[i]) {
+        std::uint8_t * point = data + (start + i) * cloud.point_step;
+        std::memcpy(point + xyz.x, &nan, sizeof(float));
+        std::memcpy(point + xyz.y, &nan, sizeof(float));
+        std::memcpy(point + xyz.z, &nan, sizeof(float));
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BoxSet::select(
+  const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, bool negative,
+  const std::vector<int> * indices, std::vector<int> & selected) const
+{
+  const std::size_t nr_points = static_cast<std::size_t>(cloud.width) * cloud.height;
+  const std::size_t nr_candidates = indices ? indices->size() : nr_points;
+  const std::uint8_t * data = cloud.data.data();
+  const std::uint8_t * points[kBlockSize];
+  int ids[kBlockSize];
+  float x[kBlockSize], y[kBlockSize], z[kBlockSize];
+  std::uint8_t inside[kBlockSize];
+  selected.clear();
+  for (std::size_t start = 0; start < nr_candidates; ) {
+    std::size_t n = 0;
+    for (; start < nr_candidates && n < kBlockSize; ++start) {
+      const std::size_t cp = indices ? static_cast<std::size_t>((*indices)[start]) : start;
+      if (cp < nr_points) {
+        ids[n] = static_cast<int>(cp);
+        points[n++] = data + cp * cloud.point_step;
+      }
+    }
+    loadBlock(points, n, xyz, x, y, z);
+    testBlock(x, y, z, n, negative, inside);
+    for (std::size_t i = 0; i < n; ++i) {
+      // Like pcl::CropBox, non finite points are removed from unorganized output
+      if (inside[i] && std::isfinite(x[i]) && std::isfinite(y[i]) && std::isfinite(z[i])) {
+        selected.push_back(ids[i]);
+      }
+    }
+  }
+}
@@ -0,0 +1,118 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "pcl_ros/filters/buffer_pool.hpp"
+#include <iterator>
+#include <utility>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BufferPool::setMaxBytes(std::size_t max_bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_bytes_ = max_bytes;
+  while (statistics_.pooled_bytes > max_bytes_) {
+    auto largest = std::prev(buffers_.end());
+    statistics_.pooled_bytes -= largest->first;
+    --statistics_.pooled_buffers;
+    ++statistics_.evicted;
+    buffers_.erase(largest);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<std::uint8_t>
+pcl_ros::BufferPool::acquire(std::size_t size)
+{
+  std::vector<std::uint8_t> buffer;
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++statistics_.acquired;
+  if (buffers_.empty()) {
+    return buffer;
+  }
+  // Best fit, or the largest buffer so that most of it is reused if the data grows
+  auto it = buffers_.lower_bound(size);
+  if (it == buffers_.end()) {
+    it = std::prev(it);
+  }
+  statistics_.pooled_bytes -= it->first;
+  --statistics_.pooled_buffers;
+  buffer.swap(it->second);
+  buffers_.erase(it);
+  return buffer;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BufferPool::reportUse(std::size_t capacity, std::size_t size)
+{
+  if (size <= capacity) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++statistics_.misses;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::BufferPool::release(std::vector<std::uint8_t> && buffer)
+{
+  const std::size_t capacity = buffer.capacity();
+  if (capacity == 0) {
+    return;
+  }
+  std::vector<std::uint8_t> pooled;
+  pooled.swap(buffer);
+  pooled.clear();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++statistics_.released;
+  if (statistics_.pooled_bytes + capacity > max_bytes_) {
+    // Freed when pooled goes out of scope; prefer keeping the buffers already in the pool, they
+    // are the ones the node keeps reusing
+    ++statistics_.evicted;
+    return;
+  }
+  statistics_.pooled_bytes += capacity;
+  ++statistics_.pooled_buffers;
+  buffers_.emplace(capacity, std::move(pooled));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::BufferPool::Statistics
+pcl_ros::BufferPool::statistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
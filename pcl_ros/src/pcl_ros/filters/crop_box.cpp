@@ -37,6 +37,10 @@
  */
 
 #include "pcl_ros/filters/crop_box.hpp"
+#include <pcl/io/io.h>
+#include <string>
+#include <utility>
+#include <vector>
 
 pcl_ros::CropBox::CropBox(const rclcpp::NodeOptions & options)
 : Filter("CropBoxNode", options)
@@ -137,7 +141,36 @@ pcl_ros::CropBox::CropBox(const rclcpp::NodeOptions & options)
     "Set whether the inliers should be returned (true) or the outliers (false).";
   declare_parameter(negative_desc.name, rclcpp::ParameterValue(false), negative_desc);
 
+  rcl_interfaces::msg::ParameterDescriptor boxes_desc;
+  boxes_desc.name = "boxes";
+  boxes_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  boxes_desc.description =
+    "min_x, min_y, min_z, max_x, max_y and max_z of each of several boxes evaluated in one pass, "
+    "replacing the min and max parameters when not empty";
+  declare_parameter(boxes_desc.name, rclcpp::ParameterValue(std::vector<double>{}), boxes_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor box_poses_desc;
+  box_poses_desc.name = "box_poses";
+  box_poses_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  box_poses_desc.description =
+    "x, y, z, roll, pitch and yaw of the pose of each box in boxes, in the input frame. "
+    "May be left empty for axis aligned boxes.";
+  declare_parameter(
+    box_poses_desc.name, rclcpp::ParameterValue(std::vector<double>{}), box_poses_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor box_modes_desc;
+  box_modes_desc.name = "box_modes";
+  box_modes_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  box_modes_desc.description =
+    "union to keep the points inside of the box, or subtract to remove them, for each box in "
+    "boxes. May be left empty for union only.";
+  declare_parameter(
+    box_modes_desc.name, rclcpp::ParameterValue(std::vector<std::string>{}), box_modes_desc);
+
   const std::vector<std::string> param_names {
+    boxes_desc.name,
+    box_poses_desc.name,
+    box_modes_desc.name,
     min_x_desc.name,
     max_x_desc.name,
     min_y_desc.name,
@@ -156,37 +189,224 @@ pcl_ros::CropBox::CropBox(const rclcpp::NodeOptions & options)
 
   config_callback(get_parameters(param_names));
 
-  // TODO(daisukes): lazy subscription after rclcpp#2060
-  subscribe();
+  lazySubscribe();
 }
 
 void
 pcl_ros::CropBox::filter(
-  const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
   PointCloud2 & output)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // The latest configuration and a private workspace, parameter updates do not wait for the filter
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  if (!config->box_set.empty()) {
+    filterBoxes(*config, *workspace, *input, indices, output);
+    return;
+  }
+  if (config->impl.getKeepOrganized() && !indices && filterOrganized(*config, *input, output)) {
+    return;
+  }
+  Impl & impl = workspace->impl.get(std::shared_ptr<const Impl>(config, &config->impl));
   pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
   pcl_conversions::toPCL(*(input), *(pcl_input));
-  impl_.setInputCloud(pcl_input);
-  impl_.setIndices(indices);
+  impl.setInputCloud(pcl_input);
+  impl.setIndices(copyIndices(indices));
   pcl::PCLPointCloud2 pcl_output;
-  impl_.filter(pcl_output);
+  // PCL resizes the buffer acquired for the output, moveFromPCL swaps it back
+  pcl_output.data = std::move(output.data);
+  impl.filter(pcl_output);
   pcl_conversions::moveFromPCL(pcl_output, output);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::CropBox::filterOrganized(
+  const Config & config, const PointCloud2 & input,
+  PointCloud2 & output)
+{
+  // keep_organized never changes the size of the cloud, so the output is a copy of the input
+  // with the x, y and z values of the removed points set to NaN
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(input) || !getXYZOffsets(input, xyz)) {
+    return false;
+  }
+
+  output = input;
+  maskFailing(
+    output, xyz, std::vector<FieldRange>(), std::vector<BoxRegion>{getBoxRegion(config)});
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::CropBox::filterBoxes(
+  const Config & config, Workspace & workspace, const PointCloud2 & input,
+  const IndicesConstPtr & indices, PointCloud2 & output)
+{
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(input) || !getXYZOffsets(input, xyz)) {
+    RCLCPP_ERROR(
+      get_logger(), "boxes need FLOAT32 x, y and z fields in host byte order, got (%s) in %s.",
+      pcl::getFieldsList(input).c_str(), input.is_bigendian ? "big endian" : "little endian");
+    output.header = input.header;
+    return;
+  }
+
+  if (config.impl.getKeepOrganized()) {
+    if (indices) {
+      RCLCPP_WARN_ONCE(get_logger(), "Indices are ignored when keep_organized is set.");
+    }
+    output = input;
+    config.box_set.mask(output, xyz, config.impl.getNegative());
+  } else {
+    config.box_set.select(
+      input, xyz, config.impl.getNegative(), indices.get(), workspace.selected);
+    gatherPoints(input, workspace.selected, 1, output);
+    // The selection has no non finite points
+    output.is_dense = true;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::CropBox::filterIndices(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  std::vector<int> & output_indices)
+{
+  ConfigConstPtr config = snapshot_.load();
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(*input) || !getXYZOffsets(*input, xyz)) {
+    return false;
+  }
+
+  if (!config->box_set.empty()) {
+    config->box_set.select(
+      *input, xyz, config->impl.getNegative(), indices.get(), output_indices);
+    return true;
+  }
+
+  // Non finite points are dropped, like pcl::CropBox does for unorganized output
+  selectPassing(
+    *input, xyz, std::vector<FieldRange>(), std::vector<BoxRegion>{getBoxRegion(*config)},
+    indices.get(), output_indices);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::CropBox::filterMasked(
+  const PointCloud2::ConstSharedPtr & input, const PointMask & mask, PointCloud2 & output)
+{
+  ConfigConstPtr config = snapshot_.load();
+  XYZOffsets xyz;
+  if (!config->box_set.empty() || config->impl.getKeepOrganized() ||
+    !isDirectlyAccessible(*input) || !getXYZOffsets(*input, xyz))
+  {
+    Filter::filterMasked(input, mask, output);
+    return;
+  }
+  extractPassing(
+    *input, xyz, std::vector<FieldRange>(), std::vector<BoxRegion>{getBoxRegion(*config)}, mask,
+    output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::CropBox::filterMask(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  const PointMask * mask, PointMask & output_mask)
+{
+  ConfigConstPtr config = snapshot_.load();
+  XYZOffsets xyz;
+  if (!config->box_set.empty() || !isDirectlyAccessible(*input) || !getXYZOffsets(*input, xyz)) {
+    return Filter::filterMask(input, indices, mask, output_mask);
+  }
+  selectPassing(
+    *input, xyz, std::vector<FieldRange>(), std::vector<BoxRegion>{getBoxRegion(*config)},
+    indices.get(), mask, output_mask);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::BoxRegion
+pcl_ros::CropBox::getBoxRegion(const Config & config)
+{
+  const Eigen::Vector4f min_pt = config.impl.getMin();
+  const Eigen::Vector4f max_pt = config.impl.getMax();
+  return BoxRegion {
+    {min_pt[0], min_pt[1], min_pt[2]}, {max_pt[0], max_pt[1], max_pt[2]},
+    config.impl.getNegative()};
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::CropBox::updateBoxes()
+{
+  const std::size_t nr_boxes = boxes_param_.size() / 6;
+  if (boxes_param_.size() % 6 != 0 ||
+    (!box_poses_param_.empty() && box_poses_param_.size() != 6 * nr_boxes) ||
+    (!box_modes_param_.empty() && box_modes_param_.size() != nr_boxes))
+  {
+    RCLCPP_WARN(
+      get_logger(),
+      "boxes, box_poses and box_modes need 6, 6 and 1 values per box, "
+      "keeping the previous boxes until they match.");
+    return;
+  }
+
+  std::vector<OrientedBox> boxes(nr_boxes);
+  for (std::size_t b = 0; b < nr_boxes; ++b) {
+    OrientedBox & box = boxes[b];
+    for (std::size_t i = 0; i < 3; ++i) {
+      box.min_pt[i] = static_cast<float>(boxes_param_[6 * b + i]);
+      box.max_pt[i] = static_cast<float>(boxes_param_[6 * b + 3 + i]);
+    }
+    for (std::size_t i = 0; i < 6; ++i) {
+      box.pose[i] = box_poses_param_.empty() ? 0.0f :
+        static_cast<float>(box_poses_param_[6 * b + i]);
+    }
+    const std::string mode = box_modes_param_.empty() ? "union" : box_modes_param_[b];
+    if (mode != "union" && mode != "subtract") {
+      RCLCPP_WARN(
+        get_logger(), "Unknown box mode %s, expected union or subtract, "
+        "keeping the previous boxes.", mode.c_str());
+      return;
+    }
+    box.subtract = mode == "subtract";
+    RCLCPP_DEBUG(
+      get_logger(), "Setting box %zu to [%f %f %f; %f %f %f] at [%f %f %f %f %f %f] (%s).", b,
+      box.min_pt[0], box.min_pt[1], box.min_pt[2], box.max_pt[0], box.max_pt[1], box.max_pt[2],
+      box.pose[0], box.pose[1], box.pose[2], box.pose[3], box.pose[4], box.pose[5],
+      mode.c_str());
+  }
+  config_.box_set.assign(boxes);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
 rcl_interfaces::msg::SetParametersResult
 pcl_ros::CropBox::config_callback(const std::vector<rclcpp::Parameter> & params)
 {
   std::lock_guard<std::mutex> lock(mutex_);
 
   Eigen::Vector4f min_point, max_point;
-  min_point = impl_.getMin();
-  max_point = impl_.getMax();
+  min_point = config_.impl.getMin();
+  max_point = config_.impl.getMax();
 
+  bool update_boxes = false;
   for (const rclcpp::Parameter & param : params) {
+    if (param.get_name() == "boxes") {
+      boxes_param_ = param.as_double_array();
+      update_boxes = true;
+    }
+    if (param.get_name() == "box_poses") {
+      box_poses_param_ = param.as_double_array();
+      update_boxes = true;
+    }
+    if (param.get_name() == "box_modes") {
+      box_modes_param_ = param.as_string_array();
+      update_boxes = true;
+    }
     if (param.get_name() == "min_x") {
       min_point(0) = param.as_double();
     }
@@ -207,42 +427,48 @@ pcl_ros::CropBox::config_callback(const std::vector<rclcpp::Parameter> & params)
     }
     if (param.get_name() == "negative") {
       // Check the current value for the negative flag
-      if (impl_.getNegative() != param.as_bool()) {
+      if (config_.impl.getNegative() != param.as_bool()) {
         RCLCPP_DEBUG(
           get_logger(), "Setting the filter negative flag to: %s.",
           param.as_bool() ? "true" : "false");
         // Call the virtual method in the child
-        impl_.setNegative(param.as_bool());
+        config_.impl.setNegative(param.as_bool());
       }
     }
     if (param.get_name() == "keep_organized") {
       // Check the current value for keep_organized
-      if (impl_.getKeepOrganized() != param.as_bool()) {
+      if (config_.impl.getKeepOrganized() != param.as_bool()) {
         RCLCPP_DEBUG(
           get_logger(), "Setting the filter keep_organized value to: %s.",
           param.as_bool() ? "true" : "false");
         // Call the virtual method in the child
-        impl_.setKeepOrganized(param.as_bool());
+        config_.impl.setKeepOrganized(param.as_bool());
       }
     }
   }
 
   // Check the current values for minimum point
-  if (min_point != impl_.getMin()) {
+  if (min_point != config_.impl.getMin()) {
     RCLCPP_DEBUG(
       get_logger(), "Setting the minimum point to: %f %f %f.",
       min_point(0), min_point(1), min_point(2));
-    impl_.setMin(min_point);
+    config_.impl.setMin(min_point);
   }
 
   // Check the current values for the maximum point
-  if (max_point != impl_.getMax()) {
+  if (max_point != config_.impl.getMax()) {
     RCLCPP_DEBUG(
       get_logger(), "Setting the maximum point to: %f %f %f.",
       max_point(0), max_point(1), max_point(2));
-    impl_.setMax(max_point);
+    config_.impl.setMax(max_point);
+  }
+
+  if (update_boxes) {
+    updateBoxes();
   }
 
+  snapshot_.store(config_);
+
   // Range constraints are enforced by rclcpp::Parameter.
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
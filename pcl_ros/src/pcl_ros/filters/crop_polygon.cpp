@@ -0,0 +1,361 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/crop_polygon.hpp"
+#include <pcl/io/io.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+#include "pcl_ros/transforms.hpp"
+
+pcl_ros::CropPolygon::CropPolygon(const rclcpp::NodeOptions & options)
+: Filter("CropPolygonNode", options)
+{
+  // This both declares and initializes the input and output frames
+  use_frame_params();
+
+  rcl_interfaces::msg::ParameterDescriptor polygon_desc;
+  polygon_desc.name = "polygon";
+  polygon_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  polygon_desc.description =
+    "x0, y0, x1, y1, ... of the vertices of the polygon, at least 3, in the input frame";
+  declare_parameter(
+    polygon_desc.name, rclcpp::ParameterValue(std::vector<double>{}), polygon_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor min_z_desc;
+  min_z_desc.name = "min_z";
+  min_z_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  min_z_desc.description = "Minimum z value below which points will be removed";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = -1000.0;
+    float_range.to_value = 1000.0;
+    min_z_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(min_z_desc.name, rclcpp::ParameterValue(-1000.0), min_z_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor max_z_desc;
+  max_z_desc.name = "max_z";
+  max_z_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  max_z_desc.description = "Maximum z value above which points will be removed";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = -1000.0;
+    float_range.to_value = 1000.0;
+    max_z_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(max_z_desc.name, rclcpp::ParameterValue(1000.0), max_z_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor keep_organized_desc;
+  keep_organized_desc.name = "keep_organized";
+  keep_organized_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  keep_organized_desc.description =
+    "Set whether the filtered points should be kept and set to NaN, "
+    "or removed from the PointCloud, thus potentially breaking its organized structure.";
+  declare_parameter(keep_organized_desc.name, rclcpp::ParameterValue(false), keep_organized_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor negative_desc;
+  negative_desc.name = "negative";
+  negative_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  negative_desc.description =
+    "Set whether the points outside of the prism should be returned instead of the inside ones.";
+  declare_parameter(negative_desc.name, rclcpp::ParameterValue(false), negative_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor num_threads_desc;
+  num_threads_desc.name = "num_threads";
+  num_threads_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  num_threads_desc.description = "The number of threads testing the points, 0 to use all cores.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 256;
+    num_threads_desc.integer_range.push_back(int_range);
+  }
+  declare_parameter(num_threads_desc.name, rclcpp::ParameterValue(0), num_threads_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor use_polygon_topic_desc;
+  use_polygon_topic_desc.name = "use_polygon_topic";
+  use_polygon_topic_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  use_polygon_topic_desc.description =
+    "Take the polygon from the most recent message of the transient local polygon topic "
+    "instead of the polygon parameter. The prism is extruded along the z axis of the polygon "
+    "frame, the points are transformed into it with TF.";
+  use_polygon_topic_desc.read_only = true;
+  const bool use_polygon_topic =
+    declare_parameter(use_polygon_topic_desc.name, false, use_polygon_topic_desc);
+
+  const std::vector<std::string> param_names {
+    min_z_desc.name,
+    max_z_desc.name,
+    keep_organized_desc.name,
+    negative_desc.name,
+    num_threads_desc.name,
+  };
+
+  callback_handle_ =
+    add_on_set_parameters_callback(
+    std::bind(
+      &CropPolygon::config_callback, this,
+      std::placeholders::_1));
+
+  auto result = config_callback(get_parameters(param_names));
+  if (!result.successful) {
+    throw std::runtime_error(result.reason);
+  }
+
+  if (use_polygon_topic) {
+    sub_polygon_ = create_subscription<geometry_msgs::msg::PolygonStamped>(
+      "polygon", rclcpp::QoS(rclcpp::KeepLast(1)).reliable().transient_local(),
+      std::bind(&CropPolygon::polygon_callback, this, std::placeholders::_1));
+  } else {
+    result = config_callback(get_parameters({polygon_desc.name}));
+    if (!result.successful) {
+      throw std::runtime_error(result.reason);
+    }
+  }
+
+  lazySubscribe();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::CropPolygon::filter(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  PointCloud2 & output)
+{
+  // The latest configuration and a private workspace, parameter updates do not wait for the filter
+  std::shared_ptr<const Config> config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  if (config->keep_organized && indices) {
+    RCLCPP_WARN_ONCE(get_logger(), "Indices are ignored when keep_organized is set.");
+  }
+  const IndicesConstPtr candidates = config->keep_organized ? IndicesConstPtr() : indices;
+  if (!markPassing(*config, *workspace, *input, candidates)) {
+    output.header = input->header;
+    return;
+  }
+
+  const unsigned int num_threads = resolveNumThreads(config->num_threads);
+  const std::vector<std::uint8_t> & keep = workspace->keep;
+  if (config->keep_organized) {
+    output = *input;
+    XYZOffsets xyz;
+    getXYZOffsets(output, xyz);
+    maskPoints(output, xyz, keep);
+  } else {
+    std::vector<int> & selected = workspace->selected;
+    selected.clear();
+    for (std::size_t k = 0; k < keep.size(); ++k) {
+      if (keep[k]) {
+        selected.push_back(indices ? (*indices)[k] : static_cast<int>(k));
+      }
+    }
+    gatherPoints(*input, selected, num_threads, output);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::CropPolygon::filterIndices(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  std::vector<int> & output_indices)
+{
+  std::shared_ptr<const Config> config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  if (!markPassing(*config, *workspace, *input, indices)) {
+    return false;
+  }
+  const std::vector<std::uint8_t> & keep = workspace->keep;
+  output_indices.clear();
+  for (std::size_t k = 0; k < keep.size(); ++k) {
+    if (keep[k]) {
+      output_indices.push_back(indices ? (*indices)[k] : static_cast<int>(k));
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::CropPolygon::markPassing(
+  const Config & config, Workspace & workspace, const PointCloud2 & input,
+  const IndicesConstPtr & indices)
+{
+  if (config.polygon.empty()) {
+    RCLCPP_WARN_THROTTLE(
+      get_logger(), *get_clock(), 5000, "No polygon set, dropping the PointCloud.");
+    return false;
+  }
+  // A latched polygon may be given in another frame, test the points in the polygon frame
+  Eigen::Matrix4f transform;
+  const bool transformed =
+    !config.polygon_frame.empty() && config.polygon_frame != input.header.frame_id;
+  if (transformed) {
+    try {
+      transformAsMatrix(
+        tf_buffer_.lookupTransform(
+          config.polygon_frame, input.header.frame_id, tf2_ros::fromMsg(input.header.stamp)),
+        transform);
+    } catch (const tf2::TransformException & e) {
+      RCLCPP_ERROR_THROTTLE(
+        get_logger(), *get_clock(), 5000,
+        "Unable to transform the PointCloud from %s to the polygon frame %s, dropping it: %s",
+        input.header.frame_id.c_str(), config.polygon_frame.c_str(), e.what());
+      return false;
+    }
+  }
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(input) || !getXYZOffsets(input, xyz)) {
+    RCLCPP_ERROR(
+      get_logger(), "CropPolygon needs FLOAT32 x, y and z fields in host byte order, "
+      "got (%s) in %s.", pcl::getFieldsList(input).c_str(),
+      input.is_bigendian ? "big endian" : "little endian");
+    return false;
+  }
+  markInPrism(
+    input, xyz, config.polygon, config.min_z, config.max_z, config.negative,
+    transformed ? &transform : nullptr, indices.get(), resolveNumThreads(config.num_threads),
+    workspace.keep);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::CropPolygon::polygon_callback(
+  const geometry_msgs::msg::PolygonStamped::ConstSharedPtr & polygon)
+{
+  std::vector<double> vertices;
+  vertices.reserve(2 * polygon->polygon.points.size());
+  for (const geometry_msgs::msg::Point32 & point : polygon->polygon.points) {
+    vertices.push_back(point.x);
+    vertices.push_back(point.y);
+  }
+
+  PolygonGrid grid;
+  if (!grid.assign(vertices)) {
+    RCLCPP_WARN(
+      get_logger(), "Ignoring a polygon with %zu vertices, at least 3 finite ones are needed.",
+      polygon->polygon.points.size());
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_.polygon = std::move(grid);
+  config_.polygon_frame = polygon->header.frame_id;
+  RCLCPP_DEBUG(
+    get_logger(), "Setting a polygon with %zu vertices in %s.", vertices.size() / 2,
+    config_.polygon_frame.c_str());
+  snapshot_.store(config_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+rcl_interfaces::msg::SetParametersResult
+pcl_ros::CropPolygon::config_callback(const std::vector<rclcpp::Parameter> & params)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+
+  // Check the z limits the batch would leave before applying anything
+  double min_z = config_.min_z, max_z = config_.max_z;
+  for (const rclcpp::Parameter & param : params) {
+    if (param.get_name() == "min_z") {
+      min_z = param.as_double();
+    }
+    if (param.get_name() == "max_z") {
+      max_z = param.as_double();
+    }
+  }
+  if (min_z > max_z) {
+    result.successful = false;
+    result.reason = "min_z must not be greater than max_z";
+    return result;
+  }
+
+  for (const rclcpp::Parameter & param : params) {
+    if (param.get_name() == "polygon") {
+      if (sub_polygon_) {
+        RCLCPP_WARN(get_logger(), "The polygon parameter is ignored with use_polygon_topic set.");
+        continue;
+      }
+      // An empty array unsets the polygon
+      const std::vector<double> vertices = param.as_double_array();
+      PolygonGrid grid;
+      if (!vertices.empty() && (vertices.size() % 2 != 0 || !grid.assign(vertices))) {
+        result.successful = false;
+        result.reason = "polygon needs a finite x and y value for each of at least 3 vertices";
+        return result;
+      }
+      config_.polygon = std::move(grid);
+      RCLCPP_DEBUG(get_logger(), "Setting a polygon with %zu vertices.", vertices.size() / 2);
+    }
+    if (param.get_name() == "min_z") {
+      config_.min_z = param.as_double();
+    }
+    if (param.get_name() == "max_z") {
+      config_.max_z = param.as_double();
+    }
+    if (param.get_name() == "negative") {
+      if (config_.negative != param.as_bool()) {
+        RCLCPP_DEBUG(
+          get_logger(), "Setting the filter negative flag to: %s.",
+          param.as_bool() ? "true" : "false");
+        config_.negative = param.as_bool();
+      }
+    }
+    if (param.get_name() == "keep_organized") {
+      if (config_.keep_organized != param.as_bool()) {
+        RCLCPP_DEBUG(
+          get_logger(), "Setting the filter keep_organized value to: %s.",
+          param.as_bool() ? "true" : "false");
+        config_.keep_organized = param.as_bool();
+      }
+    }
+    if (param.get_name() == "num_threads") {
+      if (config_.num_threads != param.as_int()) {
+        RCLCPP_DEBUG(get_logger(), "Setting the number of threads to: %ld.", param.as_int());
+        config_.num_threads = static_cast<int>(param.as_int());
+      }
+    }
+  }
+  snapshot_.store(config_);
+  return result;
+}
+
+#include "rclcpp_components/register_node_macro.hpp"
+RCLCPP_COMPONENTS_REGISTER_NODE(pcl_ros::CropPolygon)
@@ -36,6 +36,9 @@
  */
 
 #include "pcl_ros/filters/extract_indices.hpp"
+#include <utility>
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
 
 pcl_ros::ExtractIndices::ExtractIndices(const rclcpp::NodeOptions & options)
 : Filter("ExtractIndicesNode", options)
@@ -46,35 +49,156 @@ pcl_ros::ExtractIndices::ExtractIndices(const rclcpp::NodeOptions & options)
   neg_desc.description = "Extract indices or the negative (all-indices)";
   declare_parameter(neg_desc.name, rclcpp::ParameterValue(false), neg_desc);
 
+  rcl_interfaces::msg::ParameterDescriptor num_threads_desc;
+  num_threads_desc.name = "num_threads";
+  num_threads_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  num_threads_desc.description =
+    "The number of threads copying the points of large sets of indices, 0 to use all cores.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 256;
+    num_threads_desc.integer_range.push_back(int_range);
+  }
+  declare_parameter(num_threads_desc.name, rclcpp::ParameterValue(0), num_threads_desc);
+
   // Validate initial values using same callback
   callback_handle_ =
     add_on_set_parameters_callback(
     std::bind(&ExtractIndices::config_callback, this, std::placeholders::_1));
 
-  std::vector<std::string> param_names{neg_desc.name};
+  std::vector<std::string> param_names{neg_desc.name, num_threads_desc.name};
   auto result = config_callback(get_parameters(param_names));
   if (!result.successful) {
     throw std::runtime_error(result.reason);
   }
-  // TODO(daisukes): lazy subscription after rclcpp#2060
-  subscribe();
+  lazySubscribe();
 }
 
 void
 pcl_ros::ExtractIndices::filter(
-  const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
   PointCloud2 & output)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // The latest configuration and a private workspace, parameter updates do not wait for the filter
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  // Without indices, or with empty negative ones, every point is selected: like
+  // pcl::ExtractIndices, the cloud is kept as is, organized
+  const bool negative = config->impl.getNegative();
+  if (indices ? indices->empty() && negative : !negative) {
+    output = *input;
+    return;
+  }
+  if (isDirectlyAccessible(*input)) {
+    if (indices && !config->impl.getNegative()) {
+      // Keep the order and duplicates of the given indices, like pcl::ExtractIndices
+      gatherPoints(*input, *indices, resolveNumThreads(config->num_threads), output);
+    } else {
+      selectMask(
+        *config, static_cast<std::size_t>(input->width) * input->height, indices,
+        workspace->mask);
+      extractMasked(*input, workspace->mask, output);
+    }
+    return;
+  }
+  Impl & impl = workspace->impl.get(std::shared_ptr<const Impl>(config, &config->impl));
   pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
   pcl_conversions::toPCL(*(input), *(pcl_input));
-  impl_.setInputCloud(pcl_input);
-  impl_.setIndices(indices);
+  impl.setInputCloud(pcl_input);
+  impl.setIndices(copyIndices(indices));
   pcl::PCLPointCloud2 pcl_output;
-  impl_.filter(pcl_output);
+  // PCL resizes the buffer acquired for the output, moveFromPCL swaps it back
+  pcl_output.data = std::move(output.data);
+  impl.filter(pcl_output);
   pcl_conversions::moveFromPCL(pcl_output, output);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::ExtractIndices::filterIndices(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  std::vector<int> & output_indices)
+{
+  ConfigConstPtr config = snapshot_.load();
+  const std::size_t nr_points = static_cast<std::size_t>(input->width) * input->height;
+  if (indices && !config->impl.getNegative()) {
+    // Keep the order and duplicates of the given indices, like pcl::ExtractIndices
+    output_indices.clear();
+    for (const int index : *indices) {
+      if (index >= 0 && static_cast<std::size_t>(index) < nr_points) {
+        output_indices.push_back(index);
+      }
+    }
+    return true;
+  }
+  auto workspace = workspaces_.acquire();
+  selectMask(*config, nr_points, indices, workspace->mask);
+  workspace->mask.toIndices(output_indices);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::ExtractIndices::filterMasked(
+  const PointCloud2::ConstSharedPtr & input, const PointMask & mask, PointCloud2 & output)
+{
+  if (!isDirectlyAccessible(*input)) {
+    Filter::filterMasked(input, mask, output);
+    return;
+  }
+  ConfigConstPtr config = snapshot_.load();
+  if (!config->impl.getNegative()) {
+    extractMasked(*input, mask, output);
+    return;
+  }
+  // Like empty negative indices, an empty negative mask keeps the cloud as is, organized
+  if (mask.count() == 0) {
+    output = *input;
+    return;
+  }
+  auto workspace = workspaces_.acquire();
+  workspace->mask = mask;
+  workspace->mask.flip();
+  extractMasked(*input, workspace->mask, output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::ExtractIndices::filterMask(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  const PointMask * mask, PointMask & output_mask)
+{
+  ConfigConstPtr config = snapshot_.load();
+  if (mask) {
+    output_mask = *mask;
+    if (config->impl.getNegative()) {
+      output_mask.flip();
+    }
+    return true;
+  }
+  selectMask(
+    *config, static_cast<std::size_t>(input->width) * input->height, indices, output_mask);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::ExtractIndices::selectMask(
+  const Config & config, std::size_t nr_points, const IndicesConstPtr & indices,
+  PointMask & mask)
+{
+  // Without indices, every point is selected
+  if (indices) {
+    mask.assign(*indices, nr_points);
+  } else {
+    mask.assign(nr_points, true);
+  }
+  if (config.impl.getNegative()) {
+    mask.flip();
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 rcl_interfaces::msg::SetParametersResult
 pcl_ros::ExtractIndices::config_callback(const std::vector<rclcpp::Parameter> & params)
@@ -84,15 +208,22 @@ pcl_ros::ExtractIndices::config_callback(const std::vector<rclcpp::Parameter> &
   for (const rclcpp::Parameter & param : params) {
     if (param.get_name() == "negative") {
       // Check the current value for the negative flag
-      if (impl_.getNegative() != param.as_bool()) {
+      if (config_.impl.getNegative() != param.as_bool()) {
         RCLCPP_DEBUG(
           get_logger(), "Setting the filter negative flag to: %s.",
           param.as_bool() ? "true" : "false");
         // Call the virtual method in the child
-        impl_.setNegative(param.as_bool());
+        config_.impl.setNegative(param.as_bool());
+      }
+    }
+    if (param.get_name() == "num_threads") {
+      if (config_.num_threads != param.as_int()) {
+        RCLCPP_DEBUG(get_logger(), "Setting the number of threads to: %ld.", param.as_int());
+        config_.num_threads = static_cast<int>(param.as_int());
       }
     }
   }
+  snapshot_.store(config_);
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
   return result;
@@ -37,7 +37,15 @@
 
 #include "pcl_ros/filters/filter.hpp"
 #include <pcl/common/io.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 #include "pcl_ros/transforms.hpp"
+#include "pcl_ros/transport/bounded_point_cloud.hpp"
 
 /*//#include <pcl/filters/pixel_grid.h>
 //#include <pcl/filters/filter_dimension.h>
@@ -61,69 +69,328 @@
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void
-pcl_ros::Filter::computePublish(
-  const PointCloud2::ConstSharedPtr & input,
-  const IndicesPtr & indices)
+pcl_ros::Filter::filterMasked(
+  const PointCloud2::ConstSharedPtr & input, const PointMask & mask, PointCloud2 & output)
 {
-  PointCloud2 output;
-  // Call the virtual method in the child
+  auto indices = std::make_shared<pcl::Indices>();
+  mask.toIndices(*indices);
   filter(input, indices, output);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::Filter::filterMask(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  const PointMask * mask, PointMask & output_mask)
+{
+  IndicesConstPtr selection = indices;
+  if (mask) {
+    auto mask_indices = std::make_shared<pcl::Indices>();
+    mask->toIndices(*mask_indices);
+    selection = mask_indices;
+  }
+  std::vector<int> output_indices;
+  if (!filterIndices(input, selection, output_indices)) {
+    return false;
+  }
+  output_mask.assign(output_indices, static_cast<std::size_t>(input->width) * input->height);
+  return true;
+}
 
-  PointCloud2::UniquePtr cloud_tf(new PointCloud2(output));     // set the output by default
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::Filter::computeOutput(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  const std::string & input_frame, PointCloud2 & output, const PointMask * mask)
+{
+  // Call the virtual method in the child, on the threads of this node
+  ThreadPool::Scope scope(thread_pool_);
+  if (mask) {
+    filterMasked(input, *mask, output);
+  } else {
+    filter(input, indices, output);
+  }
+
+  const std::shared_ptr<const TfFrames> frames = std::atomic_load(&tf_frames_);
+  const std::string & tf_output_frame = frames->output_frame;
   // Check whether the user has given a different output TF frame
-  if (!tf_output_frame_.empty() && output.header.frame_id != tf_output_frame_) {
+  if (!tf_output_frame.empty() && output.header.frame_id != tf_output_frame) {
     RCLCPP_DEBUG(
       this->get_logger(), "Transforming output dataset from %s to %s.",
-      output.header.frame_id.c_str(), tf_output_frame_.c_str());
+      output.header.frame_id.c_str(), tf_output_frame.c_str());
     // Convert the cloud into the different frame
     PointCloud2 cloud_transformed;
-    if (!pcl_ros::transformPointCloud(tf_output_frame_, output, cloud_transformed, tf_buffer_)) {
+    if (!pcl_ros::transformPointCloud(tf_output_frame, output, cloud_transformed, tf_buffer_)) {
       RCLCPP_ERROR(
         this->get_logger(), "Error converting output dataset from %s to %s.",
-        output.header.frame_id.c_str(), tf_output_frame_.c_str());
-      return;
+        output.header.frame_id.c_str(), tf_output_frame.c_str());
+      return false;
+    }
+    if (output_pool_.enabled()) {
+      output_pool_.release(std::move(output.data));
     }
-    cloud_tf.reset(new PointCloud2(cloud_transformed));
+    output = std::move(cloud_transformed);
   }
-  if (tf_output_frame_.empty() && output.header.frame_id != tf_input_orig_frame_) {
+  if (tf_output_frame.empty() && output.header.frame_id != input_frame) {
     // no tf_output_frame given, transform the dataset to its original frame
     RCLCPP_DEBUG(
       this->get_logger(), "Transforming output dataset from %s back to %s.",
-      output.header.frame_id.c_str(), tf_input_orig_frame_.c_str());
+      output.header.frame_id.c_str(), input_frame.c_str());
     // Convert the cloud into the different frame
     PointCloud2 cloud_transformed;
-    if (!pcl_ros::transformPointCloud(
-        tf_input_orig_frame_, output, cloud_transformed,
-        tf_buffer_))
-    {
+    if (!pcl_ros::transformPointCloud(input_frame, output, cloud_transformed, tf_buffer_)) {
       RCLCPP_ERROR(
         this->get_logger(), "Error converting output dataset from %s back to %s.",
-        output.header.frame_id.c_str(), tf_input_orig_frame_.c_str());
-      return;
+        output.header.frame_id.c_str(), input_frame.c_str());
+      return false;
     }
-    cloud_tf.reset(new PointCloud2(cloud_transformed));
+    if (output_pool_.enabled()) {
+      output_pool_.release(std::move(output.data));
+    }
+    output = std::move(cloud_transformed);
   }
 
   // Copy timestamp to keep it
-  cloud_tf->header.stamp = input->header.stamp;
+  output.header.stamp = input->header.stamp;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::computePublish(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  const std::string & input_frame, const PointMask * mask)
+{
+  // Received masks are not used in realtime mode, see mask_indices
+  if (!realtime_ || mask) {
+    Output result = computeFrame(input, indices, input_frame, mask);
+    publishOutput(result);
+    return;
+  }
+
+  if (output_indices_) {
+    // Reuse the message and the capacity of its indices from one frame to the next
+    if (filterIndices(input, indices, indices_output_.indices)) {
+      if (output_mask_) {
+        point_mask_output_.assign(indices_output_.indices, input->width * input->height);
+        point_mask_output_.toImage(input->width, mask_output_);
+        mask_output_.header.stamp = input->header.stamp;
+        mask_output_.header.frame_id = input_frame;
+        pub_mask_->publish(mask_output_);
+        return;
+      }
+      indices_output_.header.stamp = input->header.stamp;
+      indices_output_.header.frame_id = input_frame;
+      pub_indices_->publish(indices_output_);
+      return;
+    }
+    RCLCPP_WARN_ONCE(
+      this->get_logger(), "This filter cannot output indices for this input, "
+      "publishing the filtered PointCloud instead.");
+  }
+
+  // Reuse the message and the capacity of its fields and data from one frame to the next. Only
+  // the layout is reset, the children do not expect leftovers of the previous output.
+  output_.height = 0;
+  output_.width = 0;
+  output_.fields.clear();
+  output_.point_step = 0;
+  output_.row_step = 0;
+  output_.data.clear();
+  if (computeOutput(input, indices, input_frame, output_) && !publishLoaned(output_)) {
+    pub_output_->publish(output_);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::Filter::Output
+pcl_ros::Filter::computeFrame(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  const std::string & input_frame, const PointMask * mask)
+{
+  Output result;
+  if (output_indices_) {
+    PointIndices::UniquePtr indices_out(new PointIndices);
+    PointMask point_mask;
+    // Masks in or out go through filterMask (), which children can compute without indices
+    const bool computed = output_mask_ || mask ?
+      filterMask(input, indices, mask, point_mask) :
+      filterIndices(input, indices, indices_out->indices);
+    if (computed) {
+      if (output_mask_) {
+        // The mask has the layout of the input, one bit per point
+        Image::UniquePtr image(new Image);
+        point_mask.toImage(input->width, *image);
+        image->header.stamp = input->header.stamp;
+        image->header.frame_id = input_frame;
+        result.mask = std::move(image);
+        return result;
+      }
+      if (mask) {
+        point_mask.toIndices(indices_out->indices);
+      }
+      // The indices refer to the input as received
+      indices_out->header.stamp = input->header.stamp;
+      indices_out->header.frame_id = input_frame;
+      result.indices = std::move(indices_out);
+      return result;
+    }
+    RCLCPP_WARN_ONCE(
+      this->get_logger(), "This filter cannot output indices for this input, "
+      "publishing the filtered PointCloud instead.");
+  }
+
+  PointCloud2::UniquePtr output(new PointCloud2);
+  const std::uint8_t * pooled_data = nullptr;
+  std::size_t pooled_capacity = 0;
+  if (output_pool_.enabled()) {
+    // Most outputs are at most as large as the input, let the child reuse a published buffer
+    output->data = output_pool_.acquire(input->data.size());
+    pooled_data = output->data.data();
+    pooled_capacity = output->data.capacity();
+  }
+  if (computeOutput(input, indices, input_frame, *output, mask)) {
+    if (output_pool_.enabled()) {
+      // A child that did not write into the pooled buffer, or the transform of the output into
+      // another frame, allocated a new one
+      output_pool_.reportUse(
+        output->data.data() == pooled_data ? pooled_capacity : 0, output->data.size());
+    }
+    result.cloud = std::move(output);
+  }
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::Filter::publishLoaned(const PointCloud2 & cloud)
+{
+  if (!loan_output_) {
+    return false;
+  }
+  if (!fitsBounded(cloud)) {
+    RCLCPP_WARN_ONCE(
+      this->get_logger(), "An output PointCloud of %zu bytes with %zu fields is larger than a "
+      "BoundedPointCloud2, the outputs that do not fit are published on output.",
+      cloud.data.size(), cloud.fields.size());
+    return false;
+  }
+  // The points are copied once into the shared memory of the loan, and never serialized
+  auto loaned = pub_bounded_->borrow_loaned_message();
+  toBounded(cloud, loaned.get());
+  pub_bounded_->publish(std::move(loaned));
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::publishOutput(Output & result)
+{
+  if (result.indices) {
+    pub_indices_->publish(std::move(result.indices));
+    return;
+  }
+  if (result.mask) {
+    pub_mask_->publish(std::move(result.mask));
+    return;
+  }
+  if (!result.cloud) {
+    return;
+  }
+  if (publishLoaned(*result.cloud)) {
+    // The points were copied into the loan, the buffer is free again
+    if (recycle_output_) {
+      output_pool_.release(std::move(result.cloud->data));
+      publishPoolStatistics();
+    }
+    return;
+  }
+  if (recycle_output_) {
+    // The message is serialized before publish () returns, its buffer is free again
+    pub_output_->publish(*result.cloud);
+    output_pool_.release(std::move(result.cloud->data));
+    publishPoolStatistics();
+    return;
+  }
 
   // Publish the unique ptr
-  pub_output_->publish(move(cloud_tf));
+  pub_output_->publish(std::move(result.cloud));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl_ros::Filter::subscribe()
 {
+  // Keep the most recent PointIndices (indices) and process every cloud as soon as it arrives
+  if (use_indices_ && transient_local_indices_) {
+    const rclcpp::QoS latched_qos = rclcpp::QoS(rclcpp::KeepLast(1)).reliable().transient_local();
+    if (mask_indices_) {
+      // Decode the mask once, it is used for every cloud
+      sub_mask_latched_ = this->create_subscription<Image>(
+        "indices", latched_qos,
+        [this](Image::ConstSharedPtr mask) {
+          std::shared_ptr<const PointMask> point_mask = decodeMask(*mask);
+          if (!point_mask) {
+            return;
+          }
+          std::lock_guard<std::mutex> lock(latched_indices_mutex_);
+          latched_mask_ = point_mask;
+        }, inputSubscriptionOptions());
+    } else {
+      sub_indices_latched_ = this->create_subscription<PointIndices>(
+        "indices", latched_qos,
+        [this](PointIndices::ConstSharedPtr indices) {
+          std::lock_guard<std::mutex> lock(latched_indices_mutex_);
+          latched_indices_ = indices;
+        }, inputSubscriptionOptions());
+    }
+    sub_input_ = this->create_subscription<PointCloud2>(
+      "input", rclcpp::SensorDataQoS(rclcpp::KeepLast(inputQueueSize())),
+      [this](PointCloud2::ConstSharedPtr cloud) {
+        takeLatest(*sub_input_, cloud);
+        input_latched_indices_callback(cloud);
+      }, inputSubscriptionOptions());
+    return;
+  }
+
   // If we're supposed to look for PointIndices (indices)
   if (use_indices_) {
+    if (keep_latest_) {
+      RCLCPP_WARN(
+        get_logger(), "keep_latest is not applied to point clouds synchronized with indices, "
+        "only max_input_age is.");
+    }
     // Subscribe to the input using a filter
     auto sensor_qos_profile = rclcpp::QoS(
       rclcpp::KeepLast(max_queue_size_),
       rmw_qos_profile_sensor_data).get_rmw_qos_profile();
-    sub_input_filter_.subscribe(this, "input", sensor_qos_profile);
-    sub_indices_filter_.subscribe(this, "indices", sensor_qos_profile);
+    sub_input_filter_.subscribe(this, "input", sensor_qos_profile, inputSubscriptionOptions());
 
+    if (mask_indices_) {
+      sub_mask_filter_.subscribe(this, "indices", sensor_qos_profile, inputSubscriptionOptions());
+      if (approximate_sync_) {
+        sync_input_mask_a_ =
+          std::make_shared<message_filters::Synchronizer<sync_policies::ApproximateTime<PointCloud2,
+            Image>>>(max_queue_size_);
+        sync_input_mask_a_->connectInput(sub_input_filter_, sub_mask_filter_);
+        sync_input_mask_a_->registerCallback(
+          std::bind(
+            &Filter::input_mask_callback, this,
+            std::placeholders::_1, std::placeholders::_2));
+      } else {
+        sync_input_mask_e_ =
+          std::make_shared<message_filters::Synchronizer<sync_policies::ExactTime<PointCloud2,
+            Image>>>(max_queue_size_);
+        sync_input_mask_e_->connectInput(sub_input_filter_, sub_mask_filter_);
+        sync_input_mask_e_->registerCallback(
+          std::bind(
+            &Filter::input_mask_callback, this,
+            std::placeholders::_1, std::placeholders::_2));
+      }
+      return;
+    }
+
+    sub_indices_filter_.subscribe(this, "indices", sensor_qos_profile, inputSubscriptionOptions());
     if (approximate_sync_) {
       sync_input_indices_a_ =
         std::make_shared<message_filters::Synchronizer<sync_policies::ApproximateTime<PointCloud2,
@@ -144,15 +411,14 @@ pcl_ros::Filter::subscribe()
           std::placeholders::_1, std::placeholders::_2));
     }
   } else {
-    // Workaround for a callback with custom arguments ros2/rclcpp#766
-    std::function<void(PointCloud2::ConstSharedPtr)> callback =
-      std::bind(&Filter::input_indices_callback, this, std::placeholders::_1, nullptr);
-
     // Subscribe in an old fashion to input only (no filters)
     sub_input_ =
       this->create_subscription<PointCloud2>(
-      "input", max_queue_size_,
-      callback);
+      "input", inputQueueSize(),
+      [this](PointCloud2::ConstSharedPtr cloud) {
+        takeLatest(*sub_input_, cloud);
+        input_indices_callback(cloud, nullptr);
+      }, inputSubscriptionOptions());
   }
 }
 
@@ -160,9 +426,17 @@ pcl_ros::Filter::subscribe()
 void
 pcl_ros::Filter::unsubscribe()
 {
-  if (use_indices_) {
+  if (use_indices_ && transient_local_indices_) {
+    sub_input_.reset();
+    sub_indices_latched_.reset();
+    sub_mask_latched_.reset();
+  } else if (use_indices_) {
     sub_input_filter_.unsubscribe();
-    sub_indices_filter_.unsubscribe();
+    if (mask_indices_) {
+      sub_mask_filter_.unsubscribe();
+    } else {
+      sub_indices_filter_.unsubscribe();
+    }
   } else {
     sub_input_.reset();
   }
@@ -170,12 +444,203 @@ pcl_ros::Filter::unsubscribe()
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 pcl_ros::Filter::Filter(std::string node_name, const rclcpp::NodeOptions & options)
-: PCLNode(node_name, options)
+: PCLNode(node_name, options), output_indices_(false), output_mask_(false),
+  mask_indices_(false), loan_output_(false), realtime_(false), recycle_output_(false),
+  tf_frames_(std::make_shared<TfFrames>()), work_queue_(std::make_shared<WorkQueue>()),
+  next_published_(0)
 {
-  pub_output_ = create_publisher<PointCloud2>("output", max_queue_size_);
+  rcl_interfaces::msg::ParameterDescriptor output_mode_desc;
+  output_mode_desc.name = "output_mode";
+  output_mode_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  output_mode_desc.description =
+    "cloud to publish the filtered PointCloud on output, indices to only publish the "
+    "PointIndices of the passing input points on output_indices, or mask to only publish them "
+    "as an Image with one bit per input point on output_mask, in the bitmask encoding of "
+    "pcl_ros::PointMask, where supported.";
+  output_mode_desc.read_only = true;
+  const std::string output_mode =
+    declare_parameter(output_mode_desc.name, std::string("cloud"), output_mode_desc);
+  if (output_mode != "cloud" && output_mode != "indices" && output_mode != "mask") {
+    throw std::runtime_error(
+            "Unknown output_mode " + output_mode + ", expected cloud, indices or mask");
+  }
+  output_indices_ = output_mode != "cloud";
+  output_mask_ = output_mode == "mask";
+
+  rcl_interfaces::msg::ParameterDescriptor mask_indices_desc;
+  mask_indices_desc.name = "mask_indices";
+  mask_indices_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  mask_indices_desc.description =
+    "Set to true to receive the indices topic as an Image with one bit (bitmask encoding) or "
+    "one mono8 pixel per input point, the points whose bit or pixel is set are processed, e.g. "
+    "the output_mask of another filter.";
+  mask_indices_desc.read_only = true;
+  mask_indices_ = declare_parameter(mask_indices_desc.name, false, mask_indices_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor keep_fields_desc;
+  keep_fields_desc.name = "keep_fields";
+  keep_fields_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  keep_fields_desc.description =
+    "The fields of the input PointCloud to keep, repacked without padding before filtering, so "
+    "that the filter and the nodes after it only carry these fields. Must include the fields the "
+    "filter uses. Empty to keep every field.";
+  keep_fields_desc.read_only = true;
+  keep_fields_ = declare_parameter(
+    keep_fields_desc.name, std::vector<std::string>(), keep_fields_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor max_pool_bytes_desc;
+  max_pool_bytes_desc.name = "max_pool_bytes";
+  max_pool_bytes_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  max_pool_bytes_desc.description =
+    "The maximum total size in bytes of the published PointCloud data buffers kept for reuse "
+    "by the next outputs, 0 to allocate a new buffer for every output. The pool counters are "
+    "published on diagnostics.";
+  max_pool_bytes_desc.read_only = true;
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = std::int64_t(1) << 40;
+    max_pool_bytes_desc.integer_range.push_back(int_range);
+  }
+  const std::int64_t max_pool_bytes =
+    declare_parameter(max_pool_bytes_desc.name, std::int64_t(0), max_pool_bytes_desc);
+  output_pool_.setMaxBytes(static_cast<std::size_t>(max_pool_bytes));
+
+  rcl_interfaces::msg::ParameterDescriptor realtime_desc;
+  realtime_desc.name = "realtime";
+  realtime_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  realtime_desc.description =
+    "Set to true to reuse the output message and its buffers from one frame to the next, so that "
+    "once warmed up the filters implemented directly on PointCloud2 do not allocate memory. "
+    "Needs intra-process communication to be disabled.";
+  realtime_desc.read_only = true;
+  realtime_ = declare_parameter(realtime_desc.name, false, realtime_desc);
+  if (realtime_ && get_node_options().use_intra_process_comms()) {
+    throw std::runtime_error("realtime cannot be used with intra-process communication");
+  }
+  if (realtime_ && !keep_fields_.empty()) {
+    throw std::runtime_error("realtime cannot be used with keep_fields, it allocates the input");
+  }
+  if (realtime_ && data_callback_group_->type() == rclcpp::CallbackGroupType::Reentrant) {
+    throw std::runtime_error("realtime cannot be used with a reentrant data_callback_group");
+  }
+  if (realtime_ && use_indices_ && mask_indices_) {
+    throw std::runtime_error("realtime cannot be used with mask_indices, it allocates the masks");
+  }
+
+  rcl_interfaces::msg::ParameterDescriptor reserve_bytes_desc;
+  reserve_bytes_desc.name = "reserve_output_bytes";
+  reserve_bytes_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  reserve_bytes_desc.description =
+    "The capacity in bytes of the output PointCloud data allocated at startup in realtime mode, "
+    "0 to let it grow with the first frames.";
+  reserve_bytes_desc.read_only = true;
+  rcl_interfaces::msg::ParameterDescriptor reserve_indices_desc;
+  reserve_indices_desc.name = "reserve_output_indices";
+  reserve_indices_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  reserve_indices_desc.description =
+    "The number of output indices allocated at startup in realtime mode, with output_mode set "
+    "to indices or mask, 0 to let them grow with the first frames.";
+  reserve_indices_desc.read_only = true;
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = std::int64_t(1) << 40;
+    reserve_bytes_desc.integer_range.push_back(int_range);
+    reserve_indices_desc.integer_range.push_back(int_range);
+  }
+  const std::int64_t reserve_bytes =
+    declare_parameter(reserve_bytes_desc.name, std::int64_t(0), reserve_bytes_desc);
+  const std::int64_t reserve_indices =
+    declare_parameter(reserve_indices_desc.name, std::int64_t(0), reserve_indices_desc);
+  if (realtime_) {
+    output_.data.reserve(static_cast<std::size_t>(reserve_bytes));
+    if (output_indices_) {
+      indices_output_.indices.reserve(static_cast<std::size_t>(reserve_indices));
+    }
+  }
+
+  rcl_interfaces::msg::ParameterDescriptor loan_output_desc;
+  loan_output_desc.name = "loan_output";
+  loan_output_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  loan_output_desc.description =
+    "Set to true to publish the output PointCloud on output_bounded in fixed-size "
+    "pcl_ros_interfaces/BoundedPointCloud2 messages loaned by the middleware, which a "
+    "shared-memory middleware hands to the other processes of the host without serializing them. "
+    "The outputs that do not fit, or all of them if the middleware cannot loan the messages, are "
+    "published on output as usual. Needs intra-process communication to be disabled.";
+  loan_output_desc.read_only = true;
+  const bool loan_output = declare_parameter(loan_output_desc.name, false, loan_output_desc);
+  if (loan_output && get_node_options().use_intra_process_comms()) {
+    throw std::runtime_error("loan_output cannot be used with intra-process communication");
+  }
+
+  rcl_interfaces::msg::ParameterDescriptor num_workers_desc;
+  num_workers_desc.name = "num_workers";
+  num_workers_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  num_workers_desc.description =
+    "The number of threads processing received point clouds, so that several frames are "
+    "transformed, filtered and published at once, 0 to process each frame in the subscription "
+    "callback. Outputs are published in the order the point clouds were received.";
+  num_workers_desc.read_only = true;
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 256;
+    num_workers_desc.integer_range.push_back(int_range);
+  }
+  const int num_workers = declare_parameter(num_workers_desc.name, 0, num_workers_desc);
+  if (num_workers > 0 && realtime_) {
+    throw std::runtime_error("realtime cannot be used with num_workers, it has a single output");
+  }
+
+  pub_output_ = createOutputPublisher<PointCloud2>("output");
+  if (loan_output && !output_indices_) {
+    pub_bounded_ =
+      createOutputPublisher<pcl_ros_interfaces::msg::BoundedPointCloud2>("output_bounded");
+    loan_output_ = pub_bounded_->can_loan_messages();
+    if (!loan_output_) {
+      RCLCPP_WARN(
+        this->get_logger(), "The middleware cannot loan BoundedPointCloud2 messages, "
+        "publishing the outputs on output.");
+    }
+  }
+  if (output_mask_) {
+    pub_mask_ = createOutputPublisher<Image>("output_mask");
+  } else if (output_indices_) {
+    pub_indices_ = createOutputPublisher<PointIndices>("output_indices");
+  }
+  if (output_pool_.enabled() && !realtime_) {
+    // Intra-process subscribers keep the published message, its buffer cannot come back
+    recycle_output_ = !get_node_options().use_intra_process_comms();
+    enableDiagnostics();
+  }
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&Filter::workerLoop, work_queue_);
+  }
   RCLCPP_DEBUG(this->get_logger(), "Node successfully created.");
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::Filter::~Filter()
+{
+  // No worker holds the node any more, they can only be waiting for frames
+  {
+    std::lock_guard<std::mutex> lock(work_queue_->mutex);
+    work_queue_->stop = true;
+    work_queue_->frames.clear();
+  }
+  work_queue_->condition.notify_all();
+  for (std::thread & worker : workers_) {
+    if (worker.get_id() == std::this_thread::get_id()) {
+      // The worker dropped the last reference, it exits on its own with its copy of the queue
+      worker.detach();
+    } else if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl_ros::Filter::use_frame_params()
@@ -275,6 +740,11 @@ pcl_ros::Filter::config_callback(const std::vector<rclcpp::Parameter> & params)
       }
     }
   }
+  // Swap the frames used by the processing path at once, frames in flight keep the previous ones
+  auto frames = std::make_shared<TfFrames>();
+  frames->input_frame = tf_input_frame_;
+  frames->output_frame = tf_output_frame_;
+  std::atomic_store(&tf_frames_, std::shared_ptr<const TfFrames>(std::move(frames)));
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
   return result;
@@ -286,6 +756,10 @@ pcl_ros::Filter::input_indices_callback(
   const PointCloud2::ConstSharedPtr & cloud,
   const PointIndices::ConstSharedPtr & indices)
 {
+  // Callbacks already queued when the last output subscriber went away
+  if (!hasOutputSubscribers()) {
+    return;
+  }
   // If cloud is given, check if it's valid
   if (!isValid(cloud)) {
     RCLCPP_ERROR(this->get_logger(), "Invalid input!");
@@ -296,50 +770,290 @@ pcl_ros::Filter::input_indices_callback(
     RCLCPP_ERROR(this->get_logger(), "Invalid indices!");
     return;
   }
+  if (!acceptInput(cloud->header)) {
+    return;
+  }
 
-  /// DEBUG
-  if (indices) {
-    RCLCPP_DEBUG(
-      this->get_logger(), "[input_indices_callback]\n"
-      "  - PointCloud with %d data points (%s), stamp %d.%09d, and frame %s on topic %s received.\n"
-      "  - PointIndices with %zu values, stamp %d.%09d, and frame %s on topic %s received.",
-      cloud->width * cloud->height, pcl::getFieldsList(*cloud).c_str(),
-      cloud->header.stamp.sec, cloud->header.stamp.nanosec, cloud->header.frame_id.c_str(), "input",
-      indices->indices.size(), indices->header.stamp.sec, indices->header.stamp.nanosec,
-      indices->header.frame_id.c_str(), "indices");
-  } else {
-    RCLCPP_DEBUG(
-      this->get_logger(), "PointCloud with %d data points and frame %s on topic %s received.",
-      cloud->width * cloud->height, cloud->header.frame_id.c_str(), "input");
+  /// DEBUG, skipped in realtime mode so that the path does not depend on the logging backend
+  if (!realtime_) {
+    if (indices) {
+      RCLCPP_DEBUG(
+        this->get_logger(), "[input_indices_callback]\n"
+        "  - PointCloud with %d data points (%s), stamp %d.%09d, and frame %s on topic %s "
+        "received.\n"
+        "  - PointIndices with %zu values, stamp %d.%09d, and frame %s on topic %s received.",
+        cloud->width * cloud->height, pcl::getFieldsList(*cloud).c_str(),
+        cloud->header.stamp.sec, cloud->header.stamp.nanosec, cloud->header.frame_id.c_str(),
+        "input", indices->indices.size(), indices->header.stamp.sec, indices->header.stamp.nanosec,
+        indices->header.frame_id.c_str(), "indices");
+    } else {
+      RCLCPP_DEBUG(
+        this->get_logger(), "PointCloud with %d data points and frame %s on topic %s received.",
+        cloud->width * cloud->height, cloud->header.frame_id.c_str(), "input");
+    }
   }
   ///
 
+  // Need setInputCloud () here because we have to extract x/y/z
+  // Share the indices of the message rather than copying them, filters only read them. Filters
+  // that need a compact set of points can convert them to a PointMask instead.
+  IndicesConstPtr vindices;
+  if (indices) {
+    vindices = IndicesConstPtr(indices, &indices->indices);
+  }
+  processInput(cloud, vindices, nullptr);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::processInput(
+  const PointCloud2::ConstSharedPtr & cloud, const IndicesConstPtr & indices,
+  const std::shared_ptr<const PointMask> & mask)
+{
+  if (!workers_.empty()) {
+    dispatch(cloud, indices, mask);
+    return;
+  }
+
+  PointCloud2::ConstSharedPtr cloud_tf = transformInput(cloud);
+  if (!cloud_tf) {
+    return;
+  }
+  // The original frame is passed along rather than stored, callbacks may run concurrently
+  computePublish(cloud_tf, indices, cloud->header.frame_id, mask.get());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::Filter::PointCloud2::ConstSharedPtr
+pcl_ros::Filter::projectInput(const PointCloud2::ConstSharedPtr & cloud)
+{
+  if (keep_fields_.empty()) {
+    return cloud;
+  }
+  auto projected = std::make_shared<PointCloud2>();
+  if (!pcl_conversions::projectFields(*cloud, keep_fields_, *projected)) {
+    RCLCPP_ERROR(
+      this->get_logger(), "Input PointCloud with fields (%s) does not have all of keep_fields.",
+      pcl::getFieldsList(*cloud).c_str());
+    return nullptr;
+  }
+  return projected;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::Filter::PointCloud2::ConstSharedPtr
+pcl_ros::Filter::transformInput(const PointCloud2::ConstSharedPtr & cloud)
+{
+  // Drop the unused fields first, so that the transform has less to copy
+  const PointCloud2::ConstSharedPtr input = projectInput(cloud);
+  if (!input) {
+    return nullptr;
+  }
+  const std::shared_ptr<const TfFrames> frames = std::atomic_load(&tf_frames_);
+  const std::string & tf_input_frame = frames->input_frame;
   // Check whether the user has given a different input TF frame
-  tf_input_orig_frame_ = cloud->header.frame_id;
-  PointCloud2::ConstSharedPtr cloud_tf;
-  if (!tf_input_frame_.empty() && cloud->header.frame_id != tf_input_frame_) {
-    RCLCPP_DEBUG(
-      this->get_logger(), "Transforming input dataset from %s to %s.",
-      cloud->header.frame_id.c_str(), tf_input_frame_.c_str());
-    // Save the original frame ID
-    // Convert the cloud into the different frame
-    PointCloud2 cloud_transformed;
-    if (!pcl_ros::transformPointCloud(tf_input_frame_, *cloud, cloud_transformed, tf_buffer_)) {
-      RCLCPP_ERROR(
-        this->get_logger(), "Error converting input dataset from %s to %s.",
-        cloud->header.frame_id.c_str(), tf_input_frame_.c_str());
+  if (tf_input_frame.empty() || input->header.frame_id == tf_input_frame) {
+    return input;
+  }
+  RCLCPP_DEBUG(
+    this->get_logger(), "Transforming input dataset from %s to %s.",
+    input->header.frame_id.c_str(), tf_input_frame.c_str());
+  // Convert the cloud into the different frame
+  PointCloud2 cloud_transformed;
+  if (!pcl_ros::transformPointCloud(tf_input_frame, *input, cloud_transformed, tf_buffer_)) {
+    RCLCPP_ERROR(
+      this->get_logger(), "Error converting input dataset from %s to %s.",
+      input->header.frame_id.c_str(), tf_input_frame.c_str());
+    return nullptr;
+  }
+  return std::make_shared<PointCloud2>(std::move(cloud_transformed));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::dispatch(
+  const PointCloud2::ConstSharedPtr & cloud, const IndicesConstPtr & indices,
+  const std::shared_ptr<const PointMask> & mask)
+{
+  std::shared_ptr<Filter> self;
+  try {
+    self = std::static_pointer_cast<Filter>(shared_from_this());
+  } catch (const std::bad_weak_ptr &) {
+    // The workers need a reference to keep the node alive, process the frame here instead
+    RCLCPP_WARN_ONCE(
+      this->get_logger(), "num_workers needs the node to be owned by a shared pointer, "
+      "processing the point clouds in the subscription callbacks.");
+    PointCloud2::ConstSharedPtr cloud_tf = transformInput(cloud);
+    if (cloud_tf) {
+      computePublish(cloud_tf, indices, cloud->header.frame_id, mask.get());
+    }
+    return;
+  }
+
+  WorkQueue & queue = *work_queue_;
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.stop) {
       return;
     }
-    cloud_tf = std::make_shared<PointCloud2>(cloud_transformed);
-  } else {
-    cloud_tf = cloud;
+    if (queue.frames.size() >= static_cast<std::size_t>(std::max(max_queue_size_, 1))) {
+      // All the workers are busy and the backlog is full, drop the oldest frame
+      queue.frames.pop_front();
+      ++nr_dropped_queued_;
+    }
+    queue.frames.push_back(Frame{self, cloud, indices, mask});
   }
+  queue.condition.notify_one();
+}
 
-  // Need setInputCloud () here because we have to extract x/y/z
-  IndicesPtr vindices;
-  if (indices) {
-    vindices.reset(new std::vector<int>(indices->indices));
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::workerLoop(const std::shared_ptr<WorkQueue> & queue)
+{
+  for (;; ) {
+    Frame frame;
+    std::uint64_t sequence;
+    {
+      std::unique_lock<std::mutex> lock(queue->mutex);
+      queue->condition.wait(lock, [&queue] {return queue->stop || !queue->frames.empty();});
+      if (queue->stop) {
+        return;
+      }
+      frame = std::move(queue->frames.front());
+      queue->frames.pop_front();
+      // Numbered in the order the frames are taken, which is the order they were received in
+      sequence = queue->next_sequence++;
+    }
+
+    // If this is the last reference, the node is destroyed on this thread when it goes away
+    const std::shared_ptr<Filter> filter = frame.filter.lock();
+    if (filter) {
+      filter->processFrame(frame, sequence);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::processFrame(const Frame & frame, std::uint64_t sequence)
+{
+  Output result;
+  PointCloud2::ConstSharedPtr cloud_tf = transformInput(frame.cloud);
+  if (cloud_tf) {
+    result = computeFrame(
+      cloud_tf, frame.indices, frame.cloud->header.frame_id, frame.mask.get());
+  }
+
+  // Publish the outputs in order, a frame that failed still releases the ones after it
+  std::lock_guard<std::mutex> lock(reorder_mutex_);
+  reorder_buffer_.emplace(sequence, std::move(result));
+  while (!reorder_buffer_.empty() && reorder_buffer_.begin()->first == next_published_) {
+    publishOutput(reorder_buffer_.begin()->second);
+    reorder_buffer_.erase(reorder_buffer_.begin());
+    ++next_published_;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::publishPoolStatistics()
+{
+  const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  std::int64_t last = last_diagnostics_.load();
+  // Only one of concurrent callers publishes
+  if (now - last < 1000000000 || !last_diagnostics_.compare_exchange_strong(last, now)) {
+    return;
+  }
+
+  const BufferPool::Statistics statistics = output_pool_.statistics();
+  publishDiagnostics(
+    "output buffer pool", {
+      {"acquired", statistics.acquired},
+      {"allocated", statistics.misses},
+      {"released", statistics.released},
+      {"evicted", statistics.evicted},
+      {"pooled_buffers", statistics.pooled_buffers},
+      {"pooled_bytes", statistics.pooled_bytes}});
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::input_latched_indices_callback(const PointCloud2::ConstSharedPtr & cloud)
+{
+  PointIndices::ConstSharedPtr indices;
+  std::shared_ptr<const PointMask> mask;
+  {
+    std::lock_guard<std::mutex> lock(latched_indices_mutex_);
+    indices = latched_indices_;
+    mask = latched_mask_;
+  }
+  if (mask) {
+    input_point_mask_callback(cloud, mask);
+    return;
+  }
+  if (!indices) {
+    RCLCPP_WARN_THROTTLE(
+      this->get_logger(), *this->get_clock(), 5000,
+      "[input_latched_indices_callback] No indices received yet on %s!",
+      mask_indices_ ? sub_mask_latched_->get_topic_name() :
+      sub_indices_latched_->get_topic_name());
+    return;
   }
+  input_indices_callback(cloud, indices);
+}
 
-  computePublish(cloud_tf, vindices);
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::input_mask_callback(
+  const PointCloud2::ConstSharedPtr & cloud,
+  const Image::ConstSharedPtr & mask)
+{
+  if (!hasOutputSubscribers()) {
+    return;
+  }
+  const std::shared_ptr<const PointMask> point_mask = decodeMask(*mask);
+  if (point_mask) {
+    input_point_mask_callback(cloud, point_mask);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::Filter::input_point_mask_callback(
+  const PointCloud2::ConstSharedPtr & cloud,
+  const std::shared_ptr<const PointMask> & mask)
+{
+  if (!hasOutputSubscribers()) {
+    return;
+  }
+  if (!isValid(cloud)) {
+    RCLCPP_ERROR(this->get_logger(), "Invalid input!");
+    return;
+  }
+  if (mask->size() != static_cast<std::size_t>(cloud->width) * cloud->height) {
+    RCLCPP_ERROR(
+      this->get_logger(), "Mask of %zu points does not match the PointCloud of %u x %u points.",
+      mask->size(), cloud->width, cloud->height);
+    return;
+  }
+  if (!acceptInput(cloud->header)) {
+    return;
+  }
+  processInput(cloud, nullptr, mask);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const pcl_ros::PointMask>
+pcl_ros::Filter::decodeMask(const Image & mask)
+{
+  auto point_mask = std::make_shared<PointMask>();
+  if (!point_mask->assign(mask)) {
+    RCLCPP_ERROR(
+      this->get_logger(),
+      "Invalid mask of %u x %u pixels with encoding %s, expected a %s or mono8 Image!",
+      mask.width, mask.height, mask.encoding.c_str(), PointMask::kBitmaskEncoding);
+    return nullptr;
+  }
+  return point_mask;
 }
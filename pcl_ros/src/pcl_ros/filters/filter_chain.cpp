@@ -0,0 +1,427 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/filter_chain.hpp"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "pcl_ros/filters/outlier_masks.hpp"
+
+namespace
+{
+const char * const kStageNames[] = {
+  "crop_box", "passthrough", "voxel_grid", "statistical_outlier_removal", "radius_outlier_removal"
+};
+// 0: fused predicates, 1: voxel grid, 2: outlier tests sharing one search tree
+const std::size_t kStageGroups[] = {0, 0, 1, 2, 2};
+}  // namespace
+
+pcl_ros::FilterChain::FilterChain(const rclcpp::NodeOptions & options)
+: Filter("FilterChainNode", options),
+  use_crop_box_(false), use_passthrough_(false), use_voxel_grid_(false),
+  use_statistical_(false), use_radius_(false)
+{
+  use_frame_params();
+
+  rcl_interfaces::msg::ParameterDescriptor stages_desc;
+  stages_desc.name = "stages";
+  stages_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  stages_desc.description =
+    "The stages to run, in order: crop_box, passthrough, voxel_grid, "
+    "statistical_outlier_removal, radius_outlier_removal. The two outlier stages may come in any "
+    "order, statistical_outlier_removal always runs first.";
+  stages_desc.read_only = true;
+  const std::vector<std::string> stages = declare_parameter(
+    stages_desc.name, std::vector<std::string>{
+    "crop_box", "passthrough", "voxel_grid", "statistical_outlier_removal"}, stages_desc);
+  if (!setStages(stages)) {
+    throw std::runtime_error("Invalid 'stages' parameter, see its description.");
+  }
+
+  // ---[ crop_box
+  const std::vector<std::pair<std::string, double>> box_limits {
+    {"crop_box.min_x", -1.0}, {"crop_box.max_x", 1.0},
+    {"crop_box.min_y", -1.0}, {"crop_box.max_y", 1.0},
+    {"crop_box.min_z", -1.0}, {"crop_box.max_z", 1.0},
+  };
+  for (const auto & limit : box_limits) {
+    rcl_interfaces::msg::ParameterDescriptor limit_desc;
+    limit_desc.name = limit.first;
+    limit_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+    limit_desc.description = "Limit of the crop box along one axis";
+    {
+      rcl_interfaces::msg::FloatingPointRange float_range;
+      float_range.from_value = -1000.0;
+      float_range.to_value = 1000.0;
+      limit_desc.floating_point_range.push_back(float_range);
+    }
+    declare_parameter(limit_desc.name, rclcpp::ParameterValue(limit.second), limit_desc);
+  }
+
+  rcl_interfaces::msg::ParameterDescriptor box_negative_desc;
+  box_negative_desc.name = "crop_box.negative";
+  box_negative_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  box_negative_desc.description =
+    "Set whether the points inside the box should be removed instead of kept.";
+  declare_parameter(box_negative_desc.name, rclcpp::ParameterValue(false), box_negative_desc);
+
+  // ---[ passthrough
+  rcl_interfaces::msg::ParameterDescriptor ffn_desc;
+  ffn_desc.name = "passthrough.filter_field_name";
+  ffn_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  ffn_desc.description = "The field name used for filtering";
+  declare_parameter(ffn_desc.name, rclcpp::ParameterValue("z"), ffn_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor flmin_desc;
+  flmin_desc.name = "passthrough.filter_limit_min";
+  flmin_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  flmin_desc.description = "The minimum allowed field value a point will be considered from";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = -100000.0;
+    float_range.to_value = 100000.0;
+    flmin_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(flmin_desc.name, rclcpp::ParameterValue(0.0), flmin_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor flmax_desc;
+  flmax_desc.name = "passthrough.filter_limit_max";
+  flmax_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  flmax_desc.description = "The maximum allowed field value a point will be considered from";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = -100000.0;
+    float_range.to_value = 100000.0;
+    flmax_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(flmax_desc.name, rclcpp::ParameterValue(1.0), flmax_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor flneg_desc;
+  flneg_desc.name = "passthrough.filter_limit_negative";
+  flneg_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  flneg_desc.description =
+    "Set to true if we want to return the data outside [filter_limit_min; filter_limit_max].";
+  declare_parameter(flneg_desc.name, rclcpp::ParameterValue(false), flneg_desc);
+
+  // ---[ voxel_grid
+  rcl_interfaces::msg::ParameterDescriptor leaf_size_desc;
+  leaf_size_desc.name = "voxel_grid.leaf_size";
+  leaf_size_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  leaf_size_desc.description = "The size of a leaf (on x,y,z) used for downsampling";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = 0.0;
+    float_range.to_value = 1.0;
+    leaf_size_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(leaf_size_desc.name, rclcpp::ParameterValue(0.01), leaf_size_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor min_points_desc;
+  min_points_desc.name = "voxel_grid.min_points_per_voxel";
+  min_points_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  min_points_desc.description = "The minimum number of points required for a voxel to be used.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 1;
+    int_range.to_value = 100000;
+    min_points_desc.integer_range.push_back(int_range);
+  }
+  declare_parameter(min_points_desc.name, rclcpp::ParameterValue(2), min_points_desc);
+
+  // ---[ statistical_outlier_removal
+  rcl_interfaces::msg::ParameterDescriptor mean_k_desc;
+  mean_k_desc.name = "statistical_outlier_removal.mean_k";
+  mean_k_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  mean_k_desc.description = "The number of points (k) to use for mean distance estimation.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 2;
+    int_range.to_value = 100;
+    mean_k_desc.integer_range.push_back(int_range);
+  }
+  declare_parameter(mean_k_desc.name, rclcpp::ParameterValue(2), mean_k_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor stddev_desc;
+  stddev_desc.name = "statistical_outlier_removal.stddev";
+  stddev_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  stddev_desc.description =
+    "The standard deviation multiplier threshold. "
+    "All points outside the mean +- sigma * std_mul will be considered outliers.";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = 0.0;
+    float_range.to_value = 5.0;
+    stddev_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(stddev_desc.name, rclcpp::ParameterValue(0.0), stddev_desc);
+
+  // ---[ radius_outlier_removal
+  rcl_interfaces::msg::ParameterDescriptor radius_search_desc;
+  radius_search_desc.name = "radius_outlier_removal.radius_search";
+  radius_search_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  radius_search_desc.description =
+    "Radius of the sphere that will determine which points are neighbors.";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = 0.0;
+    float_range.to_value = 10.0;
+    radius_search_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(radius_search_desc.name, rclcpp::ParameterValue(0.1), radius_search_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor min_neighbors_desc;
+  min_neighbors_desc.name = "radius_outlier_removal.min_neighbors";
+  min_neighbors_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  min_neighbors_desc.description =
+    "The number of neighbors that need to be present in order to be classified as an inlier. "
+    "Only the points kept by statistical_outlier_removal, if enabled, count as neighbors.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 1000;
+    min_neighbors_desc.integer_range.push_back(int_range);
+  }
+  declare_parameter(min_neighbors_desc.name, rclcpp::ParameterValue(5), min_neighbors_desc);
+
+  std::vector<std::string> param_names {
+    ffn_desc.name,
+    flmin_desc.name,
+    flmax_desc.name,
+    flneg_desc.name,
+    box_negative_desc.name,
+    leaf_size_desc.name,
+    min_points_desc.name,
+    mean_k_desc.name,
+    stddev_desc.name,
+    radius_search_desc.name,
+    min_neighbors_desc.name,
+  };
+  for (const auto & limit : box_limits) {
+    param_names.push_back(limit.first);
+  }
+
+  callback_handle_ =
+    add_on_set_parameters_callback(
+    std::bind(
+      &FilterChain::config_callback, this,
+      std::placeholders::_1));
+
+  config_callback(get_parameters(param_names));
+
+  lazySubscribe();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::FilterChain::setStages(const std::vector<std::string> & stages)
+{
+  bool * const flags[] = {
+    &use_crop_box_, &use_passthrough_, &use_voxel_grid_, &use_statistical_, &use_radius_
+  };
+  const std::size_t nr_stages = sizeof(kStageNames) / sizeof(kStageNames[0]);
+  std::size_t group = 0;
+  for (const std::string & stage : stages) {
+    std::size_t s = 0;
+    while (s < nr_stages && stage != kStageNames[s]) {
+      ++s;
+    }
+    // Stages of the same group are evaluated together, so only those may come in any order
+    if (s == nr_stages || *flags[s] || kStageGroups[s] < group) {
+      RCLCPP_ERROR(
+        get_logger(), "Stage '%s' is unknown, repeated or out of order.", stage.c_str());
+      return false;
+    }
+    *flags[s] = true;
+    group = kStageGroups[s];
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::FilterChain::filter(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  PointCloud2 & output)
+{
+  // The latest configuration and a private workspace, parameter updates do not wait for the filter
+  std::shared_ptr<const Config> config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(*input) || !getXYZOffsets(*input, xyz)) {
+    RCLCPP_ERROR(
+      get_logger(), "Input needs FLOAT32 x, y and z fields in host byte order (%s).",
+      pcl::getFieldsList(*input).c_str());
+    output.header = input->header;
+    return;
+  }
+
+  // ---[ Predicate stages, fused in a single pass over the input buffer
+  std::vector<FieldRange> ranges;
+  std::vector<BoxRegion> boxes;
+  if (use_passthrough_ && !config->passthrough_field_name.empty()) {
+    FieldRange range = config->passthrough_range;
+    if (!resolveFieldRange(*input, config->passthrough_field_name, range)) {
+      RCLCPP_ERROR(
+        get_logger(), "Unable to find a numeric field named %s in (%s).",
+        config->passthrough_field_name.c_str(), pcl::getFieldsList(*input).c_str());
+      output.header = input->header;
+      return;
+    }
+    ranges.push_back(range);
+  }
+  if (use_crop_box_) {
+    boxes.push_back(config->crop_box);
+  }
+  extractPassing(*input, xyz, ranges, boxes, indices.get(), output);
+
+  // ---[ voxel_grid, moving the intermediate buffer in and out of PCL instead of copying it
+  if (use_voxel_grid_) {
+    VoxelGridImpl & voxel_grid = workspace->voxel_grid.get(
+      std::shared_ptr<const VoxelGridImpl>(config, &config->voxel_grid));
+    pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
+    pcl_conversions::moveToPCL(output, *pcl_input);
+    voxel_grid.setInputCloud(pcl_input);
+    pcl::PCLPointCloud2 pcl_output;
+    voxel_grid.filter(pcl_output);
+    pcl_conversions::moveFromPCL(pcl_output, output);
+  }
+
+  // ---[ Outlier stages, sharing one search tree and compacting the buffer once
+  if ((use_statistical_ || use_radius_) && output.width * output.height > 0) {
+    const pcl::PointCloud<pcl::PointXYZ>::Ptr & xyz_cloud = workspace->xyz_cloud;
+    pcl::search::KdTree<pcl::PointXYZ> & tree = *workspace->tree;
+    std::vector<std::uint8_t> & keep = workspace->keep;
+    pcl::fromROSMsg(output, *xyz_cloud);
+    tree.setInputCloud(xyz_cloud);
+    keep.assign(xyz_cloud->size(), 1);
+    if (use_statistical_) {
+      markStatisticalOutliers(
+        tree, *xyz_cloud, config->mean_k, config->stddev_mult, false, 1, nullptr, keep);
+    }
+    if (use_radius_) {
+      // Like a RadiusOutlierRemoval run on the output of StatisticalOutlierRemoval, only the
+      // points that passed the statistical test are tested and counted as neighbors
+      const std::vector<std::uint8_t> * survivors = nullptr;
+      if (use_statistical_) {
+        workspace->survivors = keep;
+        survivors = &workspace->survivors;
+      }
+      markRadiusOutliers(
+        tree, *xyz_cloud, config->radius_search, config->min_neighbors, false, survivors, keep);
+    }
+    compactPoints(output, keep);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+rcl_interfaces::msg::SetParametersResult
+pcl_ros::FilterChain::config_callback(const std::vector<rclcpp::Parameter> & params)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  Eigen::Vector3f leaf_size = config_.voxel_grid.getLeafSize();
+
+  for (const rclcpp::Parameter & param : params) {
+    const std::string & name = param.get_name();
+    if (name == "crop_box.min_x") {
+      config_.crop_box.min_pt[0] = static_cast<float>(param.as_double());
+    }
+    if (name == "crop_box.max_x") {
+      config_.crop_box.max_pt[0] = static_cast<float>(param.as_double());
+    }
+    if (name == "crop_box.min_y") {
+      config_.crop_box.min_pt[1] = static_cast<float>(param.as_double());
+    }
+    if (name == "crop_box.max_y") {
+      config_.crop_box.max_pt[1] = static_cast<float>(param.as_double());
+    }
+    if (name == "crop_box.min_z") {
+      config_.crop_box.min_pt[2] = static_cast<float>(param.as_double());
+    }
+    if (name == "crop_box.max_z") {
+      config_.crop_box.max_pt[2] = static_cast<float>(param.as_double());
+    }
+    if (name == "crop_box.negative") {
+      config_.crop_box.negative = param.as_bool();
+    }
+    if (name == "passthrough.filter_field_name") {
+      config_.passthrough_field_name = param.as_string();
+    }
+    if (name == "passthrough.filter_limit_min") {
+      config_.passthrough_range.limit_min = param.as_double();
+    }
+    if (name == "passthrough.filter_limit_max") {
+      config_.passthrough_range.limit_max = param.as_double();
+    }
+    if (name == "passthrough.filter_limit_negative") {
+      config_.passthrough_range.negative = param.as_bool();
+    }
+    if (name == "voxel_grid.leaf_size") {
+      leaf_size.setConstant(param.as_double());
+      if (config_.voxel_grid.getLeafSize() != leaf_size) {
+        config_.voxel_grid.setLeafSize(leaf_size[0], leaf_size[1], leaf_size[2]);
+      }
+    }
+    if (name == "voxel_grid.min_points_per_voxel") {
+      config_.voxel_grid.setMinimumPointsNumberPerVoxel(param.as_int());
+    }
+    if (name == "statistical_outlier_removal.mean_k") {
+      config_.mean_k = param.as_int();
+    }
+    if (name == "statistical_outlier_removal.stddev") {
+      config_.stddev_mult = param.as_double();
+    }
+    if (name == "radius_outlier_removal.radius_search") {
+      config_.radius_search = param.as_double();
+    }
+    if (name == "radius_outlier_removal.min_neighbors") {
+      config_.min_neighbors = param.as_int();
+    }
+  }
+
+  snapshot_.store(config_);
+
+  // Range constraints are enforced by rclcpp::Parameter.
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+  return result;
+}
+
+#include "rclcpp_components/register_node_macro.hpp"
+RCLCPP_COMPONENTS_REGISTER_NODE(pcl_ros::FilterChain)
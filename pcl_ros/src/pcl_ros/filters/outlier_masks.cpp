@@ -0,0 +1,298 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/outlier_masks.hpp"
+#include <pcl/common/point_tests.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "pcl_ros/filters/parallel_for.hpp"
+
+namespace
+{
+/** \brief Points per parallel chunk, to keep the thread overhead negligible. */
+constexpr std::size_t kMinPointsPerChunk = 4096;
+
+/** \brief Statistical outlier test on the mean neighbor distances written by
+  * \a kernel (begin, end, distances). The kernel writes NaN for the points that do not count in
+  * the statistics, which are then tested with a distance of 0 like pcl::StatisticalOutlierRemoval
+  * does, and infinity for certain outliers.
+  *
+  * Without initialized running statistics, all distances are computed first and then compared
+  * against the threshold of this frame. With them, every point is classified as soon as its
+  * distance is known, against the threshold of the previous frames, and the statistics of this
+  * frame are blended into them afterwards.
+  */
+template<typename DistanceKernel>
+void
+markByMeanDistance(
+  std::size_t nr_points, const DistanceKernel & kernel, double stddev_mult, bool negative,
+  unsigned int num_threads, pcl_ros::DistanceStatistics * running,
+  std::vector<std::uint8_t> & keep)
+{
+  const bool streaming = running && running->initialized;
+  const double running_threshold =
+    streaming ? running->mean + stddev_mult * std::sqrt(running->variance) : 0.0;
+  std::vector<float> distances(streaming ? 0 : nr_points);
+
+  // Fixed chunks, so that the statistics do not depend on the thread scheduling
+  const std::size_t nr_chunks = std::max(1u, num_threads);
+  const std::size_t chunk = (nr_points + nr_chunks - 1) / nr_chunks;
+  std::vector<double> sums(nr_chunks, 0.0), sq_sums(nr_chunks, 0.0);
+  std::vector<std::size_t> counts(nr_chunks, 0);
+  pcl_ros::parallelFor(
+    nr_chunks, num_threads, 1, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+      std::vector<float> block_distances(streaming ? kMinPointsPerChunk : 0);
+      for (std::size_t i = chunk_begin; i < chunk_end; ++i) {
+        double chunk_sum = 0.0, chunk_sq_sum = 0.0;
+        std::size_t chunk_count = 0;
+        const std::size_t end = std::min(nr_points, (i + 1) * chunk);
+        for (std::size_t begin = i * chunk; begin < end; begin += kMinPointsPerChunk) {
+          const std::size_t block_end = std::min(end, begin + kMinPointsPerChunk);
+          float * block = streaming ? block_distances.data() : distances.data() + begin;
+          kernel(begin, block_end, block);
+          for (std::size_t cp = begin; cp < block_end; ++cp) {
+            const float distance = block[cp - begin];
+            if (std::isfinite(distance)) {
+              chunk_sum += distance;
+              chunk_sq_sum += distance * distance;
+              ++chunk_count;
+            }
+            if (streaming && keep[cp] &&
+              (((std::isnan(distance) ? 0.0f : distance) <= running_threshold) == negative))
+            {
+              keep[cp] = 0;
+            }
+          }
+        }
+        sums[i] = chunk_sum;
+        sq_sums[i] = chunk_sq_sum;
+        counts[i] = chunk_count;
+      }
+    });
+
+  double sum = 0.0, sq_sum = 0.0;
+  std::size_t valid_distances = 0;
+  for (std::size_t i = 0; i < nr_chunks; ++i) {
+    sum += sums[i];
+    sq_sum += sq_sums[i];
+    valid_distances += counts[i];
+  }
+  if (valid_distances < 2) {
+    return;
+  }
+  const double mean = sum / static_cast<double>(valid_distances);
+  const double variance = std::max(
+    0.0, (sq_sum - sum * sum / static_cast<double>(valid_distances)) /
+    (static_cast<double>(valid_distances) - 1));
+
+  if (!streaming) {
+    const double threshold = mean + stddev_mult * std::sqrt(variance);
+    pcl_ros::parallelFor(
+      nr_points, num_threads, kMinPointsPerChunk, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t cp = begin; cp < end; ++cp) {
+          if (keep[cp] &&
+            (((std::isnan(distances[cp]) ? 0.0f : distances[cp]) <= threshold) == negative))
+          {
+            keep[cp] = 0;
+          }
+        }
+      });
+  }
+
+  if (running) {
+    const double alpha = running->initialized ? running->alpha : 1.0;
+    running->mean += alpha * (mean - running->mean);
+    running->variance += alpha * (variance - running->variance);
+    running->initialized = true;
+  }
+}
+
+inline float
+readFloat(const std::uint8_t * point, std::uint32_t offset)
+{
+  float value;
+  std::memcpy(&value, point + offset, sizeof(float));
+  return value;
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::markStatisticalOutliers(
+  const pcl::search::Search<pcl::PointXYZ> & search, const pcl::PointCloud<pcl::PointXYZ> & cloud,
+  int mean_k, double stddev_mult, bool negative, unsigned int num_threads,
+  DistanceStatistics * running, std::vector<std::uint8_t> & keep)
+{
+  // Mean distance of every point to its nearest neighbors, as in the PCLPointCloud2 version of
+  // pcl::StatisticalOutlierRemoval: the mean_k nearest points include the point itself, so the
+  // mean is over the mean_k - 1 others. Non finite points, and points without neighbors, get a
+  // NaN distance.
+  auto kernel = [&](std::size_t begin, std::size_t end, float * distances) {
+      pcl::Indices nn_indices(mean_k);
+      std::vector<float> nn_dists(mean_k);
+      for (std::size_t cp = begin; cp < end; ++cp) {
+        float & distance = distances[cp - begin];
+        const int found = pcl::isFinite(cloud[cp]) ?
+          search.nearestKSearch(cloud[cp], mean_k, nn_indices, nn_dists) : 0;
+        if (found == 0) {
+          distance = std::numeric_limits<float>::quiet_NaN();
+          continue;
+        }
+        // The first neighbor is the point itself
+        double dist_sum = 0.0;
+        for (int k = 1; k < found; ++k) {
+          dist_sum += std::sqrt(nn_dists[k]);
+        }
+        distance = static_cast<float>(dist_sum / (mean_k - 1));
+      }
+    };
+  markByMeanDistance(cloud.size(), kernel, stddev_mult, negative, num_threads, running, keep);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::markStatisticalOutliersOrganized(
+  const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, int mean_k,
+  double stddev_mult, bool negative, unsigned int num_threads, DistanceStatistics * running,
+  std::vector<std::uint8_t> & keep)
+{
+  const int width = static_cast<int>(cloud.width);
+  const int height = static_cast<int>(cloud.height);
+  const std::size_t nr_points = static_cast<std::size_t>(width) * height;
+
+  // Smallest square window with at least twice mean_k pixels besides the center, to tolerate
+  // missing returns
+  int half_window = 1;
+  while ((2 * half_window + 1) * (2 * half_window + 1) - 1 < 2 * mean_k) {
+    ++half_window;
+  }
+
+  // Unpack x, y and z once, the windows of neighboring pixels overlap
+  std::vector<float> points(3 * nr_points);
+  for (std::size_t cp = 0; cp < nr_points; ++cp) {
+    const std::uint8_t * point = cloud.data.data() + cp * cloud.point_step;
+    points[3 * cp] = readFloat(point, xyz.x);
+    points[3 * cp + 1] = readFloat(point, xyz.y);
+    points[3 * cp + 2] = readFloat(point, xyz.z);
+  }
+
+  auto kernel = [&](std::size_t begin, std::size_t end, float * distances) {
+      std::vector<float> sq_dists;
+      sq_dists.reserve((2 * half_window + 1) * (2 * half_window + 1));
+      for (std::size_t cp = begin; cp < end; ++cp) {
+        float & distance = distances[cp - begin];
+        const float px = points[3 * cp], py = points[3 * cp + 1], pz = points[3 * cp + 2];
+        if (!std::isfinite(px) || !std::isfinite(py) || !std::isfinite(pz)) {
+          distance = std::numeric_limits<float>::quiet_NaN();
+          continue;
+        }
+
+        // Windows are shifted inside the image rather than cut at its borders
+        const int v = static_cast<int>(cp / width);
+        const int u = static_cast<int>(cp % width);
+        const int v_begin = std::max(0, std::min(v - half_window, height - 2 * half_window - 1));
+        const int u_begin = std::max(0, std::min(u - half_window, width - 2 * half_window - 1));
+        const int v_end = std::min(height, v_begin + 2 * half_window + 1);
+        const int u_end = std::min(width, u_begin + 2 * half_window + 1);
+        sq_dists.clear();
+        for (int nv = v_begin; nv < v_end; ++nv) {
+          for (int nu = u_begin; nu < u_end; ++nu) {
+            const std::size_t np = static_cast<std::size_t>(nv) * width + nu;
+            const float dx = points[3 * np] - px;
+            const float dy = points[3 * np + 1] - py;
+            const float dz = points[3 * np + 2] - pz;
+            const float sq_dist = dx * dx + dy * dy + dz * dz;
+            // NaN neighbors fail the comparison
+            if (np != cp && sq_dist < std::numeric_limits<float>::infinity()) {
+              sq_dists.push_back(sq_dist);
+            }
+          }
+        }
+        // The mean_k - 1 nearest neighbors besides the point, as in markStatisticalOutliers ()
+        const int nr_neighbors = mean_k - 1;
+        if (sq_dists.size() < static_cast<std::size_t>(nr_neighbors)) {
+          distance = std::numeric_limits<float>::infinity();
+          continue;
+        }
+
+        std::nth_element(sq_dists.begin(), sq_dists.begin() + (nr_neighbors - 1), sq_dists.end());
+        double dist_sum = 0.0;
+        for (int k = 0; k < nr_neighbors; ++k) {
+          dist_sum += std::sqrt(sq_dists[k]);
+        }
+        distance = static_cast<float>(dist_sum / nr_neighbors);
+      }
+    };
+  markByMeanDistance(nr_points, kernel, stddev_mult, negative, num_threads, running, keep);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::markRadiusOutliers(
+  const pcl::search::Search<pcl::PointXYZ> & search, const pcl::PointCloud<pcl::PointXYZ> & cloud,
+  double radius, int min_neighbors, bool negative, const std::vector<std::uint8_t> * survivors,
+  std::vector<std::uint8_t> & keep)
+{
+  pcl::Indices nn_indices;
+  std::vector<float> nn_dists;
+  for (std::size_t cp = 0; cp < cloud.size(); ++cp) {
+    if (survivors && !(*survivors)[cp]) {
+      continue;
+    }
+    if (!pcl::isFinite(cloud[cp])) {
+      keep[cp] = 0;
+      continue;
+    }
+    int found;
+    if (survivors) {
+      // The removed points may be the nearest ones, search the whole sphere and count the others
+      search.radiusSearch(cloud[cp], radius, nn_indices, nn_dists, 0);
+      found = static_cast<int>(
+        std::count_if(
+          nn_indices.begin(), nn_indices.end(),
+          [survivors](int index) {return (*survivors)[index] != 0;}));
+    } else {
+      // The search result includes the point itself, and there is no need to look any further
+      // than one neighbor past the threshold
+      found = search.radiusSearch(
+        cloud[cp], radius, nn_indices, nn_dists, static_cast<unsigned int>(min_neighbors + 1));
+    }
+    if ((found > min_neighbors) == negative) {
+      keep[cp] = 0;
+    }
+  }
+}
@@ -36,6 +36,11 @@
  */
 
 #include "pcl_ros/filters/passthrough.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 pcl_ros::PassThrough::PassThrough(const rclcpp::NodeOptions & options)
 : Filter("PassThroughNode", options)
@@ -51,8 +56,43 @@ pcl_ros::PassThrough::PassThrough(const rclcpp::NodeOptions & options)
     "or removed from the PointCloud, thus potentially breaking its organized structure.";
   declare_parameter(keep_organized_desc.name, rclcpp::ParameterValue(false), keep_organized_desc);
 
+  rcl_interfaces::msg::ParameterDescriptor ffns_desc;
+  ffns_desc.name = "filter_field_names";
+  ffns_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  ffns_desc.description =
+    "Field names of additional ranges a point must satisfy, "
+    "evaluated together with filter_field_name. filter_limits_min, filter_limits_max and, unless "
+    "empty, filter_limits_negative must have the same length, resize them together with "
+    "set_parameters_atomically.";
+  declare_parameter(
+    ffns_desc.name, rclcpp::ParameterValue(std::vector<std::string>{}), ffns_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor flsmin_desc;
+  flsmin_desc.name = "filter_limits_min";
+  flsmin_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  flsmin_desc.description = "The minimum allowed value of each field in filter_field_names";
+  declare_parameter(flsmin_desc.name, rclcpp::ParameterValue(std::vector<double>{}), flsmin_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor flsmax_desc;
+  flsmax_desc.name = "filter_limits_max";
+  flsmax_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  flsmax_desc.description = "The maximum allowed value of each field in filter_field_names";
+  declare_parameter(flsmax_desc.name, rclcpp::ParameterValue(std::vector<double>{}), flsmax_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor flsneg_desc;
+  flsneg_desc.name = "filter_limits_negative";
+  flsneg_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL_ARRAY;
+  flsneg_desc.description =
+    "For each field in filter_field_names, set to true to keep the values outside of its "
+    "limits instead. May be left empty.";
+  declare_parameter(flsneg_desc.name, rclcpp::ParameterValue(std::vector<bool>{}), flsneg_desc);
+
   std::vector<std::string> param_names {
     keep_organized_desc.name,
+    ffns_desc.name,
+    flsmin_desc.name,
+    flsmax_desc.name,
+    flsneg_desc.name,
   };
   param_names.insert(param_names.end(), common_param_names.begin(), common_param_names.end());
 
@@ -62,41 +102,252 @@ pcl_ros::PassThrough::PassThrough(const rclcpp::NodeOptions & options)
       &PassThrough::config_callback, this,
       std::placeholders::_1));
 
-  config_callback(get_parameters(param_names));
+  const rcl_interfaces::msg::SetParametersResult result =
+    config_callback(get_parameters(param_names));
+  if (!result.successful) {
+    throw std::runtime_error(result.reason);
+  }
 
-  // TODO(daisukes): lazy subscription after rclcpp#2060
-  subscribe();
+  lazySubscribe();
 }
 
 void pcl_ros::PassThrough::filter(
-  const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
   PointCloud2 & output)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // The latest configuration and a private workspace, parameter updates do not wait for the filter
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  if (!config->predicate_ranges.empty()) {
+    filterPredicates(config, *workspace, *input, indices, output);
+    return;
+  }
+  if (config->impl.getKeepOrganized() && !indices &&
+    filterOrganized(config, *workspace, *input, output))
+  {
+    return;
+  }
+  Impl & impl = workspace->impl.get(std::shared_ptr<const Impl>(config, &config->impl));
   pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
   pcl_conversions::toPCL(*(input), *(pcl_input));
-  impl_.setInputCloud(pcl_input);
-  impl_.setIndices(indices);
+  impl.setInputCloud(pcl_input);
+  impl.setIndices(copyIndices(indices));
   pcl::PCLPointCloud2 pcl_output;
-  impl_.filter(pcl_output);
+  // PCL resizes the buffer acquired for the output, moveFromPCL swaps it back
+  pcl_output.data = std::move(output.data);
+  impl.filter(pcl_output);
   pcl_conversions::moveFromPCL(pcl_output, output);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::PassThrough::filterIndices(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  std::vector<int> & output_indices)
+{
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(*input) || !getXYZOffsets(*input, xyz) ||
+    !resolveRanges(config, *workspace, *input))
+  {
+    return false;
+  }
+  selectPassing(
+    *input, xyz, workspace->ranges, std::vector<BoxRegion>(), indices.get(), output_indices);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PassThrough::filterMasked(
+  const PointCloud2::ConstSharedPtr & input, const PointMask & mask, PointCloud2 & output)
+{
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  // keep_organized ignores the selection or masks the whole cloud, leave it to filter ()
+  XYZOffsets xyz;
+  if (config->impl.getKeepOrganized() || !isDirectlyAccessible(*input) ||
+    !getXYZOffsets(*input, xyz) || !resolveRanges(config, *workspace, *input))
+  {
+    Filter::filterMasked(input, mask, output);
+    return;
+  }
+  extractPassing(*input, xyz, workspace->ranges, std::vector<BoxRegion>(), mask, output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::PassThrough::filterMask(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  const PointMask * mask, PointMask & output_mask)
+{
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(*input) || !getXYZOffsets(*input, xyz) ||
+    !resolveRanges(config, *workspace, *input))
+  {
+    return false;
+  }
+  selectPassing(
+    *input, xyz, workspace->ranges, std::vector<BoxRegion>(), indices.get(), mask, output_mask);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PassThrough::updatePredicates()
+{
+  const std::size_t nr_predicates = field_names_param_.size();
+  config_.predicate_fields = field_names_param_;
+  config_.predicate_ranges.resize(nr_predicates);
+  for (std::size_t i = 0; i < nr_predicates; ++i) {
+    FieldRange & range = config_.predicate_ranges[i];
+    range.limit_min = limits_min_param_[i];
+    range.limit_max = limits_max_param_[i];
+    range.negative =
+      limits_negative_param_.empty() ? false : static_cast<bool>(limits_negative_param_[i]);
+    RCLCPP_DEBUG(
+      get_logger(), "Setting predicate %zu to %s in [%f; %f]%s.", i,
+      config_.predicate_fields[i].c_str(), range.limit_min, range.limit_max,
+      range.negative ? " (negative)" : "");
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::PassThrough::resolveRanges(
+  const ConfigConstPtr & config, Workspace & workspace,
+  const PointCloud2 & input)
+{
+  if (workspace.ranges_config == config && input.fields == workspace.ranges_layout) {
+    return true;
+  }
+
+  workspace.ranges_config.reset();
+  workspace.ranges.clear();
+  if (!config->impl.getFilterFieldName().empty()) {
+    FieldRange range;
+    config->impl.getFilterLimits(range.limit_min, range.limit_max);
+    range.negative = config->impl.getNegative();
+    if (!resolveFieldRange(input, config->impl.getFilterFieldName(), range)) {
+      return false;
+    }
+    workspace.ranges.push_back(range);
+  }
+  for (std::size_t i = 0; i < config->predicate_ranges.size(); ++i) {
+    FieldRange range = config->predicate_ranges[i];
+    if (!resolveFieldRange(input, config->predicate_fields[i], range)) {
+      return false;
+    }
+    workspace.ranges.push_back(range);
+  }
+  workspace.ranges_layout = input.fields;
+  workspace.ranges_config = config;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::PassThrough::filterOrganized(
+  const ConfigConstPtr & config, Workspace & workspace,
+  const PointCloud2 & input, PointCloud2 & output)
+{
+  // keep_organized never changes the size of the cloud, so the output is a copy of the input
+  // with the x, y and z values of the removed points set to NaN
+  XYZOffsets xyz;
+  if (config->impl.getFilterFieldName().empty() || !isDirectlyAccessible(input) ||
+    !getXYZOffsets(input, xyz) || !resolveRanges(config, workspace, input))
+  {
+    return false;
+  }
+
+  output = input;
+  maskFailing(output, xyz, workspace.ranges, std::vector<BoxRegion>());
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PassThrough::filterPredicates(
+  const ConfigConstPtr & config, Workspace & workspace,
+  const PointCloud2 & input, const IndicesConstPtr & indices, PointCloud2 & output)
+{
+  if (!isDirectlyAccessible(input) || !resolveRanges(config, workspace, input)) {
+    RCLCPP_ERROR(
+      get_logger(), "Unable to evaluate the filter fields on (%s) with byte order %s.",
+      pcl::getFieldsList(input).c_str(), input.is_bigendian ? "big endian" : "little endian");
+    output.header = input.header;
+    return;
+  }
+
+  // Like pcl::PassThrough, which needs x, y and z to drop or mask the non finite points
+  XYZOffsets xyz;
+  if (!getXYZOffsets(input, xyz)) {
+    RCLCPP_ERROR(get_logger(), "The filter needs FLOAT32 x, y and z fields.");
+    output.header = input.header;
+    return;
+  }
+  if (config->impl.getKeepOrganized()) {
+    if (indices) {
+      RCLCPP_WARN_ONCE(get_logger(), "Indices are ignored when keep_organized is set.");
+    }
+    output = input;
+    maskFailing(output, xyz, workspace.ranges, std::vector<BoxRegion>());
+  } else {
+    extractPassing(
+      input, xyz, workspace.ranges, std::vector<BoxRegion>(), indices.get(), output);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 rcl_interfaces::msg::SetParametersResult
 pcl_ros::PassThrough::config_callback(const std::vector<rclcpp::Parameter> & params)
 {
   std::lock_guard<std::mutex> lock(mutex_);
+  rcl_interfaces::msg::SetParametersResult result;
+
+  // The array parameters must stay consistent, check them before applying anything so that a
+  // rejected batch changes nothing
+  std::vector<std::string> field_names = field_names_param_;
+  std::vector<double> limits_min = limits_min_param_, limits_max = limits_max_param_;
+  std::vector<bool> limits_negative = limits_negative_param_;
+  for (const rclcpp::Parameter & param : params) {
+    if (param.get_name() == "filter_field_names") {
+      field_names = param.as_string_array();
+    }
+    if (param.get_name() == "filter_limits_min") {
+      limits_min = param.as_double_array();
+    }
+    if (param.get_name() == "filter_limits_max") {
+      limits_max = param.as_double_array();
+    }
+    if (param.get_name() == "filter_limits_negative") {
+      limits_negative = param.as_bool_array();
+    }
+  }
+  if (limits_min.size() != field_names.size() || limits_max.size() != field_names.size() ||
+    (!limits_negative.empty() && limits_negative.size() != field_names.size()))
+  {
+    result.successful = false;
+    result.reason =
+      "filter_field_names, filter_limits_min, filter_limits_max and, unless empty, "
+      "filter_limits_negative must have the same length, resize them together with "
+      "set_parameters_atomically";
+    return result;
+  }
 
   double filter_min, filter_max;
-  impl_.getFilterLimits(filter_min, filter_max);
+  config_.impl.getFilterLimits(filter_min, filter_max);
+  bool update_predicates = false;
 
   for (const rclcpp::Parameter & param : params) {
     if (param.get_name() == "filter_field_name") {
       // Check the current value for the filter field
-      if (impl_.getFilterFieldName() != param.as_string()) {
+      if (config_.impl.getFilterFieldName() != param.as_string()) {
         // Set the filter field if different
-        impl_.setFilterFieldName(param.as_string());
+        config_.impl.setFilterFieldName(param.as_string());
         RCLCPP_DEBUG(
           get_logger(), "Setting the filter field name to: %s.",
           param.as_string().c_str());
@@ -111,7 +362,7 @@ pcl_ros::PassThrough::config_callback(const std::vector<rclcpp::Parameter> & par
           "Setting the minimum filtering value a point will be considered from to: %f.",
           filter_min);
         // Set the filter min-max if different
-        impl_.setFilterLimits(filter_min, filter_max);
+        config_.impl.setFilterLimits(filter_min, filter_max);
       }
     }
     if (param.get_name() == "filter_limit_max") {
@@ -123,32 +374,52 @@ pcl_ros::PassThrough::config_callback(const std::vector<rclcpp::Parameter> & par
           "Setting the maximum filtering value a point will be considered from to: %f.",
           filter_max);
         // Set the filter min-max if different
-        impl_.setFilterLimits(filter_min, filter_max);
+        config_.impl.setFilterLimits(filter_min, filter_max);
       }
     }
     if (param.get_name() == "filter_limit_negative") {
       // Check the current value for the negative flag
-      if (impl_.getNegative() != param.as_bool()) {
+      if (config_.impl.getNegative() != param.as_bool()) {
         RCLCPP_DEBUG(
           get_logger(), "Setting the filter negative flag to: %s.",
           param.as_bool() ? "true" : "false");
         // Call the virtual method in the child
-        impl_.setNegative(param.as_bool());
+        config_.impl.setNegative(param.as_bool());
       }
     }
     if (param.get_name() == "keep_organized") {
       // Check the current value for keep_organized
-      if (impl_.getKeepOrganized() != param.as_bool()) {
+      if (config_.impl.getKeepOrganized() != param.as_bool()) {
         RCLCPP_DEBUG(
           get_logger(), "Setting the filter keep_organized value to: %s.",
           param.as_bool() ? "true" : "false");
         // Call the virtual method in the child
-        impl_.setKeepOrganized(param.as_bool());
+        config_.impl.setKeepOrganized(param.as_bool());
       }
     }
+    if (param.get_name() == "filter_field_names") {
+      field_names_param_ = param.as_string_array();
+      update_predicates = true;
+    }
+    if (param.get_name() == "filter_limits_min") {
+      limits_min_param_ = param.as_double_array();
+      update_predicates = true;
+    }
+    if (param.get_name() == "filter_limits_max") {
+      limits_max_param_ = param.as_double_array();
+      update_predicates = true;
+    }
+    if (param.get_name() == "filter_limits_negative") {
+      limits_negative_param_ = param.as_bool_array();
+      update_predicates = true;
+    }
   }
+  if (update_predicates) {
+    updatePredicates();
+  }
+  // Workspaces resolve their ranges again when they see the new snapshot
+  snapshot_.store(config_);
   // TODO(sloretz) constraint validation
-  rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
   return result;
 }
@@ -0,0 +1,618 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "pcl_ros/filters/parallel_for.hpp"
+
+namespace
+{
+typedef sensor_msgs::msg::PointField PointField;
+
+/** \brief Number of points tested together; a block of records and its masks stay in cache. */
+const std::size_t kBlockSize = 256;
+
+/** \brief Indices per parallel chunk of gatherPoints (), which is bound by memory bandwidth. */
+const std::size_t kMinIndicesPerChunk = 65536;
+
+inline bool
+isHostBigEndian()
+{
+  const std::uint16_t one = 1;
+  std::uint8_t first_byte;
+  std::memcpy(&first_byte, &one, 1);
+  return first_byte == 0;
+}
+
+template<typename T>
+inline T
+readValue(const std::uint8_t * ptr)
+{
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+inline void
+writeNaN(std::uint8_t * point, const pcl_ros::XYZOffsets & xyz)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::memcpy(point + xyz.x, &nan, sizeof(float));
+  std::memcpy(point + xyz.y, &nan, sizeof(float));
+  std::memcpy(point + xyz.z, &nan, sizeof(float));
+}
+
+/** \brief Size in bytes of a PointField datatype, 0 if unknown. */
+inline std::size_t
+fieldSize(std::uint8_t datatype)
+{
+  switch (datatype) {
+    case PointField::INT8:
+    case PointField::UINT8:
+      return 1;
+    case PointField::INT16:
+    case PointField::UINT16:
+      return 2;
+    case PointField::INT32:
+    case PointField::UINT32:
+    case PointField::FLOAT32:
+      return 4;
+    case PointField::FLOAT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/** \brief AND the result of a range test on a block of points into \a pass. Like
+  * pcl::PassThrough, both comparisons are false for NaN, which therefore passes positive and
+  * negative tests alike.
+  */
+template<typename T>
+void
+testRange(
+  const std::uint8_t * const * points, std::size_t nr_points, const pcl_ros::FieldRange & range,
+  std::uint8_t * pass)
+{
+  const double limit_min = range.limit_min;
+  const double limit_max = range.limit_max;
+  const bool negative = range.negative;
+  for (std::size_t i = 0; i < nr_points; ++i) {
+    const double value = static_cast<double>(readValue<T>(points[i] + range.offset));
+    const bool outside = (value > limit_max) | (value < limit_min);
+    const bool strictly_inside = (value < limit_max) & (value > limit_min);
+    const bool ok = negative ? !strictly_inside : !outside;
+    pass[i] &= ok;
+  }
+}
+
+void
+testRange(
+  const std::uint8_t * const * points, std::size_t nr_points, const pcl_ros::FieldRange & range,
+  std::uint8_t * pass)
+{
+  // Dispatch once per block, not per point
+  switch (range.datatype) {
+    case PointField::INT8:
+      testRange<std::int8_t>(points, nr_points, range, pass);
+      break;
+    case PointField::UINT8:
+      testRange<std::uint8_t>(points, nr_points, range, pass);
+      break;
+    case PointField::INT16:
+      testRange<std::int16_t>(points, nr_points, range, pass);
+      break;
+    case PointField::UINT16:
+      testRange<std::uint16_t>(points, nr_points, range, pass);
+      break;
+    case PointField::INT32:
+      testRange<std::int32_t>(points, nr_points, range, pass);
+      break;
+    case PointField::UINT32:
+      testRange<std::uint32_t>(points, nr_points, range, pass);
+      break;
+    case PointField::FLOAT64:
+      testRange<double>(points, nr_points, range, pass);
+      break;
+    default:
+      testRange<float>(points, nr_points, range, pass);
+      break;
+  }
+}
+
+/** \brief AND the result of a box test on a block of points into \a pass. NaN points count as
+  * inside of the box, like in pcl::CropBox.
+  */
+void
+testBox(
+  const std::uint8_t * const * points, std::size_t nr_points, const pcl_ros::XYZOffsets & xyz,
+  const pcl_ros::BoxRegion & box, std::uint8_t * pass)
+{
+  for (std::size_t i = 0; i < nr_points; ++i) {
+    const float x = readValue<float>(points[i] + xyz.x);
+    const float y = readValue<float>(points[i] + xyz.y);
+    const float z = readValue<float>(points[i] + xyz.z);
+    const bool outside = (x < box.min_pt[0]) | (y < box.min_pt[1]) | (z < box.min_pt[2]) |
+      (x > box.max_pt[0]) | (y > box.max_pt[1]) | (z > box.max_pt[2]);
+    pass[i] &= outside == box.negative;
+  }
+}
+
+/** \brief AND whether x, y and z are finite on a block of points into \a pass. */
+void
+testFinite(
+  const std::uint8_t * const * points, std::size_t nr_points, const pcl_ros::XYZOffsets & xyz,
+  std::uint8_t * pass)
+{
+  for (std::size_t i = 0; i < nr_points; ++i) {
+    const float x = readValue<float>(points[i] + xyz.x);
+    const float y = readValue<float>(points[i] + xyz.y);
+    const float z = readValue<float>(points[i] + xyz.z);
+    pass[i] &= std::isfinite(x) & std::isfinite(y) & std::isfinite(z);
+  }
+}
+
+/** \brief Run all the tests on a block of points. Unorganized output also drops the points with
+  * non finite x, y or z, like pcl::PassThrough and pcl::CropBox.
+  */
+void
+testBlock(
+  const std::uint8_t * const * points, std::size_t nr_points, const pcl_ros::XYZOffsets & xyz,
+  const std::vector<pcl_ros::FieldRange> & ranges, const std::vector<pcl_ros::BoxRegion> & boxes,
+  bool organized, std::uint8_t * pass)
+{
+  std::memset(pass, 1, nr_points);
+  if (!organized) {
+    testFinite(points, nr_points, xyz, pass);
+  }
+  for (const auto & range : ranges) {
+    testRange(points, nr_points, range, pass);
+  }
+  for (const auto & box : boxes) {
+    testBox(points, nr_points, xyz, box, pass);
+  }
+}
+
+inline void
+setUnorganized(sensor_msgs::msg::PointCloud2 & cloud, std::size_t nr_points)
+{
+  cloud.width = static_cast<std::uint32_t>(nr_points);
+  cloud.height = 1;
+  cloud.row_step = cloud.width * cloud.point_step;
+  cloud.data.resize(nr_points * cloud.point_step);
+}
+
+/** \brief The points the kernels consider: all the points of a cloud, a list of indices, or the
+  * selected points of a mask. Indices out of range are skipped.
+  */
+class Candidates
+{
+public:
+  Candidates(std::size_t nr_points, const std::vector<int> * indices)
+  : nr_points_(nr_points), indices_(indices), mask_(nullptr), position_(0),
+    end_(indices ? indices->size() : nr_points), word_(0), bits_(0) {}
+
+  Candidates(std::size_t nr_points, const pcl_ros::PointMask & mask)
+  : nr_points_(nr_points), indices_(nullptr), mask_(&mask), position_(0), end_(0), word_(0),
+    bits_(mask.words().empty() ? 0 : mask.words()[0]) {}
+
+  /** \brief An upper bound of the number of candidates. */
+  std::size_t
+  maxCount() const
+  {
+    return mask_ ? mask_->count() : end_;
+  }
+
+  /** \brief Get the next candidate, in the order of the indices or in increasing order.
+    * \return false once all the candidates were visited
+    */
+  bool
+  next(std::size_t & index)
+  {
+    if (mask_) {
+      while (!bits_) {
+        if (++word_ >= mask_->words().size()) {
+          return false;
+        }
+        bits_ = mask_->words()[word_];
+      }
+      index = word_ * pcl_ros::PointMask::kWordBits + pcl_ros::detail::lowestBit(bits_);
+      bits_ &= bits_ - 1;
+      // A mask larger than the cloud only has larger indices left
+      return index < nr_points_;
+    }
+    while (position_ < end_) {
+      index = indices_ ? static_cast<std::size_t>((*indices_)[position_]) : position_;
+      ++position_;
+      if (index < nr_points_) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  std::size_t nr_points_;
+  const std::vector<int> * indices_;
+  const pcl_ros::PointMask * mask_;
+  std::size_t position_;
+  std::size_t end_;
+  std::size_t word_;
+  std::uint64_t bits_;
+};
+
+/** \brief Copy the candidates of \a input that pass every test into \a output, see
+  * extractPassing ().
+  */
+std::size_t
+extractCandidates(
+  const sensor_msgs::msg::PointCloud2 & input, const pcl_ros::XYZOffsets & xyz,
+  const std::vector<pcl_ros::FieldRange> & ranges, const std::vector<pcl_ros::BoxRegion> & boxes,
+  Candidates candidates, sensor_msgs::msg::PointCloud2 & output)
+{
+  const std::uint32_t step = input.point_step;
+
+  output.header = input.header;
+  output.fields = input.fields;
+  output.is_bigendian = input.is_bigendian;
+  output.point_step = step;
+  // Non finite points are dropped
+  output.is_dense = true;
+  // resize () keeps the capacity, so a reused output does not reallocate in steady state
+  output.data.resize(candidates.maxCount() * step);
+
+  const std::uint8_t * in = input.data.data();
+  std::uint8_t * out = output.data.data();
+  const std::uint8_t * points[kBlockSize];
+  std::uint8_t pass[kBlockSize];
+  std::size_t nr_out = 0;
+
+  for (;; ) {
+    // Gather the next block of valid candidates
+    std::size_t nr_block = 0;
+    std::size_t cp;
+    while (nr_block < kBlockSize && candidates.next(cp)) {
+      points[nr_block++] = in + cp * step;
+    }
+    if (nr_block == 0) {
+      break;
+    }
+    testBlock(points, nr_block, xyz, ranges, boxes, false, pass);
+    for (std::size_t i = 0; i < nr_block; ++i) {
+      if (pass[i]) {
+        std::memcpy(out + nr_out * step, points[i], step);
+        ++nr_out;
+      }
+    }
+  }
+  setUnorganized(output, nr_out);
+  return nr_out;
+}
+
+/** \brief Call \a f (index) for every candidate of \a input that passes every test, see
+  * selectPassing ().
+  */
+template<typename F>
+void
+selectCandidates(
+  const sensor_msgs::msg::PointCloud2 & input, const pcl_ros::XYZOffsets & xyz,
+  const std::vector<pcl_ros::FieldRange> & ranges, const std::vector<pcl_ros::BoxRegion> & boxes,
+  Candidates candidates, F f)
+{
+  const std::uint8_t * in = input.data.data();
+  const std::uint8_t * points[kBlockSize];
+  std::size_t point_indices[kBlockSize];
+  std::uint8_t pass[kBlockSize];
+
+  for (;; ) {
+    std::size_t nr_block = 0;
+    std::size_t cp;
+    while (nr_block < kBlockSize && candidates.next(cp)) {
+      point_indices[nr_block] = cp;
+      points[nr_block++] = in + cp * input.point_step;
+    }
+    if (nr_block == 0) {
+      break;
+    }
+    testBlock(points, nr_block, xyz, ranges, boxes, false, pass);
+    for (std::size_t i = 0; i < nr_block; ++i) {
+      if (pass[i]) {
+        f(point_indices[i]);
+      }
+    }
+  }
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::isDirectlyAccessible(const sensor_msgs::msg::PointCloud2 & cloud)
+{
+  return cloud.is_bigendian == isHostBigEndian() &&
+         static_cast<std::size_t>(cloud.width) * cloud.height * cloud.point_step ==
+         cloud.data.size();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::getFloatFieldOffset(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & field_name,
+  std::uint32_t & offset)
+{
+  FieldRange range;
+  if (!resolveFieldRange(cloud, field_name, range) || range.datatype != PointField::FLOAT32) {
+    return false;
+  }
+  offset = range.offset;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::getXYZOffsets(const sensor_msgs::msg::PointCloud2 & cloud, XYZOffsets & offsets)
+{
+  return getFloatFieldOffset(cloud, "x", offsets.x) &&
+         getFloatFieldOffset(cloud, "y", offsets.y) &&
+         getFloatFieldOffset(cloud, "z", offsets.z);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::resolveFieldRange(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & field_name,
+  FieldRange & range)
+{
+  for (const auto & field : cloud.fields) {
+    if (field.name != field_name) {
+      continue;
+    }
+    const std::size_t size = fieldSize(field.datatype);
+    if (size == 0 || field.count != 1 || field.offset + size > cloud.point_step) {
+      return false;
+    }
+    range.offset = field.offset;
+    range.datatype = field.datatype;
+    return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::maskFailing(
+  sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(cloud.width) * cloud.height;
+  const std::uint32_t step = cloud.point_step;
+  std::uint8_t * data = cloud.data.data();
+  std::uint8_t * points[kBlockSize];
+  std::uint8_t pass[kBlockSize];
+  std::size_t nr_removed = 0;
+
+  for (std::size_t start = 0; start < nr_points; start += kBlockSize) {
+    const std::size_t nr_block = std::min(kBlockSize, nr_points - start);
+    for (std::size_t i = 0; i < nr_block; ++i) {
+      points[i] = data + (start + i) * step;
+    }
+    testBlock(points, nr_block, xyz, ranges, boxes, true, pass);
+    for (std::size_t i = 0; i < nr_block; ++i) {
+      if (!pass[i]) {
+        writeNaN(points[i], xyz);
+        ++nr_removed;
+      }
+    }
+  }
+  if (nr_removed > 0) {
+    cloud.is_dense = false;
+  }
+  return nr_removed;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::extractPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const std::vector<int> * indices, sensor_msgs::msg::PointCloud2 & output)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(input.width) * input.height;
+  return extractCandidates(input, xyz, ranges, boxes, Candidates(nr_points, indices), output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::extractPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const PointMask & mask, sensor_msgs::msg::PointCloud2 & output)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(input.width) * input.height;
+  return extractCandidates(input, xyz, ranges, boxes, Candidates(nr_points, mask), output);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::selectPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const std::vector<int> * indices, std::vector<int> & selected)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(input.width) * input.height;
+  selected.clear();
+  selectCandidates(
+    input, xyz, ranges, boxes, Candidates(nr_points, indices),
+    [&selected](std::size_t index) {selected.push_back(static_cast<int>(index));});
+  return selected.size();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::selectPassing(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<FieldRange> & ranges, const std::vector<BoxRegion> & boxes,
+  const std::vector<int> * indices, const PointMask * mask, PointMask & selected)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(input.width) * input.height;
+  selected.assign(nr_points, false);
+  std::size_t nr_selected = 0;
+  selectCandidates(
+    input, xyz, ranges, boxes, mask ? Candidates(nr_points, *mask) : Candidates(nr_points, indices),
+    [&selected, &nr_selected](std::size_t index) {
+      // Duplicate indices select their point once
+      if (!selected.test(index)) {
+        selected.set(index);
+        ++nr_selected;
+      }
+    });
+  return nr_selected;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::gatherPoints(
+  const sensor_msgs::msg::PointCloud2 & input, const std::vector<int> & indices,
+  unsigned int num_threads, sensor_msgs::msg::PointCloud2 & output)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(input.width) * input.height;
+  const std::uint32_t step = input.point_step;
+
+  output.header = input.header;
+  output.fields = input.fields;
+  output.is_bigendian = input.is_bigendian;
+  output.point_step = step;
+  output.is_dense = input.is_dense;
+  // resize () keeps the capacity, so a reused output does not reallocate in steady state
+  output.data.resize(indices.size() * step);
+
+  const std::uint8_t * in = input.data.data();
+  std::uint8_t * out = output.data.data();
+  const int * idx = indices.data();
+  const auto valid = [nr_points](int index) {
+      return index >= 0 && static_cast<std::size_t>(index) < nr_points;
+    };
+  // Copy the valid indices of [begin, end) to out + first * step, one memcpy per run of
+  // consecutive indices
+  const auto copy_runs = [&](std::size_t begin, std::size_t end, std::size_t first) {
+      std::size_t nr_out = first;
+      for (std::size_t i = begin; i < end; ) {
+        if (!valid(idx[i])) {
+          ++i;
+          continue;
+        }
+        std::size_t j = i + 1;
+        while (j < end && idx[j] == idx[j - 1] + 1 && valid(idx[j])) {
+          ++j;
+        }
+        std::memcpy(
+          out + nr_out * step, in + static_cast<std::size_t>(idx[i]) * step, (j - i) * step);
+        nr_out += j - i;
+        i = j;
+      }
+      return nr_out;
+    };
+
+  std::size_t nr_out;
+  if (std::all_of(indices.begin(), indices.end(), valid)) {
+    // Every output position is known up front, so chunks can be copied independently
+    pcl_ros::parallelFor(
+      indices.size(), num_threads, kMinIndicesPerChunk,
+      [&copy_runs](std::size_t begin, std::size_t end) {copy_runs(begin, end, begin);});
+    nr_out = indices.size();
+  } else {
+    nr_out = copy_runs(0, indices.size(), 0);
+  }
+  setUnorganized(output, nr_out);
+  return nr_out;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::maskToIndices(const std::vector<std::uint8_t> & keep, std::vector<int> & indices)
+{
+  indices.clear();
+  for (std::size_t cp = 0; cp < keep.size(); ++cp) {
+    if (keep[cp]) {
+      indices.push_back(static_cast<int>(cp));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::maskPoints(
+  sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz,
+  const std::vector<std::uint8_t> & keep)
+{
+  const std::size_t nr_points =
+    std::min(keep.size(), static_cast<std::size_t>(cloud.width) * cloud.height);
+  std::uint8_t * data = cloud.data.data();
+  std::size_t nr_masked = 0;
+  for (std::size_t cp = 0; cp < nr_points; ++cp) {
+    if (!keep[cp]) {
+      writeNaN(data + cp * cloud.point_step, xyz);
+      ++nr_masked;
+    }
+  }
+  return nr_masked;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::compactPoints(
+  sensor_msgs::msg::PointCloud2 & cloud, const std::vector<std::uint8_t> & keep)
+{
+  const std::size_t nr_points =
+    std::min(keep.size(), static_cast<std::size_t>(cloud.width) * cloud.height);
+  const std::uint32_t step = cloud.point_step;
+  std::uint8_t * data = cloud.data.data();
+
+  std::size_t nr_out = 0;
+  for (std::size_t cp = 0; cp < nr_points; ++cp) {
+    if (!keep[cp]) {
+      continue;
+    }
+    // Skip the copy while no point has been removed yet
+    if (nr_out != cp) {
+      std::memcpy(data + nr_out * step, data + cp * step, step);
+    }
+    ++nr_out;
+  }
+  setUnorganized(cloud, nr_out);
+  return nr_out;
+}
@@ -0,0 +1,290 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/point_mask.hpp"
+#include <sensor_msgs/image_encodings.hpp>
+#include <cstring>
+
+namespace
+{
+inline std::size_t
+wordCount(std::size_t size)
+{
+  return (size + pcl_ros::PointMask::kWordBits - 1) / pcl_ros::PointMask::kWordBits;
+}
+
+inline unsigned
+popCount(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+  unsigned count = 0;
+  for (; word; word &= word - 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+}  // namespace
+
+constexpr std::size_t pcl_ros::PointMask::kWordBits;
+constexpr const char * pcl_ros::PointMask::kBitmaskEncoding;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::PointMask::PointMask(std::size_t size, bool value)
+: size_(size), words_(wordCount(size), value ? ~std::uint64_t(0) : 0)
+{
+  clearTail();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::PointMask::PointMask(const std::vector<std::int32_t> & indices, std::size_t size)
+: size_(0)
+{
+  assign(indices, size);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::PointMask::PointMask(const pcl_msgs::msg::PointIndices & indices, std::size_t size)
+: size_(0)
+{
+  assign(indices.indices, size);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PointMask::assign(std::size_t size, bool value)
+{
+  size_ = size;
+  words_.assign(wordCount(size), value ? ~std::uint64_t(0) : 0);
+  clearTail();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::PointMask::assign(const std::vector<std::int32_t> & indices, std::size_t size)
+{
+  size_ = size;
+  // assign () keeps the capacity, so a reused mask does not reallocate in steady state
+  words_.assign(wordCount(size), 0);
+  std::size_t nr_invalid = 0;
+  for (const std::int32_t index : indices) {
+    if (index < 0 || static_cast<std::size_t>(index) >= size) {
+      ++nr_invalid;
+      continue;
+    }
+    set(static_cast<std::size_t>(index));
+  }
+  return nr_invalid;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::PointMask::assign(const sensor_msgs::msg::Image & image)
+{
+  namespace enc = sensor_msgs::image_encodings;
+  const bool bitmask = image.encoding == kBitmaskEncoding;
+  if (!bitmask && image.encoding != enc::MONO8 && image.encoding != enc::TYPE_8UC1) {
+    return false;
+  }
+  // Compute the layout in 64 bits, the fields of the message are not trusted
+  const std::uint64_t width = image.width;
+  const std::uint64_t height = image.height;
+  const std::uint64_t row_bytes = bitmask ? (width + 7) / 8 : width;
+  if (image.step < row_bytes || image.data.size() < height * image.step) {
+    return false;
+  }
+  size_ = static_cast<std::size_t>(width * height);
+  words_.assign(wordCount(size_), 0);
+  std::size_t index = 0;
+  if (bitmask) {
+    for (std::uint64_t v = 0; v < height; ++v, index += width) {
+      const std::uint8_t * row = image.data.data() + v * image.step;
+      for (std::uint64_t b = 0; b < row_bytes; ++b) {
+        std::uint8_t byte = row[b];
+        // The padding bits are not trusted either
+        if (width - 8 * b < 8) {
+          byte &= static_cast<std::uint8_t>((1u << (width - 8 * b)) - 1);
+        }
+        orByte(index + 8 * b, byte);
+      }
+    }
+    return true;
+  }
+  for (std::uint64_t v = 0; v < height; ++v) {
+    const std::uint8_t * row = image.data.data() + v * image.step;
+    for (std::uint64_t u = 0; u < width; ++u, ++index) {
+      if (row[u]) {
+        set(index);
+      }
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PointMask::toIndices(std::vector<std::int32_t> & indices) const
+{
+  indices.resize(count());
+  std::int32_t * out = indices.data();
+  forEachRun(
+    [&out](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        *out++ = static_cast<std::int32_t>(i);
+      }
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PointMask::toPointIndices(pcl_msgs::msg::PointIndices & indices) const
+{
+  toIndices(indices.indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PointMask::toImage(std::uint32_t width, sensor_msgs::msg::Image & image) const
+{
+  image.encoding = kBitmaskEncoding;
+  image.is_bigendian = false;
+  image.width = width;
+  image.height = width ? static_cast<std::uint32_t>(size_ / width) : 0;
+  image.step = (width + 7) / 8;
+  // resize () keeps the capacity, so a reused image does not reallocate in steady state
+  image.data.resize(static_cast<std::size_t>(image.step) * image.height);
+  std::uint8_t * out = image.data.data();
+  std::size_t index = 0;
+  for (std::uint32_t v = 0; v < image.height; ++v, index += width) {
+    for (std::uint32_t b = 0; b < image.step; ++b) {
+      std::uint8_t byte = getByte(index + 8 * b);
+      // The bits past the end of the row belong to the next one
+      if (width - 8 * b < 8) {
+        byte &= static_cast<std::uint8_t>((1u << (width - 8 * b)) - 1);
+      }
+      *out++ = byte;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::PointMask::count() const
+{
+  std::size_t count = 0;
+  for (const std::uint64_t word : words_) {
+    count += popCount(word);
+  }
+  return count;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PointMask::flip()
+{
+  for (std::uint64_t & word : words_) {
+    word = ~word;
+  }
+  clearTail();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::uint8_t
+pcl_ros::PointMask::getByte(std::size_t index) const
+{
+  const std::size_t w = index / kWordBits;
+  const unsigned shift = index % kWordBits;
+  std::uint64_t bits = words_[w] >> shift;
+  if (shift > kWordBits - 8 && w + 1 < words_.size()) {
+    bits |= words_[w + 1] << (kWordBits - shift);
+  }
+  return static_cast<std::uint8_t>(bits);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PointMask::orByte(std::size_t index, std::uint8_t byte)
+{
+  const std::size_t w = index / kWordBits;
+  const unsigned shift = index % kWordBits;
+  words_[w] |= std::uint64_t(byte) << shift;
+  if (shift > kWordBits - 8 && (byte >> (kWordBits - shift))) {
+    words_[w + 1] |= std::uint64_t(byte) >> (kWordBits - shift);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PointMask::clearTail()
+{
+  const std::size_t tail = size_ % kWordBits;
+  if (tail) {
+    words_.back() &= (std::uint64_t(1) << tail) - 1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::extractMasked(
+  const sensor_msgs::msg::PointCloud2 & input, const PointMask & mask,
+  sensor_msgs::msg::PointCloud2 & output)
+{
+  const std::uint32_t step = input.point_step;
+  const std::size_t nr_out = mask.count();
+
+  output.header = input.header;
+  output.fields = input.fields;
+  output.is_bigendian = input.is_bigendian;
+  output.point_step = step;
+  output.is_dense = input.is_dense;
+  // resize () keeps the capacity, so a reused output does not reallocate in steady state
+  output.data.resize(nr_out * step);
+
+  const std::uint8_t * in = input.data.data();
+  std::uint8_t * out = output.data.data();
+  mask.forEachRun(
+    [&](std::size_t begin, std::size_t end) {
+      const std::size_t nr_bytes = (end - begin) * step;
+      std::memcpy(out, in + begin * step, nr_bytes);
+      out += nr_bytes;
+    });
+
+  output.width = static_cast<std::uint32_t>(nr_out);
+  output.height = 1;
+  output.row_step = output.width * step;
+  return nr_out;
+}
@@ -0,0 +1,231 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/point_projection.hpp"
+#include <pcl/sample_consensus/model_types.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "pcl_ros/filters/parallel_for.hpp"
+
+namespace
+{
+/** \brief Number of points projected together; their coordinates stay in cache. */
+const std::size_t kBlockSize = 256;
+
+/** \brief Points per parallel chunk, to keep the thread overhead negligible. */
+const std::size_t kMinPointsPerChunk = 32768;
+
+/** \brief Project a block of points given as separate coordinate arrays. */
+void
+projectBlock(float * x, float * y, float * z, std::size_t n, const pcl_ros::ProjectionModel & m)
+{
+  const float dx = m.direction[0], dy = m.direction[1], dz = m.direction[2];
+  if (m.type == pcl_ros::ProjectionModel::Plane) {
+    // p' = p - (n.p + d) n
+    for (std::size_t i = 0; i < n; ++i) {
+      const float t = dx * x[i] + dy * y[i] + dz * z[i] + m.scale;
+      x[i] -= t * dx;
+      y[i] -= t * dy;
+      z[i] -= t * dz;
+    }
+  } else {
+    // p' = p0 + ((p - p0).v / v.v) v
+    const float px = m.point[0], py = m.point[1], pz = m.point[2];
+    for (std::size_t i = 0; i < n; ++i) {
+      const float t = ((x[i] - px) * dx + (y[i] - py) * dy + (z[i] - pz) * dz) * m.scale;
+      x[i] = px + t * dx;
+      y[i] = py + t * dy;
+      z[i] = pz + t * dz;
+    }
+  }
+}
+
+/** \brief Project the points at \a points in place, in blocks. */
+void
+projectRecords(
+  std::uint8_t * const * points, std::size_t n, const pcl_ros::XYZOffsets & xyz,
+  const pcl_ros::ProjectionModel & model)
+{
+  float x[kBlockSize], y[kBlockSize], z[kBlockSize];
+  for (std::size_t i = 0; i < n; ++i) {
+    std::memcpy(&x[i], points[i] + xyz.x, sizeof(float));
+    std::memcpy(&y[i], points[i] + xyz.y, sizeof(float));
+    std::memcpy(&z[i], points[i] + xyz.z, sizeof(float));
+  }
+  projectBlock(x, y, z, n, model);
+  for (std::size_t i = 0; i < n; ++i) {
+    std::memcpy(points[i] + xyz.x, &x[i], sizeof(float));
+    std::memcpy(points[i] + xyz.y, &y[i], sizeof(float));
+    std::memcpy(points[i] + xyz.z, &z[i], sizeof(float));
+  }
+}
+
+/** \brief The fields of pcl::PointXYZ, built once. */
+const std::vector<sensor_msgs::msg::PointField> &
+xyzFields()
+{
+  static const std::vector<sensor_msgs::msg::PointField> fields = []() {
+      std::vector<sensor_msgs::msg::PointField> f(3);
+      const char * names[3] = {"x", "y", "z"};
+      for (std::size_t i = 0; i < 3; ++i) {
+        f[i].name = names[i];
+        f[i].offset = static_cast<std::uint32_t>(i * sizeof(float));
+        f[i].datatype = sensor_msgs::msg::PointField::FLOAT32;
+        f[i].count = 1;
+      }
+      return f;
+    }();
+  return fields;
+}
+
+/** \brief Size of a pcl::PointXYZ record, which is padded to 16 bytes. */
+const std::uint32_t kXYZPointStep = 16;
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::makeProjectionModel(
+  int model_type, const std::vector<float> & values, ProjectionModel & model)
+{
+  if (model_type == pcl::SACMODEL_PLANE && values.size() == 4) {
+    // Like pcl::SampleConsensusModelPlane, the normal is normalized but d is used as given
+    const float norm = std::sqrt(values[0] * values[0] + values[1] * values[1] +
+        values[2] * values[2]);
+    if (!(norm > 0.0f)) {
+      return false;
+    }
+    model.type = ProjectionModel::Plane;
+    for (int i = 0; i < 3; ++i) {
+      model.point[i] = 0.0f;
+      model.direction[i] = values[i] / norm;
+    }
+    model.scale = values[3];
+    return true;
+  }
+  if (model_type == pcl::SACMODEL_LINE && values.size() == 6) {
+    const float sq_norm = values[3] * values[3] + values[4] * values[4] + values[5] * values[5];
+    if (!(sq_norm > 0.0f)) {
+      return false;
+    }
+    model.type = ProjectionModel::Line;
+    for (int i = 0; i < 3; ++i) {
+      model.point[i] = values[i];
+      model.direction[i] = values[3 + i];
+    }
+    model.scale = 1.0f / sq_norm;
+    return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::projectPoints(
+  sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, const ProjectionModel & model,
+  const std::vector<int> * indices, unsigned int num_threads)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(cloud.width) * cloud.height;
+  const std::size_t nr_candidates = indices ? indices->size() : nr_points;
+  const std::uint32_t step = cloud.point_step;
+  std::uint8_t * data = cloud.data.data();
+
+  // Duplicate indices would let two threads write the same point
+  const bool unique = !indices || std::adjacent_find(
+    indices->begin(), indices->end(), [](int a, int b) {return a >= b;}) == indices->end();
+
+  pcl_ros::parallelFor(
+    nr_candidates, unique ? num_threads : 1u, kMinPointsPerChunk,
+    [&](std::size_t begin, std::size_t end) {
+      std::uint8_t * points[kBlockSize];
+      for (std::size_t start = begin; start < end; ) {
+        std::size_t nr_block = 0;
+        for (; start < end && nr_block < kBlockSize; ++start) {
+          const std::size_t cp = indices ? static_cast<std::size_t>((*indices)[start]) : start;
+          if (cp < nr_points) {
+            points[nr_block++] = data + cp * step;
+          }
+        }
+        projectRecords(points, nr_block, xyz, model);
+      }
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::extractXYZ(
+  const sensor_msgs::msg::PointCloud2 & input, const XYZOffsets & xyz,
+  const std::vector<int> * indices, sensor_msgs::msg::PointCloud2 & output)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(input.width) * input.height;
+  const std::size_t nr_candidates = indices ? indices->size() : nr_points;
+
+  output.header = input.header;
+  output.fields = xyzFields();
+  output.is_bigendian = input.is_bigendian;
+  output.point_step = kXYZPointStep;
+  output.is_dense = input.is_dense;
+  // resize () keeps the capacity, so a reused output does not reallocate in steady state
+  output.data.resize(nr_candidates * kXYZPointStep);
+
+  const std::uint8_t * in = input.data.data();
+  std::uint8_t * out = output.data.data();
+  std::size_t nr_out = 0;
+  for (std::size_t i = 0; i < nr_candidates; ++i) {
+    const std::size_t cp = indices ? static_cast<std::size_t>((*indices)[i]) : i;
+    if (cp >= nr_points) {
+      continue;
+    }
+    const std::uint8_t * point = in + cp * input.point_step;
+    std::uint8_t * record = out + nr_out * kXYZPointStep;
+    std::memcpy(record, point + xyz.x, sizeof(float));
+    std::memcpy(record + sizeof(float), point + xyz.y, sizeof(float));
+    std::memcpy(record + 2 * sizeof(float), point + xyz.z, sizeof(float));
+    // Padding, like pcl::PointXYZ::data[3]
+    const float one = 1.0f;
+    std::memcpy(record + 3 * sizeof(float), &one, sizeof(float));
+    ++nr_out;
+  }
+
+  if (indices) {
+    output.width = static_cast<std::uint32_t>(nr_out);
+    output.height = 1;
+  } else {
+    output.width = input.width;
+    output.height = input.height;
+  }
+  output.row_step = output.width * kXYZPointStep;
+  output.data.resize(nr_out * kXYZPointStep);
+}
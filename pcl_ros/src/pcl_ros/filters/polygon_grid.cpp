@@ -0,0 +1,274 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/polygon_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "pcl_ros/filters/parallel_for.hpp"
+
+namespace
+{
+/** \brief Average number of cells per edge, which bounds the edges tested per query. */
+const std::size_t kCellsPerEdge = 4;
+
+/** \brief Bounds of the grid size, in cells. */
+const std::size_t kMinCells = 64;
+const std::size_t kMaxCells = 1 << 20;
+
+/** \brief Position of the reference point inside of a cell, in cell sizes. Off center, so that
+  * it does not fall on the edges of axis aligned or symmetric polygons.
+  */
+const double kReferenceX = 0.5 + 0.0123;
+const double kReferenceY = 0.5 + 0.0071;
+
+/** \brief Points per parallel chunk, to keep the thread overhead negligible. */
+const std::size_t kMinPointsPerChunk = 16384;
+
+/** \brief Twice the signed area of the triangle (a, b, c). */
+inline double
+orient(double ax, double ay, double bx, double by, double cx, double cy)
+{
+  return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::PolygonGrid::assign(const std::vector<double> & vertices)
+{
+  const std::size_t nr_vertices = vertices.size() / 2;
+  if (nr_vertices < 3) {
+    return false;
+  }
+
+  // Validate before touching the grid, which is kept as is on failure
+  double min_x = vertices[0], max_x = vertices[0];
+  double min_y = vertices[1], max_y = vertices[1];
+  for (std::size_t v = 0; v < nr_vertices; ++v) {
+    if (!std::isfinite(vertices[2 * v]) || !std::isfinite(vertices[2 * v + 1])) {
+      return false;
+    }
+    min_x = std::min(min_x, vertices[2 * v]);
+    max_x = std::max(max_x, vertices[2 * v]);
+    min_y = std::min(min_y, vertices[2 * v + 1]);
+    max_y = std::max(max_y, vertices[2 * v + 1]);
+  }
+  // The extent of finite vertices can still overflow
+  if (!std::isfinite(max_x - min_x) || !std::isfinite(max_y - min_y)) {
+    return false;
+  }
+
+  min_x_ = min_x;
+  max_x_ = max_x;
+  min_y_ = min_y;
+  max_y_ = max_y;
+  edges_.clear();
+  for (std::size_t v = 0; v < nr_vertices; ++v) {
+    const std::size_t w = (v + 1) % nr_vertices;
+    edges_.push_back(Edge{vertices[2 * v], vertices[2 * v + 1], vertices[2 * w],
+        vertices[2 * w + 1]});
+  }
+
+  // Roughly square cells, about kCellsPerEdge per edge
+  const double width = std::max(max_x_ - min_x_, 1e-6);
+  const double height = std::max(max_y_ - min_y_, 1e-6);
+  const double nr_cells = static_cast<double>(
+    std::min(kMaxCells, std::max(kMinCells, kCellsPerEdge * edges_.size())));
+  const double side = std::sqrt(width * height / nr_cells);
+  nx_ = std::max<std::size_t>(1, std::min<std::size_t>(4096, std::ceil(width / side)));
+  ny_ = std::max<std::size_t>(1, std::min<std::size_t>(4096, std::ceil(height / side)));
+  cell_x_ = width / nx_;
+  cell_y_ = height / ny_;
+  inv_cell_x_ = 1.0 / cell_x_;
+  inv_cell_y_ = 1.0 / cell_y_;
+
+  // Reference points, row by row: a point is inside if an odd number of edges cross the
+  // horizontal ray to its left
+  reference_inside_.assign(nx_ * ny_, 0);
+  std::vector<double> crossings;
+  for (std::size_t iy = 0; iy < ny_; ++iy) {
+    double rx, ry;
+    referencePoint(0, iy, rx, ry);
+    crossings.clear();
+    for (const Edge & e : edges_) {
+      if ((e.y0 > ry) != (e.y1 > ry)) {
+        crossings.push_back(e.x0 + (ry - e.y0) * (e.x1 - e.x0) / (e.y1 - e.y0));
+      }
+    }
+    std::sort(crossings.begin(), crossings.end());
+    std::size_t nr_left = 0;
+    for (std::size_t ix = 0; ix < nx_; ++ix) {
+      referencePoint(ix, iy, rx, ry);
+      while (nr_left < crossings.size() && crossings[nr_left] < rx) {
+        ++nr_left;
+      }
+      reference_inside_[iy * nx_ + ix] = nr_left & 1u;
+    }
+  }
+
+  // Edges crossing each cell: the cells of the bounding box of the edge that the line of the
+  // edge separates, in two passes to store them contiguously
+  std::vector<std::uint32_t> counts(nx_ * ny_ + 1, 0);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (std::uint32_t id = 0; id < edges_.size(); ++id) {
+      const Edge & e = edges_[id];
+      const std::size_t ix0 = std::min<std::size_t>(
+        nx_ - 1, static_cast<std::size_t>((std::min(e.x0, e.x1) - min_x_) * inv_cell_x_));
+      const std::size_t ix1 = std::min<std::size_t>(
+        nx_ - 1, static_cast<std::size_t>((std::max(e.x0, e.x1) - min_x_) * inv_cell_x_));
+      const std::size_t iy0 = std::min<std::size_t>(
+        ny_ - 1, static_cast<std::size_t>((std::min(e.y0, e.y1) - min_y_) * inv_cell_y_));
+      const std::size_t iy1 = std::min<std::size_t>(
+        ny_ - 1, static_cast<std::size_t>((std::max(e.y0, e.y1) - min_y_) * inv_cell_y_));
+      for (std::size_t iy = iy0; iy <= iy1; ++iy) {
+        for (std::size_t ix = ix0; ix <= ix1; ++ix) {
+          // The line crosses the cell unless all corners are strictly on one side
+          const double cx0 = min_x_ + ix * cell_x_, cx1 = cx0 + cell_x_;
+          const double cy0 = min_y_ + iy * cell_y_, cy1 = cy0 + cell_y_;
+          const double o[4] = {
+            orient(e.x0, e.y0, e.x1, e.y1, cx0, cy0), orient(e.x0, e.y0, e.x1, e.y1, cx1, cy0),
+            orient(e.x0, e.y0, e.x1, e.y1, cx0, cy1), orient(e.x0, e.y0, e.x1, e.y1, cx1, cy1)};
+          const bool all_pos = o[0] > 0 && o[1] > 0 && o[2] > 0 && o[3] > 0;
+          const bool all_neg = o[0] < 0 && o[1] < 0 && o[2] < 0 && o[3] < 0;
+          if (all_pos || all_neg) {
+            continue;
+          }
+          const std::size_t cell = iy * nx_ + ix;
+          if (pass == 0) {
+            ++counts[cell + 1];
+          } else {
+            cell_edges_[cell_begin_[cell] + counts[cell]++] = id;
+          }
+        }
+      }
+    }
+    if (pass == 0) {
+      cell_begin_.assign(counts.size(), 0);
+      for (std::size_t c = 1; c < counts.size(); ++c) {
+        cell_begin_[c] = cell_begin_[c - 1] + counts[c];
+      }
+      cell_edges_.resize(cell_begin_.back());
+      std::fill(counts.begin(), counts.end(), 0);
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::PolygonGrid::referencePoint(
+  std::size_t ix, std::size_t iy, double & x, double & y) const
+{
+  x = min_x_ + (ix + kReferenceX) * cell_x_;
+  y = min_y_ + (iy + kReferenceY) * cell_y_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::PolygonGrid::contains(float x, float y) const
+{
+  // Also rejects NaN
+  if (!(x >= min_x_ && x <= max_x_ && y >= min_y_ && y <= max_y_)) {
+    return false;
+  }
+  const std::size_t ix = std::min<std::size_t>(
+    nx_ - 1, static_cast<std::size_t>((x - min_x_) * inv_cell_x_));
+  const std::size_t iy = std::min<std::size_t>(
+    ny_ - 1, static_cast<std::size_t>((y - min_y_) * inv_cell_y_));
+  const std::size_t cell = iy * nx_ + ix;
+  bool inside = reference_inside_[cell];
+  if (cell_begin_[cell] == cell_begin_[cell + 1]) {
+    return inside;
+  }
+
+  // Flip for every edge that crosses the segment from the reference point to (x, y)
+  double rx, ry;
+  referencePoint(ix, iy, rx, ry);
+  for (std::uint32_t i = cell_begin_[cell]; i < cell_begin_[cell + 1]; ++i) {
+    const Edge & e = edges_[cell_edges_[i]];
+    const double o1 = orient(e.x0, e.y0, e.x1, e.y1, rx, ry);
+    const double o2 = orient(e.x0, e.y0, e.x1, e.y1, x, y);
+    const double o3 = orient(rx, ry, x, y, e.x0, e.y0);
+    const double o4 = orient(rx, ry, x, y, e.x1, e.y1);
+    if (((o1 > 0) != (o2 > 0)) && ((o3 > 0) != (o4 > 0))) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::markInPrism(
+  const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz, const PolygonGrid & polygon,
+  double min_z, double max_z, bool negative, const Eigen::Matrix4f * transform,
+  const std::vector<int> * indices, unsigned int num_threads, std::vector<std::uint8_t> & keep)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(cloud.width) * cloud.height;
+  const std::size_t nr_candidates = indices ? indices->size() : nr_points;
+  const std::uint8_t * data = cloud.data.data();
+  keep.resize(nr_candidates);
+
+  pcl_ros::parallelFor(
+    nr_candidates, num_threads, kMinPointsPerChunk,
+    [&](std::size_t begin, std::size_t end) {
+      for (std::size_t k = begin; k < end; ++k) {
+        const std::size_t cp = indices ? static_cast<std::size_t>((*indices)[k]) : k;
+        if (cp >= nr_points) {
+          keep[k] = 0;
+          continue;
+        }
+        const std::uint8_t * point = data + cp * cloud.point_step;
+        float x, y, z;
+        std::memcpy(&x, point + xyz.x, sizeof(float));
+        std::memcpy(&y, point + xyz.y, sizeof(float));
+        std::memcpy(&z, point + xyz.z, sizeof(float));
+        if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z)) {
+          keep[k] = 0;
+          continue;
+        }
+        if (transform) {
+          const Eigen::Vector3f p = transform->topLeftCorner<3, 3>() * Eigen::Vector3f(x, y, z) +
+            transform->topRightCorner<3, 1>();
+          x = p.x();
+          y = p.y();
+          z = p.z();
+        }
+        const bool inside = z >= min_z && z <= max_z && polygon.contains(x, y);
+        keep[k] = inside != negative;
+      }
+    });
+}
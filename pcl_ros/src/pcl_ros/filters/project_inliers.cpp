@@ -37,10 +37,15 @@
 
 #include "pcl_ros/filters/project_inliers.hpp"
 #include <pcl/io/io.h>
+#include <utility>
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+#include "pcl_ros/filters/point_projection.hpp"
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 pcl_ros::ProjectInliers::ProjectInliers(const rclcpp::NodeOptions & options)
-: Filter("ProjectInliersNode", options), model_()
+: Filter("ProjectInliersNode", options), model_(), num_threads_(0),
+  transient_local_model_(false)
 {
   // ---[ Mandatory parameters
   // The type of model to use (user given parameter).
@@ -61,7 +66,36 @@ pcl_ros::ProjectInliers::ProjectInliers(const rclcpp::NodeOptions & options)
   declare_parameter("copy_all_fields", rclcpp::ParameterValue(true));
   bool copy_all_fields = get_parameter("copy_all_fields").as_bool();
 
-  pub_output_ = create_publisher<PointCloud2>("output", max_queue_size_);
+  rcl_interfaces::msg::ParameterDescriptor num_threads_desc;
+  num_threads_desc.name = "num_threads";
+  num_threads_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  num_threads_desc.description =
+    "The number of threads projecting large clouds on planes and lines, 0 to use all cores.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 256;
+    num_threads_desc.integer_range.push_back(int_range);
+  }
+  num_threads_desc.read_only = true;
+  num_threads_ = declare_parameter(num_threads_desc.name, 0, num_threads_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor transient_local_model_desc;
+  transient_local_model_desc.name = "transient_local_model";
+  transient_local_model_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  transient_local_model_desc.description =
+    "Apply the most recent model from a transient local model topic to every cloud, instead of "
+    "synchronizing it with the clouds. The indices are latched too if transient_local_indices "
+    "is set.";
+  transient_local_model_desc.read_only = true;
+  transient_local_model_ =
+    declare_parameter(transient_local_model_desc.name, false, transient_local_model_desc);
+  if (data_callback_group_->type() == rclcpp::CallbackGroupType::Reentrant) {
+    // The model is handed to filter () through model_
+    throw std::runtime_error("ProjectInliers cannot be used with a reentrant data_callback_group");
+  }
+
+  pub_output_ = createOutputPublisher<PointCloud2>("output");
 
   RCLCPP_DEBUG(
     this->get_logger(),
@@ -76,23 +110,51 @@ pcl_ros::ProjectInliers::ProjectInliers(const rclcpp::NodeOptions & options)
   impl_.setCopyAllFields(copy_all_fields);
   impl_.setCopyAllData(copy_all_data);
 
-  // TODO(daisukes): lazy subscription after rclcpp#2060
-  subscribe();
+  lazySubscribe();
 }
 
 void
 pcl_ros::ProjectInliers::filter(
-  const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
   PointCloud2 & output)
 {
+  // Project on planes and lines directly on the PointCloud2 buffers
+  XYZOffsets xyz;
+  ProjectionModel model;
+  if (indices && !indices->empty() && isDirectlyAccessible(*input) &&
+    getXYZOffsets(*input, xyz) && makeProjectionModel(impl_.getModelType(), model_->values, model))
+  {
+    const unsigned int num_threads = resolveNumThreads(num_threads_);
+    if (impl_.getCopyAllFields() && impl_.getCopyAllData()) {
+      output = *input;
+      projectPoints(output, xyz, model, indices.get(), num_threads);
+    } else if (impl_.getCopyAllFields()) {
+      gatherPoints(*input, *indices, num_threads, output);
+      projectPoints(output, xyz, model, nullptr, num_threads);
+    } else {
+      // Only x, y and z, in the layout of pcl::PointXYZ
+      const XYZOffsets xyz_out{0, sizeof(float), 2 * sizeof(float)};
+      if (impl_.getCopyAllData()) {
+        extractXYZ(*input, xyz, nullptr, output);
+        projectPoints(output, xyz_out, model, indices.get(), num_threads);
+      } else {
+        extractXYZ(*input, xyz, indices.get(), output);
+        projectPoints(output, xyz_out, model, nullptr, num_threads);
+      }
+    }
+    return;
+  }
+
   pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
   pcl_conversions::toPCL(*(input), *(pcl_input));
   impl_.setInputCloud(pcl_input);
-  impl_.setIndices(indices);
+  impl_.setIndices(copyIndices(indices));
   pcl::ModelCoefficients::Ptr pcl_model(new pcl::ModelCoefficients);
   pcl_conversions::toPCL(*(model_), *(pcl_model));
   impl_.setModelCoefficients(pcl_model);
   pcl::PCLPointCloud2 pcl_output;
+  // PCL resizes the buffer acquired for the output, moveFromPCL swaps it back
+  pcl_output.data = std::move(output.data);
   impl_.filter(pcl_output);
   pcl_conversions::moveFromPCL(pcl_output, output);
 }
@@ -113,9 +175,60 @@ pcl_ros::ProjectInliers::subscribe()
   auto sensor_qos_profile = rclcpp::QoS(
     rclcpp::KeepLast(max_queue_size_),
     rmw_qos_profile_sensor_data).get_rmw_qos_profile();
-  sub_input_filter_.subscribe(this, "input", sensor_qos_profile);
-  sub_indices_filter_.subscribe(this, "indices", qos_profile);
-  sub_model_.subscribe(this, "model", qos_profile);
+
+  if (transient_local_model_) {
+    // Keep the most recent model, and indices, instead of synchronizing them with the clouds
+    auto latched_qos = rclcpp::QoS(rclcpp::KeepLast(1)).reliable().transient_local();
+    sub_model_latched_ = create_subscription<ModelCoefficients>(
+      "model", latched_qos, [this](ModelCoefficientsConstPtr model) {
+        std::lock_guard<std::mutex> lock(latched_mutex_);
+        latched_model_ = model;
+      }, inputSubscriptionOptions());
+
+    if (transient_local_indices_) {
+      sub_indices_latched_ = create_subscription<PointIndices>(
+        "indices", latched_qos, [this](PointIndicesConstPtr indices) {
+          std::lock_guard<std::mutex> lock(latched_mutex_);
+          latched_indices_ = indices;
+        }, inputSubscriptionOptions());
+      sub_input_ = create_subscription<PointCloud2>(
+        "input", rclcpp::SensorDataQoS(rclcpp::KeepLast(inputQueueSize())),
+        [this](PointCloud2::ConstSharedPtr cloud) {
+          takeLatest(*sub_input_, cloud);
+          input_latched_callback(cloud);
+        }, inputSubscriptionOptions());
+      return;
+    }
+
+    sub_input_filter_.subscribe(this, "input", sensor_qos_profile, inputSubscriptionOptions());
+    sub_indices_filter_.subscribe(this, "indices", qos_profile, inputSubscriptionOptions());
+    if (approximate_sync_) {
+      sync_input_indices_latched_a_ = std::make_shared<
+        message_filters::Synchronizer<
+          message_filters::sync_policies::ApproximateTime<PointCloud2, PointIndices>>>(
+        max_queue_size_);
+      sync_input_indices_latched_a_->connectInput(sub_input_filter_, sub_indices_filter_);
+      sync_input_indices_latched_a_->registerCallback(
+        std::bind(
+          &ProjectInliers::input_indices_latched_callback, this,
+          std::placeholders::_1, std::placeholders::_2));
+    } else {
+      sync_input_indices_latched_e_ = std::make_shared<
+        message_filters::Synchronizer<
+          message_filters::sync_policies::ExactTime<PointCloud2, PointIndices>>>(
+        max_queue_size_);
+      sync_input_indices_latched_e_->connectInput(sub_input_filter_, sub_indices_filter_);
+      sync_input_indices_latched_e_->registerCallback(
+        std::bind(
+          &ProjectInliers::input_indices_latched_callback, this,
+          std::placeholders::_1, std::placeholders::_2));
+    }
+    return;
+  }
+
+  sub_input_filter_.subscribe(this, "input", sensor_qos_profile, inputSubscriptionOptions());
+  sub_indices_filter_.subscribe(this, "indices", qos_profile, inputSubscriptionOptions());
+  sub_model_.subscribe(this, "model", qos_profile, inputSubscriptionOptions());
 
   if (approximate_sync_) {
     sync_input_indices_model_a_ = std::make_shared<
@@ -148,6 +261,11 @@ pcl_ros::ProjectInliers::unsubscribe()
   TODO : implement use_indices_
   if (use_indices_)
   {*/
+  if (transient_local_model_) {
+    sub_model_latched_.reset();
+    sub_indices_latched_.reset();
+    sub_input_.reset();
+  }
   sub_input_filter_.unsubscribe();
   sub_indices_filter_.unsubscribe();
   sub_model_.unsubscribe();
@@ -169,6 +287,9 @@ pcl_ros::ProjectInliers::input_indices_model_callback(
       this->get_logger(), "[%s::input_indices_model_callback] Invalid input!", this->get_name());
     return;
   }
+  if (!acceptInput(cloud->header)) {
+    return;
+  }
 
   RCLCPP_DEBUG(
     this->get_logger(),
@@ -182,15 +303,60 @@ pcl_ros::ProjectInliers::input_indices_model_callback(
     indices->header.frame_id.c_str(), "inliers", model->values.size(),
     model->header.stamp.sec, model->header.stamp.nanosec, model->header.frame_id.c_str(), "model");
 
-  tf_input_orig_frame_ = cloud->header.frame_id;
-
-  IndicesPtr vindices;
+  // Share the indices of the message rather than copying them, latched indices are reused for
+  // every cloud
+  IndicesConstPtr vindices;
   if (indices) {
-    vindices.reset(new std::vector<int>(indices->indices));
+    vindices = IndicesConstPtr(indices, &indices->indices);
   }
 
+  const PointCloud2::ConstSharedPtr input = projectInput(cloud);
+  if (!input) {
+    return;
+  }
   model_ = model;
-  computePublish(cloud, vindices);
+  computePublish(input, vindices, cloud->header.frame_id);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::ProjectInliers::input_indices_latched_callback(
+  const PointCloud2::ConstSharedPtr & cloud,
+  const PointIndicesConstPtr & indices)
+{
+  ModelCoefficientsConstPtr model;
+  {
+    std::lock_guard<std::mutex> lock(latched_mutex_);
+    model = latched_model_;
+  }
+  if (!model) {
+    RCLCPP_WARN_THROTTLE(
+      this->get_logger(), *this->get_clock(), 5000,
+      "[%s::input_indices_latched_callback] No model received yet!", this->get_name());
+    return;
+  }
+  input_indices_model_callback(cloud, indices, model);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::ProjectInliers::input_latched_callback(const PointCloud2::ConstSharedPtr & cloud)
+{
+  ModelCoefficientsConstPtr model;
+  PointIndicesConstPtr indices;
+  {
+    std::lock_guard<std::mutex> lock(latched_mutex_);
+    model = latched_model_;
+    indices = latched_indices_;
+  }
+  if (!model || !indices) {
+    RCLCPP_WARN_THROTTLE(
+      this->get_logger(), *this->get_clock(), 5000,
+      "[%s::input_latched_callback] No %s received yet!", this->get_name(),
+      model ? "indices" : "model");
+    return;
+  }
+  input_indices_model_callback(cloud, indices, model);
 }
 
 #include "rclcpp_components/register_node_macro.hpp"
@@ -36,6 +36,15 @@
  */
 
 #include "pcl_ros/filters/radius_outlier_removal.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "pcl_ros/filters/outlier_masks.hpp"
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
+#include "pcl_ros/filters/voxel_hash.hpp"
 
 pcl_ros::RadiusOutlierRemoval::RadiusOutlierRemoval(const rclcpp::NodeOptions & options)
 : Filter("RadiusOutlierRemovalNode", options)
@@ -57,7 +66,7 @@ pcl_ros::RadiusOutlierRemoval::RadiusOutlierRemoval(const rclcpp::NodeOptions &
   radius_search_desc.name = "radius_search";
   radius_search_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
   radius_search_desc.description =
-    "Radius of the sphere that will determine which points are neighbors.";
+    "Radius of the sphere that will determine which points are neighbors, greater than 0.";
   {
     rcl_interfaces::msg::FloatingPointRange float_range;
     float_range.from_value = 0.0;
@@ -66,7 +75,39 @@ pcl_ros::RadiusOutlierRemoval::RadiusOutlierRemoval(const rclcpp::NodeOptions &
   }
   declare_parameter(radius_search_desc.name, rclcpp::ParameterValue(0.1), radius_search_desc);
 
+  rcl_interfaces::msg::ParameterDescriptor engine_desc;
+  engine_desc.name = "engine";
+  engine_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  engine_desc.description =
+    "How neighbors are counted: kdtree (PCL), voxel_hash (exact, on a grid of radius_search "
+    "cells) or cell_count (points of the 27 neighboring cells, only removes certain outliers).";
+  declare_parameter(engine_desc.name, rclcpp::ParameterValue("kdtree"), engine_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor num_threads_desc;
+  num_threads_desc.name = "num_threads";
+  num_threads_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  num_threads_desc.description =
+    "The number of threads of the voxel_hash and cell_count engines, 0 to use all cores.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 256;
+    num_threads_desc.integer_range.push_back(int_range);
+  }
+  declare_parameter(num_threads_desc.name, rclcpp::ParameterValue(0), num_threads_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor shared_search_desc;
+  shared_search_desc.name = "shared_search";
+  shared_search_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  shared_search_desc.description =
+    "Share the search tree built for each cloud with the other components of this process that "
+    "filter the same cloud. Ignored when indices are given or with the grid engines.";
+  declare_parameter(shared_search_desc.name, rclcpp::ParameterValue(false), shared_search_desc);
+
   const std::vector<std::string> param_names {
+    engine_desc.name,
+    num_threads_desc.name,
+    shared_search_desc.name,
     min_neighbors_desc.name,
     radius_search_desc.name,
   };
@@ -77,27 +118,106 @@ pcl_ros::RadiusOutlierRemoval::RadiusOutlierRemoval(const rclcpp::NodeOptions &
       &RadiusOutlierRemoval::config_callback, this,
       std::placeholders::_1));
 
-  config_callback(get_parameters(param_names));
+  auto result = config_callback(get_parameters(param_names));
+  if (!result.successful) {
+    throw std::runtime_error(result.reason);
+  }
 
-  // TODO(daisukes): lazy subscription after rclcpp#2060
-  subscribe();
+  lazySubscribe();
 }
 
 void
 pcl_ros::RadiusOutlierRemoval::filter(
-  const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
   PointCloud2 & output)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // The latest configuration and a private workspace, parameter updates do not wait for the filter
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  // The shared tree is built on the whole cloud, while PCL only searches within the indices
+  const bool direct = config->engine != Engine::KdTree || (config->shared_search && !indices);
+  if (direct && markDirect(config, *workspace, *input, indices)) {
+    output = *input;
+    compactPoints(output, workspace->keep);
+    return;
+  }
+  if (config->engine != Engine::KdTree) {
+    RCLCPP_WARN_ONCE(
+      get_logger(), "The grid engines need FLOAT32 x, y and z fields in host byte order, "
+      "falling back to the kdtree engine.");
+  }
+  Impl & impl = workspace->impl.get(std::shared_ptr<const Impl>(config, &config->impl));
   pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
   pcl_conversions::toPCL(*(input), *(pcl_input));
-  impl_.setInputCloud(pcl_input);
-  impl_.setIndices(indices);
+  impl.setInputCloud(pcl_input);
+  impl.setIndices(copyIndices(indices));
   pcl::PCLPointCloud2 pcl_output;
-  impl_.filter(pcl_output);
+  // PCL resizes the buffer acquired for the output, moveFromPCL swaps it back
+  pcl_output.data = std::move(output.data);
+  impl.filter(pcl_output);
   pcl_conversions::moveFromPCL(pcl_output, output);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::RadiusOutlierRemoval::filterIndices(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  std::vector<int> & output_indices)
+{
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  if (!markDirect(config, *workspace, *input, indices)) {
+    return false;
+  }
+  maskToIndices(workspace->keep, output_indices);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::RadiusOutlierRemoval::markDirect(
+  const ConfigConstPtr & config, Workspace & workspace,
+  const PointCloud2 & input, const IndicesConstPtr & indices)
+{
+  XYZOffsets xyz;
+  if ((config->engine == Engine::KdTree && indices) || !isDirectlyAccessible(input) ||
+    !getXYZOffsets(input, xyz))
+  {
+    return false;
+  }
+
+  // Like PCL, only the indexed points are tested and returned
+  std::vector<std::uint8_t> & keep = workspace.keep;
+  keep.assign(static_cast<std::size_t>(input.width) * input.height, indices ? 0 : 1);
+  if (indices) {
+    for (const int index : *indices) {
+      if (index >= 0 && static_cast<std::size_t>(index) < keep.size()) {
+        keep[index] = 1;
+      }
+    }
+  }
+  // The getters of pcl::RadiusOutlierRemoval are not const, read them from the private copy
+  Impl & impl = workspace.impl.get(std::shared_ptr<const Impl>(config, &config->impl));
+  if (config->engine != Engine::KdTree) {
+    markRadiusOutliersVoxelHash(
+      input, xyz, indices.get(), impl.getRadiusSearch(), impl.getMinNeighborsInRadius(),
+      impl.getNegative(), config->engine == Engine::CellCount,
+      resolveNumThreads(config->num_threads), keep);
+  } else if (config->shared_search) {
+    const SearchCache::EntryConstPtr entry = SearchCache::instance().get(input);
+    markRadiusOutliers(
+      *entry->search, *entry->cloud, impl.getRadiusSearch(), impl.getMinNeighborsInRadius(),
+      impl.getNegative(), nullptr, keep);
+  } else {
+    pcl::fromROSMsg(input, *workspace.xyz_cloud);
+    workspace.tree->setInputCloud(workspace.xyz_cloud);
+    markRadiusOutliers(
+      *workspace.tree, *workspace.xyz_cloud, impl.getRadiusSearch(),
+      impl.getMinNeighborsInRadius(), impl.getNegative(), nullptr, keep);
+  }
+  return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 rcl_interfaces::msg::SetParametersResult
 pcl_ros::RadiusOutlierRemoval::config_callback(const std::vector<rclcpp::Parameter> & params)
@@ -105,24 +225,67 @@ pcl_ros::RadiusOutlierRemoval::config_callback(const std::vector<rclcpp::Paramet
   std::lock_guard<std::mutex> lock(mutex_);
 
   for (const rclcpp::Parameter & param : params) {
+    if (param.get_name() == "engine") {
+      Engine engine;
+      if (param.as_string() == "kdtree") {
+        engine = Engine::KdTree;
+      } else if (param.as_string() == "voxel_hash") {
+        engine = Engine::VoxelHash;
+      } else if (param.as_string() == "cell_count") {
+        engine = Engine::CellCount;
+      } else {
+        rcl_interfaces::msg::SetParametersResult result;
+        result.successful = false;
+        result.reason = "Unknown engine " + param.as_string() +
+          ", expected kdtree, voxel_hash or cell_count";
+        return result;
+      }
+      if (config_.engine != engine) {
+        RCLCPP_DEBUG(get_logger(), "Setting the engine to: %s.", param.as_string().c_str());
+        config_.engine = engine;
+      }
+    }
+    if (param.get_name() == "num_threads") {
+      if (config_.num_threads != param.as_int()) {
+        RCLCPP_DEBUG(get_logger(), "Setting the number of threads to: %ld.", param.as_int());
+        config_.num_threads = static_cast<int>(param.as_int());
+      }
+    }
+    if (param.get_name() == "shared_search") {
+      if (config_.shared_search != param.as_bool()) {
+        RCLCPP_DEBUG(
+          get_logger(), "Setting the shared search tree to: %s.",
+          (param.as_bool() ? "true" : "false"));
+        config_.shared_search = param.as_bool();
+      }
+    }
     if (param.get_name() == "min_neighbors") {
-      if (impl_.getMinNeighborsInRadius() != param.as_int()) {
+      if (config_.impl.getMinNeighborsInRadius() != param.as_int()) {
         RCLCPP_DEBUG(
           get_logger(), "Setting the number of neighbors in radius: %ld.",
           param.as_int());
-        impl_.setMinNeighborsInRadius(param.as_int());
+        config_.impl.setMinNeighborsInRadius(param.as_int());
       }
     }
     if (param.get_name() == "radius_search") {
-      if (impl_.getRadiusSearch() != param.as_double()) {
+      // The range lets 0 through, which PCL rejects with "No radius defined!" on every cloud
+      if (param.as_double() <= 0.0) {
+        rcl_interfaces::msg::SetParametersResult result;
+        result.successful = false;
+        result.reason = "No radius defined, radius_search must be greater than 0";
+        return result;
+      }
+      if (config_.impl.getRadiusSearch() != param.as_double()) {
         RCLCPP_DEBUG(
           get_logger(), "Setting the radius to search neighbors: %f.",
           param.as_double());
-        impl_.setRadiusSearch(param.as_double());
+        config_.impl.setRadiusSearch(param.as_double());
       }
     }
   }
 
+  snapshot_.store(config_);
+
   // Range constraints are enforced by rclcpp::Parameter.
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
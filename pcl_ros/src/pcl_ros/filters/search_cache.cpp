@@ -0,0 +1,120 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/search_cache.hpp"
+#include <pcl_conversions/pcl_conversions.h>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace
+{
+std::uint64_t
+hashData(const std::vector<std::uint8_t> & data)
+{
+  // 64 bit FNV-1a, one word at a time: the hash is only used to tell clouds with the same stamp
+  // apart, and must stay much cheaper than the tree build it saves
+  std::uint64_t hash = 14695981039346656037ULL;
+  const std::size_t nr_words = data.size() / sizeof(std::uint64_t);
+  for (std::size_t i = 0; i < nr_words; ++i) {
+    std::uint64_t word;
+    std::memcpy(&word, data.data() + i * sizeof(word), sizeof(word));
+    hash = (hash ^ word) * 1099511628211ULL;
+  }
+  for (std::size_t i = nr_words * sizeof(std::uint64_t); i < data.size(); ++i) {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::SearchCache::Key::operator==(const Key & other) const
+{
+  return sec == other.sec && nanosec == other.nanosec && width == other.width &&
+         height == other.height && point_step == other.point_step && hash == other.hash &&
+         frame_id == other.frame_id;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::SearchCache &
+pcl_ros::SearchCache::instance()
+{
+  static SearchCache cache;
+  return cache;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::SearchCache::EntryConstPtr
+pcl_ros::SearchCache::get(const sensor_msgs::msg::PointCloud2 & cloud)
+{
+  Key key {
+    cloud.header.stamp.sec, cloud.header.stamp.nanosec, cloud.header.frame_id,
+    cloud.width, cloud.height, cloud.point_step, hashData(cloud.data)};
+
+  std::shared_ptr<Slot> slot;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto & candidate : slots_) {
+      if (candidate->key == key) {
+        slot = candidate;
+        break;
+      }
+    }
+    if (!slot) {
+      slot = std::make_shared<Slot>();
+      slot->key = std::move(key);
+      slots_.push_back(slot);
+      if (slots_.size() > kCapacity) {
+        slots_.pop_front();
+      }
+    }
+  }
+
+  // Build outside of the cache lock, so that consumers of other frames are not blocked
+  std::call_once(
+    slot->built, [&cloud, &slot]() {
+      pcl::PointCloud<pcl::PointXYZ>::Ptr xyz(new pcl::PointCloud<pcl::PointXYZ>);
+      pcl::fromROSMsg(cloud, *xyz);
+      pcl::search::KdTree<pcl::PointXYZ>::Ptr search(new pcl::search::KdTree<pcl::PointXYZ>);
+      search->setInputCloud(xyz);
+      auto entry = std::make_shared<Entry>();
+      entry->cloud = xyz;
+      entry->search = search;
+      slot->entry = entry;
+    });
+  return slot->entry;
+}
@@ -36,6 +36,14 @@
  */
 
 #include "pcl_ros/filters/statistical_outlier_removal.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "pcl_ros/filters/outlier_masks.hpp"
+#include "pcl_ros/filters/parallel_for.hpp"
+#include "pcl_ros/filters/point_cloud2_ops.hpp"
 
 pcl_ros::StatisticalOutlierRemoval::StatisticalOutlierRemoval(const rclcpp::NodeOptions & options)
 : Filter("StatisticalOutlierRemovalNode", options)
@@ -74,7 +82,59 @@ pcl_ros::StatisticalOutlierRemoval::StatisticalOutlierRemoval(const rclcpp::Node
     "Set whether the inliers should be returned (true) or the outliers (false).";
   declare_parameter(negative_desc.name, rclcpp::ParameterValue(false), negative_desc);
 
+  rcl_interfaces::msg::ParameterDescriptor engine_desc;
+  engine_desc.name = "engine";
+  engine_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  engine_desc.description =
+    "How the mean distances are computed: kdtree (PCL), parallel (the search of PCL on "
+    "num_threads threads) or organized (neighbors taken from a window of the image of organized "
+    "clouds). "
+    "Inputs with indices always use kdtree.";
+  declare_parameter(engine_desc.name, rclcpp::ParameterValue("kdtree"), engine_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor num_threads_desc;
+  num_threads_desc.name = "num_threads";
+  num_threads_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  num_threads_desc.description =
+    "The number of threads of the parallel and organized engines, 0 to use all cores.";
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 256;
+    num_threads_desc.integer_range.push_back(int_range);
+  }
+  declare_parameter(num_threads_desc.name, rclcpp::ParameterValue(0), num_threads_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor running_statistics_alpha_desc;
+  running_statistics_alpha_desc.name = "running_statistics_alpha";
+  running_statistics_alpha_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  running_statistics_alpha_desc.description =
+    "Weight of each new frame in the running mean and standard deviation of the distances, "
+    "which are kept across frames when set. 0 computes them for every frame instead.";
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = 0.0;
+    float_range.to_value = 1.0;
+    running_statistics_alpha_desc.floating_point_range.push_back(float_range);
+  }
+  declare_parameter(
+    running_statistics_alpha_desc.name, rclcpp::ParameterValue(0.0),
+    running_statistics_alpha_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor shared_search_desc;
+  shared_search_desc.name = "shared_search";
+  shared_search_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  shared_search_desc.description =
+    "Share the search tree built for each cloud with the other components of this process that "
+    "filter the same cloud. Ignored when indices are given, and for organized clouds, which are "
+    "searched in their image like PCL does.";
+  declare_parameter(shared_search_desc.name, rclcpp::ParameterValue(false), shared_search_desc);
+
   const std::vector<std::string> param_names {
+    engine_desc.name,
+    num_threads_desc.name,
+    running_statistics_alpha_desc.name,
+    shared_search_desc.name,
     mean_k_desc.name,
     stddev_desc.name,
     negative_desc.name,
@@ -86,27 +146,114 @@ pcl_ros::StatisticalOutlierRemoval::StatisticalOutlierRemoval(const rclcpp::Node
       &StatisticalOutlierRemoval::config_callback, this,
       std::placeholders::_1));
 
-  config_callback(get_parameters(param_names));
+  auto result = config_callback(get_parameters(param_names));
+  if (!result.successful) {
+    throw std::runtime_error(result.reason);
+  }
 
-  // TODO(daisukes): lazy subscription after rclcpp#2060
-  subscribe();
+  lazySubscribe();
 }
 
 void
 pcl_ros::StatisticalOutlierRemoval::filter(
-  const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
   PointCloud2 & output)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // The latest configuration and a private workspace, parameter updates do not wait for the filter
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  // The direct path searches the whole cloud, while PCL only searches within the indices
+  const bool direct = config->engine != Engine::KdTree || config->shared_search ||
+    config->statistics_alpha > 0.0;
+  if (direct && !indices && markDirect(config, *workspace, *input)) {
+    output = *input;
+    compactPoints(output, workspace->keep);
+    return;
+  }
+  Impl & impl = workspace->impl.get(std::shared_ptr<const Impl>(config, &config->impl));
   pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
   pcl_conversions::toPCL(*(input), *(pcl_input));
-  impl_.setInputCloud(pcl_input);
-  impl_.setIndices(indices);
+  impl.setInputCloud(pcl_input);
+  impl.setIndices(copyIndices(indices));
   pcl::PCLPointCloud2 pcl_output;
-  impl_.filter(pcl_output);
+  // PCL resizes the buffer acquired for the output, moveFromPCL swaps it back
+  pcl_output.data = std::move(output.data);
+  impl.filter(pcl_output);
   pcl_conversions::moveFromPCL(pcl_output, output);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::StatisticalOutlierRemoval::filterIndices(
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
+  std::vector<int> & output_indices)
+{
+  ConfigConstPtr config = snapshot_.load();
+  auto workspace = workspaces_.acquire();
+  // The direct path searches the whole cloud, while PCL only searches within the indices
+  if (indices || !markDirect(config, *workspace, *input)) {
+    return false;
+  }
+  maskToIndices(workspace->keep, output_indices);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::StatisticalOutlierRemoval::markDirect(
+  const ConfigConstPtr & config, Workspace & workspace,
+  const PointCloud2 & input)
+{
+  XYZOffsets xyz;
+  if (!isDirectlyAccessible(input) || !getXYZOffsets(input, xyz)) {
+    return false;
+  }
+
+  // The running statistics depend on the previous frames, so frames using them take turns
+  std::unique_lock<std::mutex> statistics_lock(statistics_mutex_, std::defer_lock);
+  DistanceStatistics * running = nullptr;
+  if (config->statistics_alpha > 0.0) {
+    statistics_lock.lock();
+    if (statistics_config_ != config) {
+      statistics_ = DistanceStatistics();
+      statistics_.alpha = config->statistics_alpha;
+      statistics_config_ = config;
+    }
+    running = &statistics_;
+  }
+
+  // The getters of pcl::StatisticalOutlierRemoval are not const, read them from the private copy
+  Impl & impl = workspace.impl.get(std::shared_ptr<const Impl>(config, &config->impl));
+  const unsigned int num_threads =
+    config->engine == Engine::KdTree ? 1 : resolveNumThreads(config->num_threads);
+  std::vector<std::uint8_t> & keep = workspace.keep;
+  keep.assign(static_cast<std::size_t>(input.width) * input.height, 1);
+  if (config->engine == Engine::Organized && input.height > 1) {
+    markStatisticalOutliersOrganized(
+      input, xyz, impl.getMeanK(), impl.getStddevMulThresh(), impl.getNegative(), num_threads,
+      running, keep);
+  } else if (input.height > 1) {
+    // The shared trees are kd-trees, PCL searches organized clouds with an OrganizedNeighbor
+    pcl::fromROSMsg(input, *workspace.xyz_cloud);
+    workspace.organized_tree->setInputCloud(workspace.xyz_cloud);
+    markStatisticalOutliers(
+      *workspace.organized_tree, *workspace.xyz_cloud, impl.getMeanK(),
+      impl.getStddevMulThresh(), impl.getNegative(), num_threads, running, keep);
+  } else if (config->shared_search) {
+    const SearchCache::EntryConstPtr entry = SearchCache::instance().get(input);
+    markStatisticalOutliers(
+      *entry->search, *entry->cloud, impl.getMeanK(), impl.getStddevMulThresh(),
+      impl.getNegative(), num_threads, running, keep);
+  } else {
+    pcl::fromROSMsg(input, *workspace.xyz_cloud);
+    workspace.tree->setInputCloud(workspace.xyz_cloud);
+    markStatisticalOutliers(
+      *workspace.tree, *workspace.xyz_cloud, impl.getMeanK(), impl.getStddevMulThresh(),
+      impl.getNegative(), num_threads, running, keep);
+  }
+  return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 rcl_interfaces::msg::SetParametersResult
 pcl_ros::StatisticalOutlierRemoval::config_callback(const std::vector<rclcpp::Parameter> & params)
@@ -114,35 +261,80 @@ pcl_ros::StatisticalOutlierRemoval::config_callback(const std::vector<rclcpp::Pa
   std::lock_guard<std::mutex> lock(mutex_);
 
   for (const rclcpp::Parameter & param : params) {
+    if (param.get_name() == "engine") {
+      Engine engine;
+      if (param.as_string() == "kdtree") {
+        engine = Engine::KdTree;
+      } else if (param.as_string() == "parallel") {
+        engine = Engine::Parallel;
+      } else if (param.as_string() == "organized") {
+        engine = Engine::Organized;
+      } else {
+        rcl_interfaces::msg::SetParametersResult result;
+        result.successful = false;
+        result.reason = "Unknown engine " + param.as_string() +
+          ", expected kdtree, parallel or organized";
+        return result;
+      }
+      if (config_.engine != engine) {
+        RCLCPP_DEBUG(get_logger(), "Setting the engine to: %s.", param.as_string().c_str());
+        config_.engine = engine;
+      }
+    }
+    if (param.get_name() == "num_threads") {
+      if (config_.num_threads != param.as_int()) {
+        RCLCPP_DEBUG(get_logger(), "Setting the number of threads to: %ld.", param.as_int());
+        config_.num_threads = static_cast<int>(param.as_int());
+      }
+    }
+    if (param.get_name() == "running_statistics_alpha") {
+      if (config_.statistics_alpha != param.as_double()) {
+        RCLCPP_DEBUG(
+          get_logger(), "Setting the weight of new frames in the running statistics to: %f.",
+          param.as_double());
+        config_.statistics_alpha = param.as_double();
+      }
+    }
+    if (param.get_name() == "shared_search") {
+      if (config_.shared_search != param.as_bool()) {
+        RCLCPP_DEBUG(
+          get_logger(), "Setting the shared search tree to: %s.",
+          (param.as_bool() ? "true" : "false"));
+        config_.shared_search = param.as_bool();
+      }
+    }
     if (param.get_name() == "mean_k") {
-      if (impl_.getMeanK() != param.as_int()) {
+      if (config_.impl.getMeanK() != param.as_int()) {
         RCLCPP_DEBUG(
           get_logger(),
           "Setting the number of points (k) to use for mean distance estimation to: %ld.",
           param.as_int());
-        impl_.setMeanK(param.as_int());
+        config_.impl.setMeanK(param.as_int());
       }
     }
     if (param.get_name() == "stddev") {
-      if (impl_.getStddevMulThresh() != param.as_double()) {
+      if (config_.impl.getStddevMulThresh() != param.as_double()) {
         RCLCPP_DEBUG(
           get_logger(),
           "Setting the standard deviation multiplier threshold to: %f.",
           param.as_double());
-        impl_.setStddevMulThresh(param.as_double());
+        config_.impl.setStddevMulThresh(param.as_double());
       }
     }
     if (param.get_name() == "negative") {
-      if (impl_.getNegative() != param.as_bool()) {
+      if (config_.impl.getNegative() != param.as_bool()) {
         RCLCPP_DEBUG(
           get_logger(),
           "Returning only inliers: %s.",
           (param.as_bool() ? "false" : "true"));
-        impl_.setNegative(param.as_bool());
+        config_.impl.setNegative(param.as_bool());
       }
     }
   }
 
+  // Any change may change the distances, the running statistics start over with the new snapshot
+  snapshot_.store(config_);
+
   // Range constraints are enforced by rclcpp::Parameter.
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
@@ -36,6 +36,7 @@
  */
 
 #include "pcl_ros/filters/voxel_grid.hpp"
+#include <utility>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -85,22 +86,25 @@ pcl_ros::VoxelGrid::VoxelGrid(const rclcpp::NodeOptions & options)
 
   config_callback(get_parameters(param_names));
 
-  // TODO(daisukes): lazy subscription after rclcpp#2060
-  subscribe();
+  lazySubscribe();
 }
 
 void
 pcl_ros::VoxelGrid::filter(
-  const PointCloud2::ConstSharedPtr & input, const IndicesPtr & indices,
+  const PointCloud2::ConstSharedPtr & input, const IndicesConstPtr & indices,
   PointCloud2 & output)
 {
-  std::lock_guard<std::mutex> lock(mutex_);
+  // A private copy of the latest configuration, parameter updates do not wait for the filter
+  auto workspace = workspaces_.acquire();
+  Impl & impl = workspace->get(snapshot_.load());
   pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
   pcl_conversions::toPCL(*(input), *(pcl_input));
-  impl_.setInputCloud(pcl_input);
-  impl_.setIndices(indices);
+  impl.setInputCloud(pcl_input);
+  impl.setIndices(copyIndices(indices));
   pcl::PCLPointCloud2 pcl_output;
-  impl_.filter(pcl_output);
+  // PCL resizes the buffer acquired for the output, moveFromPCL swaps it back
+  pcl_output.data = std::move(output.data);
+  impl.filter(pcl_output);
   pcl_conversions::moveFromPCL(pcl_output, output);
 }
 
@@ -182,6 +186,8 @@ pcl_ros::VoxelGrid::config_callback(const std::vector<rclcpp::Parameter> & param
     }
   }
 
+  snapshot_.store(impl_);
+
   // Range constraints are enforced by rclcpp::Parameter.
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
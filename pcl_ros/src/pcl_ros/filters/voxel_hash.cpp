@@ -0,0 +1,294 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/filters/voxel_hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "pcl_ros/filters/parallel_for.hpp"
+
+namespace
+{
+/** \brief Cell coordinates are packed in 21 bits each. Clouds spanning more than 2^21 cells wrap
+  * around, which only adds candidates that the radius test rejects.
+  */
+constexpr int kCellBits = 21;
+constexpr std::int64_t kCellMask = (std::int64_t(1) << kCellBits) - 1;
+
+/** \brief Bound of the cell coordinates, well within int64_t. Points further away share the
+  * cells at the bound, which only adds candidates that the radius test rejects.
+  */
+constexpr double kMaxCellCoordinate = 4.0e15;
+
+/** \brief Cells per parallel chunk, to keep the thread overhead negligible. */
+constexpr std::size_t kMinCellsPerChunk = 1024;
+
+/** \brief The cell coordinate of \a value, clamped to +/- kMaxCellCoordinate. */
+inline std::int64_t
+cellCoordinate(float value, double inv_radius)
+{
+  const double cell = std::floor(value * inv_radius);
+  return static_cast<std::int64_t>(
+    std::max(-kMaxCellCoordinate, std::min(kMaxCellCoordinate, cell)));
+}
+
+inline std::uint64_t
+cellKey(std::int64_t cx, std::int64_t cy, std::int64_t cz)
+{
+  return (static_cast<std::uint64_t>(cx & kCellMask) << (2 * kCellBits)) |
+         (static_cast<std::uint64_t>(cy & kCellMask) << kCellBits) |
+         static_cast<std::uint64_t>(cz & kCellMask);
+}
+
+/** \brief Open addressing map from cell keys to cell ids. Lookups dominate the run time (27 per
+  * cell), and linear probing in flat arrays is several times faster than std::unordered_map.
+  */
+class CellTable
+{
+public:
+  static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+  static constexpr std::uint32_t kNotFound = ~std::uint32_t(0);
+
+  explicit CellTable(std::size_t expected_size)
+  {
+    resize(expected_size * 2);
+  }
+
+  /** \brief Return the id of \a key, assigning \a next_id if the key is new. */
+  std::uint32_t
+  insert(std::uint64_t key, std::uint32_t next_id)
+  {
+    if (2 * (size_ + 1) > slots_.size()) {
+      resize(slots_.size() * 2);
+    }
+    std::size_t slot = hash(key);
+    while (slots_[slot].key != kEmpty) {
+      if (slots_[slot].key == key) {
+        return slots_[slot].id;
+      }
+      slot = (slot + 1) & mask_;
+    }
+    slots_[slot].key = key;
+    slots_[slot].id = next_id;
+    ++size_;
+    return next_id;
+  }
+
+  std::uint32_t
+  find(std::uint64_t key) const
+  {
+    std::size_t slot = hash(key);
+    while (slots_[slot].key != kEmpty) {
+      if (slots_[slot].key == key) {
+        return slots_[slot].id;
+      }
+      slot = (slot + 1) & mask_;
+    }
+    return kNotFound;
+  }
+
+private:
+  std::size_t
+  hash(std::uint64_t key) const
+  {
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+  }
+
+  void
+  resize(std::size_t min_capacity)
+  {
+    std::size_t capacity = 16;
+    shift_ = 60;
+    while (capacity < min_capacity) {
+      capacity *= 2;
+      --shift_;
+    }
+    std::vector<Slot> slots(capacity, Slot{kEmpty, 0});
+    slots.swap(slots_);
+    mask_ = capacity - 1;
+    size_ = 0;
+    for (const Slot & slot : slots) {
+      if (slot.key != kEmpty) {
+        insert(slot.key, slot.id);
+      }
+    }
+  }
+
+  struct Slot
+  {
+    std::uint64_t key;
+    std::uint32_t id;
+  };
+
+  std::vector<Slot> slots_;
+  std::size_t mask_ = 0;
+  std::size_t size_ = 0;
+  int shift_ = 60;
+};
+
+inline float
+readFloat(const std::uint8_t * point, std::uint32_t offset)
+{
+  float value;
+  std::memcpy(&value, point + offset, sizeof(float));
+  return value;
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::markRadiusOutliersVoxelHash(
+  const sensor_msgs::msg::PointCloud2 & cloud, const XYZOffsets & xyz,
+  const std::vector<int> * indices, double radius, int min_neighbors, bool negative,
+  bool cell_count_only, unsigned int num_threads, std::vector<std::uint8_t> & keep)
+{
+  const std::size_t nr_points = static_cast<std::size_t>(cloud.width) * cloud.height;
+  const std::size_t nr_candidates = indices ? indices->size() : nr_points;
+  const double inv_radius = 1.0 / radius;
+  if (!(radius > 0.0) || !std::isfinite(inv_radius)) {
+    // Like pcl::RadiusOutlierRemoval without a radius, no point is returned
+    std::fill(keep.begin(), keep.end(), 0);
+    return;
+  }
+  const float sq_radius = static_cast<float>(radius * radius);
+
+  // Gather the finite candidates with the cell they fall in, assigning cell ids on first use
+  std::vector<std::uint32_t> point_index;
+  std::vector<std::uint32_t> point_cell;
+  std::vector<std::int64_t> cell_coords;
+  CellTable cell_ids(nr_candidates / 4 + 1);
+  point_index.reserve(nr_candidates);
+  point_cell.reserve(nr_candidates);
+  for (std::size_t i = 0; i < nr_candidates; ++i) {
+    const std::size_t cp = indices ? static_cast<std::size_t>((*indices)[i]) : i;
+    if (cp >= nr_points) {
+      continue;
+    }
+    const std::uint8_t * point = cloud.data.data() + cp * cloud.point_step;
+    const float x = readFloat(point, xyz.x);
+    const float y = readFloat(point, xyz.y);
+    const float z = readFloat(point, xyz.z);
+    if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z)) {
+      keep[cp] = 0;
+      continue;
+    }
+    const std::int64_t cx = cellCoordinate(x, inv_radius);
+    const std::int64_t cy = cellCoordinate(y, inv_radius);
+    const std::int64_t cz = cellCoordinate(z, inv_radius);
+    const std::uint32_t next_id = static_cast<std::uint32_t>(cell_coords.size() / 3);
+    const std::uint32_t cell = cell_ids.insert(cellKey(cx, cy, cz), next_id);
+    if (cell == next_id) {
+      cell_coords.push_back(cx);
+      cell_coords.push_back(cy);
+      cell_coords.push_back(cz);
+    }
+    point_index.push_back(static_cast<std::uint32_t>(cp));
+    point_cell.push_back(cell);
+  }
+  const std::size_t nr_cells = cell_coords.size() / 3;
+
+  // Counting sort of the points by cell, so that the points of a cell are contiguous
+  std::vector<std::uint32_t> cell_start(nr_cells + 1, 0);
+  for (const std::uint32_t cell : point_cell) {
+    ++cell_start[cell + 1];
+  }
+  for (std::size_t c = 0; c < nr_cells; ++c) {
+    cell_start[c + 1] += cell_start[c];
+  }
+  std::vector<std::uint32_t> sorted_index(point_index.size());
+  std::vector<float> sorted_xyz(3 * point_index.size());
+  {
+    std::vector<std::uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+    for (std::size_t i = 0; i < point_index.size(); ++i) {
+      const std::uint32_t slot = fill[point_cell[i]]++;
+      const std::uint8_t * point = cloud.data.data() + point_index[i] * cloud.point_step;
+      sorted_index[slot] = point_index[i];
+      sorted_xyz[3 * slot] = readFloat(point, xyz.x);
+      sorted_xyz[3 * slot + 1] = readFloat(point, xyz.y);
+      sorted_xyz[3 * slot + 2] = readFloat(point, xyz.z);
+    }
+  }
+
+  // Every cell only writes the keep entries of its own points, so cells are independent
+  const std::size_t threshold = static_cast<std::size_t>(min_neighbors);
+  parallelFor(
+    nr_cells, num_threads, kMinCellsPerChunk,
+    [&](std::size_t cell_begin, std::size_t cell_end) {
+      std::uint32_t neighbor_cells[27];
+      for (std::size_t c = cell_begin; c < cell_end; ++c) {
+        // Look up the neighboring cells once for all points of the cell
+        int nr_neighbor_cells = 0;
+        std::size_t cell_count = 0;
+        for (std::int64_t dx = -1; dx <= 1; ++dx) {
+          for (std::int64_t dy = -1; dy <= 1; ++dy) {
+            for (std::int64_t dz = -1; dz <= 1; ++dz) {
+              const std::uint32_t cell = cell_ids.find(
+                cellKey(
+                  cell_coords[3 * c] + dx, cell_coords[3 * c + 1] + dy,
+                  cell_coords[3 * c + 2] + dz));
+              if (cell != CellTable::kNotFound) {
+                neighbor_cells[nr_neighbor_cells++] = cell;
+                cell_count += cell_start[cell + 1] - cell_start[cell];
+              }
+            }
+          }
+        }
+
+        for (std::uint32_t p = cell_start[c]; p < cell_start[c + 1]; ++p) {
+          // Like the search tree, the count includes the point itself
+          std::size_t found = cell_count;
+          if (!cell_count_only) {
+            const float px = sorted_xyz[3 * p];
+            const float py = sorted_xyz[3 * p + 1];
+            const float pz = sorted_xyz[3 * p + 2];
+            found = 0;
+            for (int n = 0; n < nr_neighbor_cells && found <= threshold; ++n) {
+              const std::uint32_t begin = cell_start[neighbor_cells[n]];
+              const std::uint32_t end = cell_start[neighbor_cells[n] + 1];
+              for (std::uint32_t q = begin; q < end; ++q) {
+                const float ex = sorted_xyz[3 * q] - px;
+                const float ey = sorted_xyz[3 * q + 1] - py;
+                const float ez = sorted_xyz[3 * q + 2] - pz;
+                found += (ex * ex + ey * ey + ez * ez <= sq_radius);
+              }
+            }
+          }
+          if ((found > threshold) == negative) {
+            keep[sorted_index[p]] = 0;
+          }
+        }
+      }
+    });
+}
@@ -0,0 +1,145 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/transport/bounded_point_cloud.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace
+{
+using pcl_ros_interfaces::msg::BoundedPointCloud2;
+using pcl_ros_interfaces::msg::BoundedPointField;
+
+/** \brief Copy \a text into a fixed-capacity buffer, padded with zeros. */
+template<std::size_t N>
+void
+copyPadded(const std::string & text, std::array<std::uint8_t, N> & buffer)
+{
+  std::memcpy(buffer.data(), text.data(), text.size());
+  std::fill(buffer.begin() + text.size(), buffer.end(), 0);
+}
+
+/** \brief The text of a fixed-capacity buffer padded with zeros, which may use all of it. */
+template<std::size_t N>
+std::string
+readPadded(const std::array<std::uint8_t, N> & buffer)
+{
+  const auto end = std::find(buffer.begin(), buffer.end(), 0);
+  return std::string(buffer.begin(), end);
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::fitsBounded(const sensor_msgs::msg::PointCloud2 & cloud)
+{
+  if (cloud.header.frame_id.size() > BoundedPointCloud2::FRAME_ID_CAPACITY ||
+    cloud.fields.size() > BoundedPointCloud2::FIELDS_CAPACITY ||
+    cloud.data.size() > BoundedPointCloud2::DATA_CAPACITY)
+  {
+    return false;
+  }
+  for (const sensor_msgs::msg::PointField & field : cloud.fields) {
+    if (field.name.size() > BoundedPointField::NAME_CAPACITY) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::toBounded(
+  const sensor_msgs::msg::PointCloud2 & cloud, BoundedPointCloud2 & bounded)
+{
+  if (!fitsBounded(cloud)) {
+    return false;
+  }
+  bounded.stamp = cloud.header.stamp;
+  copyPadded(cloud.header.frame_id, bounded.frame_id);
+  bounded.height = cloud.height;
+  bounded.width = cloud.width;
+  bounded.nr_fields = static_cast<std::uint32_t>(cloud.fields.size());
+  for (std::size_t f = 0; f < cloud.fields.size(); ++f) {
+    BoundedPointField & field = bounded.fields[f];
+    copyPadded(cloud.fields[f].name, field.name);
+    field.offset = cloud.fields[f].offset;
+    field.datatype = cloud.fields[f].datatype;
+    field.count = cloud.fields[f].count;
+  }
+  bounded.is_bigendian = cloud.is_bigendian;
+  bounded.point_step = cloud.point_step;
+  bounded.row_step = cloud.row_step;
+  // Only the points are copied, the rest of the buffer is not read by fromBounded ()
+  bounded.data_size = static_cast<std::uint32_t>(cloud.data.size());
+  if (!cloud.data.empty()) {
+    std::memcpy(bounded.data.data(), cloud.data.data(), cloud.data.size());
+  }
+  bounded.is_dense = cloud.is_dense;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::fromBounded(
+  const BoundedPointCloud2 & bounded, sensor_msgs::msg::PointCloud2 & cloud)
+{
+  if (bounded.nr_fields > BoundedPointCloud2::FIELDS_CAPACITY ||
+    bounded.data_size > BoundedPointCloud2::DATA_CAPACITY)
+  {
+    return false;
+  }
+  cloud.header.stamp = bounded.stamp;
+  cloud.header.frame_id = readPadded(bounded.frame_id);
+  cloud.height = bounded.height;
+  cloud.width = bounded.width;
+  cloud.fields.resize(bounded.nr_fields);
+  for (std::size_t f = 0; f < bounded.nr_fields; ++f) {
+    sensor_msgs::msg::PointField & field = cloud.fields[f];
+    field.name = readPadded(bounded.fields[f].name);
+    field.offset = bounded.fields[f].offset;
+    field.datatype = bounded.fields[f].datatype;
+    field.count = bounded.fields[f].count;
+  }
+  cloud.is_bigendian = bounded.is_bigendian;
+  cloud.point_step = bounded.point_step;
+  cloud.row_step = bounded.row_step;
+  cloud.data.assign(bounded.data.begin(), bounded.data.begin() + bounded.data_size);
+  cloud.is_dense = bounded.is_dense;
+  return true;
+}
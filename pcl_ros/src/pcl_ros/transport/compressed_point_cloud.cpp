@@ -0,0 +1,225 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "pcl_ros/transport/compressed_point_cloud.hpp"
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::CodecOptions
+pcl_ros::declareCodecParameters(rclcpp::Node & node, const std::string & prefix)
+{
+  CodecOptions options;
+
+  rcl_interfaces::msg::ParameterDescriptor precision_desc;
+  precision_desc.name = prefix + ".precision";
+  precision_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  precision_desc.description =
+    "The step in meters the quantized fields are rounded to, 0 to code them losslessly.";
+  precision_desc.read_only = true;
+  {
+    rcl_interfaces::msg::FloatingPointRange float_range;
+    float_range.from_value = 0.0;
+    float_range.to_value = 1.0;
+    precision_desc.floating_point_range.push_back(float_range);
+  }
+  options.precision = node.declare_parameter(
+    precision_desc.name, options.precision, precision_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor compressor_desc;
+  compressor_desc.name = prefix + ".compressor";
+  compressor_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  compressor_desc.description =
+    "The compressor of the coded fields: none, lz4 for speed or zstd for size.";
+  compressor_desc.read_only = true;
+  const std::string compressor =
+    node.declare_parameter(compressor_desc.name, std::string("zstd"), compressor_desc);
+  if (!parseCompressor(compressor, options.compressor)) {
+    throw std::runtime_error(
+            "Unknown " + compressor_desc.name + " " + compressor + ", expected none, lz4 or zstd");
+  }
+
+  rcl_interfaces::msg::ParameterDescriptor level_desc;
+  level_desc.name = prefix + ".compression_level";
+  level_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  level_desc.description = "The zstd compression level, or the lz4 acceleration.";
+  level_desc.read_only = true;
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 1;
+    int_range.to_value = 22;
+    level_desc.integer_range.push_back(int_range);
+  }
+  options.compression_level =
+    node.declare_parameter(level_desc.name, options.compression_level, level_desc);
+
+  rcl_interfaces::msg::ParameterDescriptor field_codecs_desc;
+  field_codecs_desc.name = prefix + ".field_codecs";
+  field_codecs_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  field_codecs_desc.description =
+    "The codecs of the fields as field:codec, with codec raw, delta or quantized. x, y and z "
+    "default to quantized, and the other fields to raw.";
+  field_codecs_desc.read_only = true;
+  const std::vector<std::string> field_codecs = node.declare_parameter(
+    field_codecs_desc.name, std::vector<std::string>(), field_codecs_desc);
+  for (const std::string & field_codec : field_codecs) {
+    const std::size_t separator = field_codec.rfind(':');
+    FieldCodec codec;
+    if (separator == std::string::npos ||
+      !parseFieldCodec(field_codec.substr(separator + 1), codec))
+    {
+      throw std::runtime_error(
+              "Invalid " + field_codecs_desc.name + " entry " + field_codec +
+              ", expected field:codec with codec raw, delta or quantized");
+    }
+    options.field_codecs[field_codec.substr(0, separator)] = codec;
+  }
+
+  rcl_interfaces::msg::ParameterDescriptor block_points_desc;
+  block_points_desc.name = prefix + ".block_points";
+  block_points_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  block_points_desc.description =
+    "The number of points compressed together, and distributed to the threads.";
+  block_points_desc.read_only = true;
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 1024;
+    int_range.to_value = 1 << 22;
+    block_points_desc.integer_range.push_back(int_range);
+  }
+  options.block_points = static_cast<std::size_t>(
+    node.declare_parameter(
+      block_points_desc.name, static_cast<std::int64_t>(options.block_points),
+      block_points_desc));
+
+  rcl_interfaces::msg::ParameterDescriptor num_threads_desc;
+  num_threads_desc.name = prefix + ".num_threads";
+  num_threads_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  num_threads_desc.description =
+    "The number of threads encoding each point cloud, 0 for the number of hardware threads.";
+  num_threads_desc.read_only = true;
+  {
+    rcl_interfaces::msg::IntegerRange int_range;
+    int_range.from_value = 0;
+    int_range.to_value = 256;
+    num_threads_desc.integer_range.push_back(int_range);
+  }
+  options.num_threads =
+    node.declare_parameter(num_threads_desc.name, options.num_threads, num_threads_desc);
+  return options;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::CompressedPublisher::CompressedPublisher(
+  rclcpp::Node & node, const std::string & topic, const rclcpp::QoS & qos,
+  const CodecOptions & options, const rclcpp::PublisherOptions & publisher_options)
+: options_(options), logger_(node.get_logger())
+{
+  publisher_ = node.create_publisher<point_cloud_interfaces::msg::CompressedPointCloud2>(
+    topic + "/" + kQuantizedFormat, qos, publisher_options);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::CompressedPublisher::publish(const sensor_msgs::msg::PointCloud2 & cloud)
+{
+  // Encoding costs far more than publishing, skip it if nobody listens
+  if (publisher_->get_subscription_count() == 0) {
+    return;
+  }
+  point_cloud_interfaces::msg::CompressedPointCloud2::UniquePtr compressed(
+    new point_cloud_interfaces::msg::CompressedPointCloud2);
+  if (!encodePointCloud(cloud, options_, *compressed)) {
+    RCLCPP_ERROR(logger_, "Could not encode a point cloud whose layout does not match its data.");
+    return;
+  }
+  publisher_->publish(std::move(compressed));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl_ros::CompressedPublisher::getNumSubscribers() const
+{
+  return publisher_->get_subscription_count();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::CompressedSubscriber::CompressedSubscriber(
+  rclcpp::Node & node, const std::string & topic, const std::string & transport,
+  const rclcpp::QoS & qos, Callback callback, int num_threads,
+  const rclcpp::SubscriptionOptions & subscription_options)
+{
+  if (transport == "raw") {
+    subscription_ = node.create_subscription<sensor_msgs::msg::PointCloud2>(
+      topic, qos,
+      [callback](sensor_msgs::msg::PointCloud2::ConstSharedPtr cloud) {
+        callback(cloud);
+      }, subscription_options);
+  } else if (transport == kQuantizedFormat) {
+    const rclcpp::Logger logger = node.get_logger();
+    thread_pool_ = std::make_shared<ThreadPool>();
+    std::shared_ptr<ThreadPool> thread_pool = thread_pool_;
+    subscription_ = node.create_subscription<point_cloud_interfaces::msg::CompressedPointCloud2>(
+      topic + "/" + kQuantizedFormat, qos,
+      [callback, logger, num_threads, thread_pool](
+        point_cloud_interfaces::msg::CompressedPointCloud2::ConstSharedPtr compressed) {
+        auto cloud = std::make_shared<sensor_msgs::msg::PointCloud2>();
+        bool decoded;
+        {
+          ThreadPool::Scope scope(*thread_pool);
+          decoded = decodePointCloud(*compressed, *cloud, num_threads);
+        }
+        if (!decoded) {
+          RCLCPP_WARN(
+            logger, "Dropping a compressed point cloud in format %s that could not be decoded.",
+            compressed->format.c_str());
+          return;
+        }
+        callback(cloud);
+      }, subscription_options);
+  } else {
+    throw std::runtime_error(
+            "Unknown point cloud transport " + transport + ", expected raw or " +
+            kQuantizedFormat);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::string
+pcl_ros::CompressedSubscriber::getTopic() const
+{
+  return subscription_->get_topic_name();
+}
@@ -0,0 +1,67 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "pcl_ros/transport/compressed_relay.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl_ros::CompressedRelay::CompressedRelay(const rclcpp::NodeOptions & options)
+: rclcpp::Node("CompressedRelayNode", options)
+{
+  rcl_interfaces::msg::ParameterDescriptor max_queue_size_desc;
+  max_queue_size_desc.name = "max_queue_size";
+  max_queue_size_desc.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  max_queue_size_desc.description = "QoS History depth";
+  max_queue_size_desc.read_only = true;
+  const int max_queue_size = declare_parameter(max_queue_size_desc.name, 3, max_queue_size_desc);
+
+  pub_output_.reset(
+    new CompressedPublisher(
+      *this, "output", rclcpp::QoS(max_queue_size), declareCodecParameters(*this, "compression")));
+  sub_input_ = create_subscription<sensor_msgs::msg::PointCloud2>(
+    "input", max_queue_size,
+    std::bind(&CompressedRelay::input_callback, this, std::placeholders::_1));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl_ros::CompressedRelay::input_callback(
+  const sensor_msgs::msg::PointCloud2::ConstSharedPtr & cloud)
+{
+  ThreadPool::Scope scope(thread_pool_);
+  pub_output_->publish(*cloud);
+}
+
+#include "rclcpp_components/register_node_macro.hpp"
+RCLCPP_COMPONENTS_REGISTER_NODE(pcl_ros::CompressedRelay)
@@ -0,0 +1,784 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+#include "pcl_ros/transport/point_cloud_codec.hpp"
+#include <lz4.h>
+#include <zstd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "pcl_ros/filters/parallel_for.hpp"
+
+const char * const pcl_ros::kQuantizedFormat = "quantized";
+
+namespace
+{
+using sensor_msgs::msg::PointCloud2;
+using sensor_msgs::msg::PointField;
+
+/** \brief The first bytes of the encoded data, with the version of the format. */
+const std::uint8_t kMagic[4] = {'P', 'C', 'Q', '1'};
+
+/** \brief The largest ratio between the size of a decoded point and its coded size, which only
+  * padding between and after the fields can exceed 1. Larger ratios are rejected as corrupted.
+  */
+const std::uint64_t kMaxPointExpansion = 16;
+
+/** \brief The largest ratio between the decompressed and compressed sizes of an LZ4 block. */
+const std::uint64_t kMaxLz4Expansion = 255;
+
+/** \brief The code of NaN values in Quantized columns, out of the range of the other values. */
+const std::uint32_t kNaNCode = 0x80000000u;
+const double kMaxCode = 2147483647.0;
+
+/** \brief A field of the points, coded as a column of \a count values of \a size bytes per point.
+  */
+struct Column
+{
+  std::uint32_t offset;
+  std::uint32_t count;
+  std::uint8_t datatype;
+  std::uint8_t size;
+  pcl_ros::FieldCodec codec;
+};
+
+bool
+hostIsBigEndian()
+{
+  const std::uint16_t one = 1;
+  std::uint8_t first;
+  std::memcpy(&first, &one, 1);
+  return first == 0;
+}
+
+std::uint8_t
+datatypeSize(std::uint8_t datatype)
+{
+  switch (datatype) {
+    case PointField::INT8:
+    case PointField::UINT8:
+      return 1;
+    case PointField::INT16:
+    case PointField::UINT16:
+      return 2;
+    case PointField::INT32:
+    case PointField::UINT32:
+    case PointField::FLOAT32:
+      return 4;
+    case PointField::FLOAT64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+/** \brief Make the columns of the fields of a point cloud layout.
+  * \param options the options of the encoder, nullptr when decoding
+  * \return false if a field has an unknown datatype or does not fit in a point
+  */
+bool
+makeColumns(
+  const std::vector<PointField> & fields, std::uint32_t point_step, bool host_order,
+  const pcl_ros::CodecOptions * options, std::vector<Column> & columns)
+{
+  columns.clear();
+  for (const PointField & field : fields) {
+    Column column;
+    column.offset = field.offset;
+    column.count = std::max<std::uint32_t>(1, field.count);
+    column.datatype = field.datatype;
+    column.size = datatypeSize(field.datatype);
+    if (column.size == 0 ||
+      std::uint64_t(column.offset) + std::uint64_t(column.size) * column.count > point_step)
+    {
+      return false;
+    }
+    column.codec = pcl_ros::FieldCodec::Raw;
+    if (options) {
+      if (field.name == "x" || field.name == "y" || field.name == "z") {
+        column.codec = pcl_ros::FieldCodec::Quantized;
+      }
+      const auto codec = options->field_codecs.find(field.name);
+      if (codec != options->field_codecs.end()) {
+        column.codec = codec->second;
+      }
+      // Only floating point values in host byte order can be rounded
+      const bool is_float =
+        field.datatype == PointField::FLOAT32 || field.datatype == PointField::FLOAT64;
+      if (column.codec == pcl_ros::FieldCodec::Quantized &&
+        (!is_float || !host_order || !(options->precision > 0.0)))
+      {
+        column.codec = pcl_ros::FieldCodec::Delta;
+      }
+    }
+    columns.push_back(column);
+  }
+  return true;
+}
+
+void
+putU8(std::vector<std::uint8_t> & out, std::uint8_t value)
+{
+  out.push_back(value);
+}
+
+void
+putU32(std::vector<std::uint8_t> & out, std::uint32_t value)
+{
+  for (int b = 0; b < 4; ++b) {
+    out.push_back(static_cast<std::uint8_t>(value >> (8 * b)));
+  }
+}
+
+void
+putU64(std::vector<std::uint8_t> & out, std::uint64_t value)
+{
+  for (int b = 0; b < 8; ++b) {
+    out.push_back(static_cast<std::uint8_t>(value >> (8 * b)));
+  }
+}
+
+/** \brief Bounds checked sequential reads of little endian values. */
+struct Reader
+{
+  const std::uint8_t * data;
+  std::size_t size;
+  std::size_t pos;
+
+  Reader(const std::uint8_t * data, std::size_t size)
+  : data(data), size(size), pos(0) {}
+
+  bool
+  bytes(std::size_t n, const std::uint8_t * & out)
+  {
+    if (size - pos < n) {
+      return false;
+    }
+    out = data + pos;
+    pos += n;
+    return true;
+  }
+
+  template<typename UIntT>
+  bool
+  value(UIntT & out)
+  {
+    const std::uint8_t * in;
+    if (!bytes(sizeof(UIntT), in)) {
+      return false;
+    }
+    out = 0;
+    for (std::size_t b = 0; b < sizeof(UIntT); ++b) {
+      out = static_cast<UIntT>(out | (static_cast<UIntT>(in[b]) << (8 * b)));
+    }
+    return true;
+  }
+};
+
+/** \brief Copy the values of a column for the points [begin, end) of a point cloud. */
+template<typename T>
+void
+gather(
+  const PointCloud2 & cloud, const Column & column, std::size_t begin, std::size_t end,
+  T * values)
+{
+  for (std::size_t i = begin; i < end; ++i) {
+    const std::uint8_t * point = cloud.data.data() + (i / cloud.width) * cloud.row_step +
+      (i % cloud.width) * cloud.point_step;
+    std::memcpy(values, point + column.offset, sizeof(T) * column.count);
+    values += column.count;
+  }
+}
+
+/** \brief Copy the values of a column into the points [begin, end) of unpadded rows. */
+template<typename T>
+void
+scatter(
+  const T * values, const Column & column, std::size_t begin, std::size_t end,
+  std::uint32_t point_step, std::uint8_t * data)
+{
+  for (std::size_t i = begin; i < end; ++i) {
+    std::memcpy(data + i * point_step + column.offset, values, sizeof(T) * column.count);
+    values += column.count;
+  }
+}
+
+/** \brief Replace each value by its difference with the value \a lag positions before. */
+template<typename UIntT>
+void
+deltaEncode(UIntT * values, std::size_t size, std::size_t lag)
+{
+  for (std::size_t i = size; i-- > lag; ) {
+    values[i] = static_cast<UIntT>(values[i] - values[i - lag]);
+  }
+}
+
+template<typename UIntT>
+void
+deltaDecode(UIntT * values, std::size_t size, std::size_t lag)
+{
+  for (std::size_t i = lag; i < size; ++i) {
+    values[i] = static_cast<UIntT>(values[i] + values[i - lag]);
+  }
+}
+
+/** \brief Append the values split in byte planes, the low bytes of all values first. Small
+  * deltas then leave long runs of zero bytes for the compressor.
+  */
+template<typename UIntT>
+void
+appendShuffled(const UIntT * values, std::size_t size, std::vector<std::uint8_t> & raw)
+{
+  const std::size_t start = raw.size();
+  raw.resize(start + size * sizeof(UIntT));
+  std::uint8_t * out = raw.data() + start;
+  for (std::size_t b = 0; b < sizeof(UIntT); ++b) {
+    for (std::size_t i = 0; i < size; ++i) {
+      out[b * size + i] = static_cast<std::uint8_t>(values[i] >> (8 * b));
+    }
+  }
+}
+
+template<typename UIntT>
+bool
+readShuffled(Reader & reader, std::size_t size, UIntT * values)
+{
+  const std::uint8_t * in;
+  if (!reader.bytes(size * sizeof(UIntT), in)) {
+    return false;
+  }
+  std::fill(values, values + size, UIntT(0));
+  for (std::size_t b = 0; b < sizeof(UIntT); ++b) {
+    for (std::size_t i = 0; i < size; ++i) {
+      values[i] = static_cast<UIntT>(values[i] | (static_cast<UIntT>(in[b * size + i]) << (8 * b)));
+    }
+  }
+  return true;
+}
+
+template<typename UIntT>
+void
+encodeValues(
+  const PointCloud2 & cloud, const Column & column, std::size_t begin, std::size_t end,
+  bool delta, std::vector<std::uint8_t> & raw)
+{
+  std::vector<UIntT> values((end - begin) * column.count);
+  gather(cloud, column, begin, end, values.data());
+  if (delta) {
+    deltaEncode(values.data(), values.size(), column.count);
+  }
+  appendShuffled(values.data(), values.size(), raw);
+}
+
+template<typename UIntT>
+bool
+decodeValues(
+  Reader & reader, const Column & column, std::size_t begin, std::size_t end, bool delta,
+  std::uint32_t point_step, std::uint8_t * data)
+{
+  std::vector<UIntT> values((end - begin) * column.count);
+  if (!readShuffled(reader, values.size(), values.data())) {
+    return false;
+  }
+  if (delta) {
+    deltaDecode(values.data(), values.size(), column.count);
+  }
+  scatter(values.data(), column, begin, end, point_step, data);
+  return true;
+}
+
+/** \brief Round the values of a floating point column to multiples of \a precision, and delta
+  * code them.
+  * \return false if a value is infinite or out of the range of the codes
+  */
+template<typename FloatT>
+bool
+encodeQuantized(
+  const PointCloud2 & cloud, const Column & column, std::size_t begin, std::size_t end,
+  double precision, std::vector<std::uint8_t> & raw)
+{
+  std::vector<FloatT> values((end - begin) * column.count);
+  gather(cloud, column, begin, end, values.data());
+  std::vector<std::uint32_t> codes(values.size());
+  const double scale = 1.0 / precision;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    const double value = values[i];
+    if (std::isnan(value)) {
+      codes[i] = kNaNCode;
+      continue;
+    }
+    const double code = std::round(value * scale);
+    if (!(std::abs(code) <= kMaxCode)) {
+      return false;
+    }
+    codes[i] = static_cast<std::uint32_t>(static_cast<std::int32_t>(code));
+  }
+  deltaEncode(codes.data(), codes.size(), column.count);
+  appendShuffled(codes.data(), codes.size(), raw);
+  return true;
+}
+
+template<typename FloatT>
+bool
+decodeQuantized(
+  Reader & reader, const Column & column, std::size_t begin, std::size_t end, double precision,
+  std::uint32_t point_step, std::uint8_t * data)
+{
+  std::vector<std::uint32_t> codes((end - begin) * column.count);
+  if (!readShuffled(reader, codes.size(), codes.data())) {
+    return false;
+  }
+  deltaDecode(codes.data(), codes.size(), column.count);
+  std::vector<FloatT> values(codes.size());
+  for (std::size_t i = 0; i < codes.size(); ++i) {
+    values[i] = codes[i] == kNaNCode ? std::numeric_limits<FloatT>::quiet_NaN() :
+      static_cast<FloatT>(static_cast<std::int32_t>(codes[i]) * precision);
+  }
+  scatter(values.data(), column, begin, end, point_step, data);
+  return true;
+}
+
+/** \brief Code the columns of the points [begin, end). Each column starts with the codec it
+  * was coded with, as Quantized columns fall back to Delta for values that cannot be rounded.
+  */
+void
+encodeBlock(
+  const PointCloud2 & cloud, const std::vector<Column> & columns, double precision,
+  std::size_t begin, std::size_t end, std::vector<std::uint8_t> & raw)
+{
+  raw.clear();
+  for (const Column & column : columns) {
+    const std::size_t codec_pos = raw.size();
+    pcl_ros::FieldCodec codec = column.codec;
+    putU8(raw, static_cast<std::uint8_t>(codec));
+    if (codec == pcl_ros::FieldCodec::Quantized) {
+      const bool quantized = column.datatype == PointField::FLOAT32 ?
+        encodeQuantized<float>(cloud, column, begin, end, precision, raw) :
+        encodeQuantized<double>(cloud, column, begin, end, precision, raw);
+      if (quantized) {
+        continue;
+      }
+      raw.resize(codec_pos + 1);
+      codec = pcl_ros::FieldCodec::Delta;
+      raw[codec_pos] = static_cast<std::uint8_t>(codec);
+    }
+    const bool delta = codec == pcl_ros::FieldCodec::Delta;
+    switch (column.size) {
+      case 1:
+        encodeValues<std::uint8_t>(cloud, column, begin, end, delta, raw);
+        break;
+      case 2:
+        encodeValues<std::uint16_t>(cloud, column, begin, end, delta, raw);
+        break;
+      case 4:
+        encodeValues<std::uint32_t>(cloud, column, begin, end, delta, raw);
+        break;
+      default:
+        encodeValues<std::uint64_t>(cloud, column, begin, end, delta, raw);
+        break;
+    }
+  }
+}
+
+bool
+decodeBlock(
+  const std::vector<std::uint8_t> & raw, const std::vector<Column> & columns, double precision,
+  std::size_t begin, std::size_t end, std::uint32_t point_step, std::uint8_t * data)
+{
+  Reader reader(raw.data(), raw.size());
+  for (const Column & column : columns) {
+    std::uint8_t codec;
+    if (!reader.value(codec)) {
+      return false;
+    }
+    bool decoded = false;
+    if (codec == static_cast<std::uint8_t>(pcl_ros::FieldCodec::Quantized)) {
+      if (column.datatype == PointField::FLOAT32) {
+        decoded = decodeQuantized<float>(reader, column, begin, end, precision, point_step, data);
+      } else if (column.datatype == PointField::FLOAT64) {
+        decoded = decodeQuantized<double>(reader, column, begin, end, precision, point_step, data);
+      }
+    } else if (codec <= static_cast<std::uint8_t>(pcl_ros::FieldCodec::Delta)) {
+      const bool delta = codec == static_cast<std::uint8_t>(pcl_ros::FieldCodec::Delta);
+      switch (column.size) {
+        case 1:
+          decoded = decodeValues<std::uint8_t>(reader, column, begin, end, delta, point_step, data);
+          break;
+        case 2:
+          decoded =
+            decodeValues<std::uint16_t>(reader, column, begin, end, delta, point_step, data);
+          break;
+        case 4:
+          decoded =
+            decodeValues<std::uint32_t>(reader, column, begin, end, delta, point_step, data);
+          break;
+        default:
+          decoded =
+            decodeValues<std::uint64_t>(reader, column, begin, end, delta, point_step, data);
+          break;
+      }
+    }
+    if (!decoded) {
+      return false;
+    }
+  }
+  return reader.pos == raw.size();
+}
+
+bool
+compressBlock(
+  pcl_ros::Compressor compressor, int level, const std::vector<std::uint8_t> & raw,
+  std::vector<std::uint8_t> & out)
+{
+  if (raw.size() > std::numeric_limits<std::uint32_t>::max()) {
+    return false;
+  }
+  switch (compressor) {
+    case pcl_ros::Compressor::Lz4: {
+        if (raw.size() > LZ4_MAX_INPUT_SIZE) {
+          return false;
+        }
+        out.resize(LZ4_compressBound(static_cast<int>(raw.size())));
+        const int size = LZ4_compress_fast(
+          reinterpret_cast<const char *>(raw.data()), reinterpret_cast<char *>(out.data()),
+          static_cast<int>(raw.size()), static_cast<int>(out.size()), std::max(1, level));
+        if (size <= 0) {
+          return false;
+        }
+        out.resize(size);
+        return true;
+      }
+    case pcl_ros::Compressor::Zstd: {
+        out.resize(ZSTD_compressBound(raw.size()));
+        const std::size_t size = ZSTD_compress(
+          out.data(), out.size(), raw.data(), raw.size(), level);
+        if (ZSTD_isError(size)) {
+          return false;
+        }
+        out.resize(size);
+        return true;
+      }
+    default:
+      out = raw;
+      return true;
+  }
+}
+
+/** \brief Check that a compressed block can decompress to \a raw_size bytes, so that corrupted
+  * sizes are rejected before allocating them.
+  */
+bool
+checkBlockSize(
+  pcl_ros::Compressor compressor, const std::uint8_t * in, std::size_t size,
+  std::uint64_t raw_size)
+{
+  switch (compressor) {
+    case pcl_ros::Compressor::Lz4:
+      return raw_size <= kMaxLz4Expansion * (std::uint64_t(size) + 1);
+    case pcl_ros::Compressor::Zstd:
+      // ZSTD_compress () stores the decompressed size in the frame header
+      return ZSTD_getFrameContentSize(in, size) == raw_size;
+    default:
+      return size == raw_size;
+  }
+}
+
+bool
+decompressBlock(
+  pcl_ros::Compressor compressor, const std::uint8_t * in, std::size_t size,
+  std::vector<std::uint8_t> & raw)
+{
+  switch (compressor) {
+    case pcl_ros::Compressor::Lz4:
+      return size <= LZ4_MAX_INPUT_SIZE && raw.size() <= LZ4_MAX_INPUT_SIZE &&
+             LZ4_decompress_safe(
+        reinterpret_cast<const char *>(in), reinterpret_cast<char *>(raw.data()),
+        static_cast<int>(size), static_cast<int>(raw.size())) == static_cast<int>(raw.size());
+    case pcl_ros::Compressor::Zstd:
+      return ZSTD_decompress(raw.data(), raw.size(), in, size) == raw.size();
+    default:
+      if (size != raw.size()) {
+        return false;
+      }
+      std::copy(in, in + size, raw.begin());
+      return true;
+  }
+}
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::parseFieldCodec(const std::string & name, FieldCodec & codec)
+{
+  if (name == "raw") {
+    codec = FieldCodec::Raw;
+  } else if (name == "delta") {
+    codec = FieldCodec::Delta;
+  } else if (name == "quantized") {
+    codec = FieldCodec::Quantized;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::parseCompressor(const std::string & name, Compressor & compressor)
+{
+  if (name == "none") {
+    compressor = Compressor::None;
+  } else if (name == "lz4") {
+    compressor = Compressor::Lz4;
+  } else if (name == "zstd") {
+    compressor = Compressor::Zstd;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::encodePointCloud(
+  const sensor_msgs::msg::PointCloud2 & cloud, const CodecOptions & options,
+  point_cloud_interfaces::msg::CompressedPointCloud2 & compressed)
+{
+  const bool host_order = cloud.is_bigendian == hostIsBigEndian();
+  std::vector<Column> columns;
+  if (!makeColumns(cloud.fields, cloud.point_step, host_order, &options, columns)) {
+    return false;
+  }
+  const std::size_t nr_points = std::size_t(cloud.width) * cloud.height;
+  if (nr_points > 0 &&
+    (std::uint64_t(cloud.width) * cloud.point_step > cloud.row_step ||
+    std::uint64_t(cloud.height) * cloud.row_step > cloud.data.size()))
+  {
+    return false;
+  }
+
+  // Blocks are coded and compressed independently, each thread takes a contiguous range of them
+  const std::size_t block_points = std::max<std::size_t>(1, options.block_points);
+  const std::size_t nr_blocks = (nr_points + block_points - 1) / block_points;
+  if (block_points > std::numeric_limits<std::uint32_t>::max() ||
+    nr_blocks > std::numeric_limits<std::uint32_t>::max())
+  {
+    return false;
+  }
+  std::vector<std::uint32_t> raw_sizes(nr_blocks);
+  std::vector<std::vector<std::uint8_t>> blocks(nr_blocks);
+  std::atomic<bool> compressed_all(true);
+  parallelFor(
+    nr_blocks, resolveNumThreads(options.num_threads), 1,
+    [&](std::size_t first, std::size_t last) {
+      std::vector<std::uint8_t> raw;
+      for (std::size_t b = first; b < last; ++b) {
+        const std::size_t begin = b * block_points;
+        encodeBlock(
+          cloud, columns, options.precision, begin, std::min(begin + block_points, nr_points),
+          raw);
+        raw_sizes[b] = static_cast<std::uint32_t>(raw.size());
+        if (!compressBlock(options.compressor, options.compression_level, raw, blocks[b])) {
+          compressed_all = false;
+        }
+      }
+    });
+  if (!compressed_all) {
+    return false;
+  }
+  // The decoder rejects clouds whose padding makes them much larger than their coded size
+  std::uint64_t total_raw_size = 0;
+  for (const std::uint32_t raw_size : raw_sizes) {
+    total_raw_size += raw_size;
+  }
+  if (std::uint64_t(nr_points) * cloud.point_step > kMaxPointExpansion * total_raw_size) {
+    return false;
+  }
+
+  compressed.header = cloud.header;
+  compressed.height = cloud.height;
+  compressed.width = cloud.width;
+  compressed.fields = cloud.fields;
+  compressed.is_bigendian = cloud.is_bigendian;
+  compressed.point_step = cloud.point_step;
+  compressed.row_step = cloud.width * cloud.point_step;
+  compressed.is_dense = cloud.is_dense;
+  compressed.format = kQuantizedFormat;
+
+  std::size_t total_size = 0;
+  for (const std::vector<std::uint8_t> & block : blocks) {
+    total_size += block.size();
+  }
+  std::vector<std::uint8_t> & out = compressed.compressed_data;
+  out.clear();
+  out.reserve(30 + 8 * nr_blocks + total_size);
+  out.insert(out.end(), kMagic, kMagic + 4);
+  putU8(out, static_cast<std::uint8_t>(options.compressor));
+  putU8(out, hostIsBigEndian() ? 1 : 0);
+  putU32(out, static_cast<std::uint32_t>(columns.size()));
+  std::uint64_t precision_bits;
+  std::memcpy(&precision_bits, &options.precision, sizeof(precision_bits));
+  putU64(out, precision_bits);
+  putU32(out, static_cast<std::uint32_t>(block_points));
+  putU32(out, static_cast<std::uint32_t>(nr_blocks));
+  for (std::size_t b = 0; b < nr_blocks; ++b) {
+    putU32(out, raw_sizes[b]);
+    putU32(out, static_cast<std::uint32_t>(blocks[b].size()));
+  }
+  for (const std::vector<std::uint8_t> & block : blocks) {
+    out.insert(out.end(), block.begin(), block.end());
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl_ros::decodePointCloud(
+  const point_cloud_interfaces::msg::CompressedPointCloud2 & compressed,
+  sensor_msgs::msg::PointCloud2 & cloud, int num_threads)
+{
+  if (compressed.format != kQuantizedFormat) {
+    return false;
+  }
+  Reader reader(compressed.compressed_data.data(), compressed.compressed_data.size());
+  const std::uint8_t * magic;
+  std::uint8_t compressor, big_endian;
+  std::uint32_t nr_columns, block_points, nr_blocks;
+  std::uint64_t precision_bits;
+  if (!reader.bytes(4, magic) || !std::equal(kMagic, kMagic + 4, magic) ||
+    !reader.value(compressor) || !reader.value(big_endian) || !reader.value(nr_columns) ||
+    !reader.value(precision_bits) || !reader.value(block_points) || !reader.value(nr_blocks))
+  {
+    return false;
+  }
+  // The values are in the byte order of the encoding host
+  if (compressor > static_cast<std::uint8_t>(Compressor::Zstd) ||
+    (big_endian != 0) != hostIsBigEndian() || nr_columns != compressed.fields.size() ||
+    block_points == 0)
+  {
+    return false;
+  }
+  double precision;
+  std::memcpy(&precision, &precision_bits, sizeof(precision));
+
+  std::vector<Column> columns;
+  if (!makeColumns(compressed.fields, compressed.point_step, true, nullptr, columns)) {
+    return false;
+  }
+  const std::size_t nr_points = std::size_t(compressed.width) * compressed.height;
+  if (nr_blocks != (nr_points + block_points - 1) / block_points) {
+    return false;
+  }
+
+  // The smallest and largest coded sizes of a point, Quantized codes floating point values on
+  // 4 bytes, to reject corrupted sizes before allocating
+  std::uint64_t min_point_size = 0, max_point_size = 0;
+  for (const Column & column : columns) {
+    const std::uint64_t min_size = column.datatype == PointField::FLOAT64 ? 4 : column.size;
+    min_point_size += std::uint64_t(column.count) * min_size;
+    max_point_size += std::uint64_t(column.count) * std::max<std::uint64_t>(column.size, 4);
+  }
+  std::vector<std::uint32_t> raw_sizes(nr_blocks);
+  std::vector<std::size_t> block_offsets(nr_blocks + 1);
+  std::uint64_t total_raw_size = 0;
+  for (std::size_t b = 0; b < nr_blocks; ++b) {
+    // Each block codes every column of its points exactly once
+    const std::uint64_t nr_block_points =
+      std::min<std::uint64_t>(block_points, nr_points - b * block_points);
+    std::uint32_t compressed_size;
+    if (!reader.value(raw_sizes[b]) || !reader.value(compressed_size) ||
+      raw_sizes[b] < columns.size() + nr_block_points * min_point_size ||
+      raw_sizes[b] > columns.size() + nr_block_points * max_point_size)
+    {
+      return false;
+    }
+    block_offsets[b + 1] = block_offsets[b] + compressed_size;
+    total_raw_size += raw_sizes[b];
+  }
+  if (block_offsets[nr_blocks] != reader.size - reader.pos) {
+    return false;
+  }
+  const std::uint8_t * payload = reader.data + reader.pos;
+  for (std::size_t b = 0; b < nr_blocks; ++b) {
+    if (!checkBlockSize(
+        static_cast<Compressor>(compressor), payload + block_offsets[b],
+        block_offsets[b + 1] - block_offsets[b], raw_sizes[b]))
+    {
+      return false;
+    }
+  }
+
+  // Compute the layout in 64 bits, the fields of the message are not trusted. The decoded size
+  // is bounded by the validated coded size, only the padding of the points is not coded.
+  const std::uint64_t row_step = std::uint64_t(compressed.width) * compressed.point_step;
+  const std::uint64_t data_size = row_step * compressed.height;
+  if (row_step > std::numeric_limits<std::uint32_t>::max() ||
+    data_size > kMaxPointExpansion * total_raw_size)
+  {
+    return false;
+  }
+
+  cloud.header = compressed.header;
+  cloud.height = compressed.height;
+  cloud.width = compressed.width;
+  cloud.fields = compressed.fields;
+  cloud.is_bigendian = compressed.is_bigendian;
+  cloud.point_step = compressed.point_step;
+  cloud.row_step = static_cast<std::uint32_t>(row_step);
+  cloud.is_dense = compressed.is_dense;
+  cloud.data.assign(static_cast<std::size_t>(data_size), 0);
+
+  std::atomic<bool> decoded_all(true);
+  parallelFor(
+    nr_blocks, resolveNumThreads(num_threads), 1,
+    [&](std::size_t first, std::size_t last) {
+      std::vector<std::uint8_t> raw;
+      for (std::size_t b = first; b < last && decoded_all; ++b) {
+        const std::size_t begin = b * block_points;
+        const std::size_t end = std::min(begin + block_points, nr_points);
+        raw.resize(raw_sizes[b]);
+        if (!decompressBlock(
+            static_cast<Compressor>(compressor), payload + block_offsets[b],
+            block_offsets[b + 1] - block_offsets[b], raw) ||
+          !decodeBlock(
+            raw, columns, precision, begin, end, cloud.point_step, cloud.data.data()))
+        {
+          decoded_all = false;
+        }
+      }
+    });
+  return decoded_all;
+}
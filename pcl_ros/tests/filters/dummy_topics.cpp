@@ -58,8 +58,11 @@ DummyTopics::DummyTopics(const rclcpp::NodeOptions & options)
 : Node("dummy_point_cloud2_publisher", options), count_(0)
 {
   point_cloud2_pub_ = this->create_publisher<sensor_msgs::msg::PointCloud2>("point_cloud2", 10);
-  indices_pub_ = this->create_publisher<pcl_msgs::msg::PointIndices>("indices", 10);
-  model_pub_ = this->create_publisher<pcl_msgs::msg::ModelCoefficients>("model", 10);
+  // Transient local, so that both synchronized and latched subscribers can connect
+  indices_pub_ = this->create_publisher<pcl_msgs::msg::PointIndices>(
+    "indices", rclcpp::QoS(10).transient_local());
+  model_pub_ = this->create_publisher<pcl_msgs::msg::ModelCoefficients>(
+    "model", rclcpp::QoS(10).transient_local());
   timer_ = this->create_wall_timer(
     100ms, std::bind(&DummyTopics::timer_callback, this));
 }
@@ -0,0 +1,889 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Check that the filters implemented directly on the PointCloud2 buffers give the same result as
+// the PCL filters they replace, on seeded clouds.
+
+#include <gtest/gtest.h>
+#include <pcl/ModelCoefficients.h>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/common/point_tests.h>
+#include <pcl/filters/crop_box.h>
+#include <pcl/common/io.h>
+#include <pcl/filters/extract_indices.h>
+#include <pcl/filters/passthrough.h>
+#include <pcl/filters/project_inliers.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/sample_consensus/model_types.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include "pcl_ros/filters/box_set.hpp"
+#include "pcl_ros/filters/crop_box.hpp"
+#include "pcl_ros/filters/extract_indices.hpp"
+#include "pcl_ros/filters/passthrough.hpp"
+#include "pcl_ros/filters/point_mask.hpp"
+#include "pcl_ros/filters/project_inliers.hpp"
+
+namespace
+{
+typedef sensor_msgs::msg::PointCloud2 PointCloud2;
+
+/** \brief A seeded cloud of pcl::PointXYZI in [-2; 2]^3, the x, y and z of every
+  * \a nan_every th point set to NaN (none if 0).
+  */
+PointCloud2::SharedPtr
+makeCloud(unsigned int seed, std::uint32_t width, std::uint32_t height, int nan_every)
+{
+  pcl::PointCloud<pcl::PointXYZI> cloud(width, height);
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    pcl::PointXYZI & point = cloud[i];
+    point.x = (rand_r(&seed) % 4000 - 2000) * 0.001f;
+    point.y = (rand_r(&seed) % 4000 - 2000) * 0.001f;
+    point.z = (rand_r(&seed) % 4000 - 2000) * 0.001f;
+    point.intensity = static_cast<float>(rand_r(&seed) % 256);
+    if (nan_every > 0 && i % nan_every == 0) {
+      point.x = point.y = point.z = nan;
+    }
+  }
+  cloud.is_dense = nan_every == 0;
+  auto msg = std::make_shared<PointCloud2>();
+  pcl::toROSMsg(cloud, *msg);
+  // Same frame as the output, so that no transform is involved
+  msg->header.frame_id = "";
+  return msg;
+}
+
+/** \brief \a count seeded indices into a cloud of \a nr_points points, unsorted and with
+  * duplicates, like the inliers of a segmentation merged from several models.
+  */
+pcl::IndicesPtr
+makeIndices(unsigned int seed, std::size_t nr_points, std::size_t count)
+{
+  pcl::IndicesPtr indices(new pcl::Indices);
+  for (std::size_t i = 0; i < count; ++i) {
+    indices->push_back(static_cast<int>(rand_r(&seed) % nr_points));
+  }
+  return indices;
+}
+
+/** \brief Read the FLOAT32 \a field of the point at \a index of \a cloud. */
+float
+readFloat(const PointCloud2 & cloud, std::size_t index, const sensor_msgs::msg::PointField & field)
+{
+  float value;
+  std::memcpy(&value, &cloud.data[index * cloud.point_step + field.offset], sizeof(float));
+  return value;
+}
+
+/** \brief Expect \a actual to have the size, fields and values of \a expected. The x, y and z
+  * values may differ by \a tolerance, the other fields must be identical. The fields may be laid
+  * out differently, only FLOAT32 fields are compared. Empty clouds only need to be empty, PCL
+  * leaves their layout unset.
+  */
+void
+expectCloudsNear(const PointCloud2 & actual, const PointCloud2 & expected, float tolerance)
+{
+  if (static_cast<std::size_t>(expected.width) * expected.height == 0) {
+    EXPECT_EQ(static_cast<std::size_t>(actual.width) * actual.height, 0u);
+    return;
+  }
+  ASSERT_EQ(actual.width, expected.width);
+  ASSERT_EQ(actual.height, expected.height);
+  ASSERT_EQ(actual.fields.size(), expected.fields.size());
+  for (std::size_t f = 0; f < expected.fields.size(); ++f) {
+    ASSERT_EQ(actual.fields[f].name, expected.fields[f].name);
+    ASSERT_EQ(actual.fields[f].datatype, expected.fields[f].datatype);
+  }
+  const std::size_t nr_points = static_cast<std::size_t>(expected.width) * expected.height;
+  ASSERT_GE(actual.data.size(), nr_points * actual.point_step);
+  std::size_t nr_mismatches = 0;
+  for (std::size_t i = 0; i < nr_points; ++i) {
+    for (std::size_t f = 0; f < expected.fields.size(); ++f) {
+      if (expected.fields[f].datatype != sensor_msgs::msg::PointField::FLOAT32) {
+        continue;
+      }
+      const std::string & name = expected.fields[f].name;
+      const float a = readFloat(actual, i, actual.fields[f]);
+      const float e = readFloat(expected, i, expected.fields[f]);
+      const float max_error = name == "x" || name == "y" || name == "z" ? tolerance : 0.0f;
+      const bool match = std::isnan(e) ? std::isnan(a) : std::fabs(a - e) <= max_error;
+      if (!match && nr_mismatches++ == 0) {
+        ADD_FAILURE() << "point " << i << " field " << name << ": " << a << " instead of " << e;
+      }
+    }
+  }
+  EXPECT_EQ(nr_mismatches, 0u);
+}
+
+/** \brief Seeded boxes around the origin, every \a subtract_every th a subtract box, every
+  * \a aligned_every th axis aligned and the others rotated and translated.
+  */
+std::vector<pcl_ros::OrientedBox>
+makeBoxes(unsigned int seed, int nr_boxes, int subtract_every, int aligned_every)
+{
+  std::vector<pcl_ros::OrientedBox> boxes(nr_boxes);
+  for (int b = 0; b < nr_boxes; ++b) {
+    pcl_ros::OrientedBox & box = boxes[b];
+    for (int i = 0; i < 3; ++i) {
+      box.min_pt[i] = -(rand_r(&seed) % 1000) * 0.0007f - 0.05f;
+      box.max_pt[i] = (rand_r(&seed) % 1000) * 0.0007f + 0.05f;
+    }
+    const bool aligned = b % aligned_every == aligned_every - 1;
+    for (int i = 0; i < 3; ++i) {
+      box.pose[i] = aligned ? 0.0f : (rand_r(&seed) % 2000 - 1000) * 0.0015f;
+      box.pose[3 + i] = aligned ? 0.0f : (rand_r(&seed) % 2000 - 1000) * 0.00314f;
+    }
+    box.subtract = b % subtract_every == subtract_every - 1;
+  }
+  return boxes;
+}
+
+/** \brief The points of \a cloud inside of \a box according to pcl::CropBox, and the points
+  * within \a margin of one of its faces, whose test depends on the rounding of the transform.
+  */
+void
+cropWithPCL(
+  const pcl::PointCloud<pcl::PointXYZ>::Ptr & cloud, const pcl_ros::OrientedBox & box,
+  float margin, std::vector<std::uint8_t> & inside, std::vector<std::uint8_t> & ambiguous)
+{
+  pcl::CropBox<pcl::PointXYZ> impl;
+  impl.setMin(Eigen::Vector4f(box.min_pt[0], box.min_pt[1], box.min_pt[2], 1.0f));
+  impl.setMax(Eigen::Vector4f(box.max_pt[0], box.max_pt[1], box.max_pt[2], 1.0f));
+  impl.setTranslation(Eigen::Vector3f(box.pose[0], box.pose[1], box.pose[2]));
+  impl.setRotation(Eigen::Vector3f(box.pose[3], box.pose[4], box.pose[5]));
+  impl.setInputCloud(cloud);
+  pcl::Indices found;
+  impl.filter(found);
+  inside.assign(cloud->size(), 0);
+  for (const int index : found) {
+    inside[index] = 1;
+  }
+
+  // The box frame in double, Rz (yaw) Ry (pitch) Rx (roll) like pcl::getTransformation ()
+  const Eigen::Matrix3d rotation =
+    (Eigen::AngleAxisd(box.pose[5], Eigen::Vector3d::UnitZ()) *
+    Eigen::AngleAxisd(box.pose[4], Eigen::Vector3d::UnitY()) *
+    Eigen::AngleAxisd(box.pose[3], Eigen::Vector3d::UnitX())).toRotationMatrix();
+  const Eigen::Vector3d translation(box.pose[0], box.pose[1], box.pose[2]);
+  ambiguous.assign(cloud->size(), 0);
+  for (std::size_t i = 0; i < cloud->size(); ++i) {
+    if (!pcl::isFinite((*cloud)[i])) {
+      continue;
+    }
+    const Eigen::Vector3d local = rotation.transpose() *
+      ((*cloud)[i].getVector3fMap().cast<double>() - translation);
+    bool in_outer = true, in_inner = true;
+    for (int j = 0; j < 3; ++j) {
+      in_outer &= local[j] >= box.min_pt[j] - margin && local[j] <= box.max_pt[j] + margin;
+      in_inner &= local[j] >= box.min_pt[j] + margin && local[j] <= box.max_pt[j] - margin;
+    }
+    ambiguous[i] = in_outer && !in_inner;
+  }
+}
+
+/** \brief Expose the processing path of ExtractIndices without the subscriptions. */
+class DirectExtractIndices : public pcl_ros::ExtractIndices
+{
+public:
+  explicit DirectExtractIndices(const rclcpp::NodeOptions & options)
+  : ExtractIndices(options) {}
+
+  using pcl_ros::Filter::computeOutput;
+  using pcl_ros::ExtractIndices::filterIndices;
+  using pcl_ros::ExtractIndices::filterMask;
+};
+
+/** \brief Extract the points of \a input with pcl::ExtractIndices, the reference of the direct
+  * path.
+  */
+PointCloud2
+extractWithPCL(const PointCloud2 & input, const pcl::IndicesPtr & indices, bool negative)
+{
+  pcl::ExtractIndices<pcl::PCLPointCloud2> impl;
+  impl.setNegative(negative);
+  pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
+  pcl_conversions::toPCL(input, *pcl_input);
+  impl.setInputCloud(pcl_input);
+  if (indices) {
+    impl.setIndices(std::make_shared<pcl::Indices>(*indices));
+  }
+  pcl::PCLPointCloud2 pcl_output;
+  impl.filter(pcl_output);
+  PointCloud2 output;
+  pcl_conversions::moveFromPCL(pcl_output, output);
+  return output;
+}
+
+/** \brief The indices of the points of \a input extracted by pcl::ExtractIndices. */
+pcl::Indices
+extractIndicesWithPCL(const PointCloud2 & input, const pcl::IndicesPtr & indices, bool negative)
+{
+  pcl::PointCloud<pcl::PointXYZI>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::fromROSMsg(input, *cloud);
+  pcl::ExtractIndices<pcl::PointXYZI> impl;
+  impl.setNegative(negative);
+  impl.setInputCloud(cloud);
+  if (indices) {
+    impl.setIndices(indices);
+  }
+  pcl::Indices output;
+  impl.filter(output);
+  return output;
+}
+
+/** \brief Expose the processing path of PassThrough without the subscriptions. */
+class DirectPassThrough : public pcl_ros::PassThrough
+{
+public:
+  explicit DirectPassThrough(const rclcpp::NodeOptions & options)
+  : PassThrough(options) {}
+
+  using pcl_ros::Filter::computeOutput;
+  using pcl_ros::PassThrough::filterIndices;
+  using pcl_ros::PassThrough::filterMask;
+};
+
+/** \brief Expose the processing path of CropBox without the subscriptions. */
+class DirectCropBox : public pcl_ros::CropBox
+{
+public:
+  explicit DirectCropBox(const rclcpp::NodeOptions & options)
+  : CropBox(options) {}
+
+  using pcl_ros::Filter::computeOutput;
+  using pcl_ros::CropBox::filterIndices;
+  using pcl_ros::CropBox::filterMask;
+};
+
+/** \brief A range on one field, like the parameters of PassThrough. */
+struct Range
+{
+  std::string field;
+  double limit_min;
+  double limit_max;
+  bool negative;
+};
+
+/** \brief The indices of the points of \a cloud passing every range, with one pcl::PassThrough
+  * per range applied to the output of the previous one.
+  */
+pcl::Indices
+passWithPCL(
+  const pcl::PointCloud<pcl::PointXYZI>::Ptr & cloud, const std::vector<Range> & ranges,
+  const pcl::IndicesPtr & indices)
+{
+  pcl::IndicesPtr passing = indices;
+  for (const Range & range : ranges) {
+    pcl::PassThrough<pcl::PointXYZI> impl;
+    impl.setInputCloud(cloud);
+    if (passing) {
+      impl.setIndices(passing);
+    }
+    impl.setFilterFieldName(range.field);
+    impl.setFilterLimits(static_cast<float>(range.limit_min), static_cast<float>(range.limit_max));
+    impl.setNegative(range.negative);
+    pcl::IndicesPtr output(new pcl::Indices);
+    impl.filter(*output);
+    passing = output;
+  }
+  return *passing;
+}
+
+/** \brief Expect a received \a mask to give the same cloud and passing points as the equivalent
+  * sorted indices, whether the filter reads it in place or converts it.
+  */
+template<typename FilterT>
+void
+expectMaskMatchesIndices(
+  FilterT & filter, const PointCloud2::SharedPtr & input, const pcl_ros::PointMask & mask)
+{
+  const pcl::IndicesPtr indices(new pcl::Indices);
+  mask.toIndices(*indices);
+
+  PointCloud2 expected, output;
+  ASSERT_TRUE(filter.computeOutput(input, indices, "", expected));
+  ASSERT_TRUE(filter.computeOutput(input, nullptr, "", output, &mask));
+  expectCloudsNear(output, expected, 0.0f);
+
+  std::vector<int> expected_indices, output_indices;
+  ASSERT_TRUE(filter.filterIndices(input, indices, expected_indices));
+  pcl_ros::PointMask output_mask;
+  ASSERT_TRUE(filter.filterMask(input, nullptr, &mask, output_mask));
+  output_mask.toIndices(output_indices);
+  EXPECT_EQ(output_indices, expected_indices);
+}
+
+/** \brief Expose the processing path of ProjectInliers without the subscriptions. */
+class DirectProjectInliers : public pcl_ros::ProjectInliers
+{
+public:
+  explicit DirectProjectInliers(const rclcpp::NodeOptions & options)
+  : ProjectInliers(options) {}
+
+  using pcl_ros::Filter::computeOutput;
+  using pcl_ros::ProjectInliers::model_;
+};
+
+/** \brief Project \a input with pcl::ProjectInliers, the reference of the direct path. */
+PointCloud2
+projectWithPCL(
+  const PointCloud2 & input, const pcl::IndicesPtr & indices, int model_type,
+  const std::vector<float> & values, bool copy_all_data, bool copy_all_fields)
+{
+  pcl::ProjectInliers<pcl::PCLPointCloud2> impl;
+  impl.setModelType(model_type);
+  impl.setCopyAllData(copy_all_data);
+  impl.setCopyAllFields(copy_all_fields);
+  pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
+  pcl_conversions::toPCL(input, *pcl_input);
+  impl.setInputCloud(pcl_input);
+  if (indices) {
+    impl.setIndices(std::make_shared<pcl::Indices>(*indices));
+  }
+  pcl::ModelCoefficients::Ptr coefficients(new pcl::ModelCoefficients);
+  coefficients->values = values;
+  impl.setModelCoefficients(coefficients);
+  pcl::PCLPointCloud2 pcl_output;
+  impl.filter(pcl_output);
+  PointCloud2 output;
+  pcl_conversions::moveFromPCL(pcl_output, output);
+  return output;
+}
+}  // namespace
+
+class DirectPathsTest : public ::testing::Test
+{
+protected:
+  static void
+  SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void
+  TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(DirectPathsTest, ProjectInliersMatchesPCL)
+{
+  // Large enough for the projection to be split between threads
+  const PointCloud2::SharedPtr input = makeCloud(1, 50000, 1, 101);
+  const std::size_t nr_points = input->width;
+  struct Model
+  {
+    int type;
+    std::vector<float> values;
+  };
+  // The plane normal is not unit, PCL normalizes it but uses d as given
+  const std::vector<Model> models{
+    {pcl::SACMODEL_PLANE, {0.2f, -0.4f, 0.8f, 0.3f}},
+    {pcl::SACMODEL_LINE, {0.1f, 0.2f, -0.3f, 1.0f, 2.0f, -0.5f}},
+  };
+  const std::vector<pcl::IndicesPtr> all_indices{
+    makeIndices(2, nr_points, 40000), makeIndices(3, nr_points, 100), pcl::IndicesPtr()};
+
+  for (const Model & model : models) {
+    for (const bool copy_all_data : {false, true}) {
+      for (const bool copy_all_fields : {false, true}) {
+        rclcpp::NodeOptions options;
+        options.parameter_overrides(
+        {
+          {"model_type", model.type},
+          {"copy_all_data", copy_all_data},
+          {"copy_all_fields", copy_all_fields},
+          {"num_threads", 4},
+        });
+        DirectProjectInliers filter(options);
+        auto coefficients = std::make_shared<pcl_msgs::msg::ModelCoefficients>();
+        coefficients->values = model.values;
+        filter.model_ = coefficients;
+
+        for (const pcl::IndicesPtr & indices : all_indices) {
+          SCOPED_TRACE(
+            "model " + std::to_string(model.type) + " copy_all_data " +
+            std::to_string(copy_all_data) + " copy_all_fields " + std::to_string(copy_all_fields) +
+            " indices " + (indices ? std::to_string(indices->size()) : std::string("none")));
+          PointCloud2 output;
+          ASSERT_TRUE(filter.computeOutput(input, indices, "", output));
+          const PointCloud2 expected = projectWithPCL(
+            *input, indices, model.type, model.values, copy_all_data, copy_all_fields);
+          expectCloudsNear(output, expected, 1e-5f);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(DirectPathsTest, ExtractIndicesMatchesPCL)
+{
+  // An organized cloud, large enough for the copy to be split between threads
+  const PointCloud2::SharedPtr input = makeCloud(4, 500, 100, 37);
+  const std::size_t nr_points = static_cast<std::size_t>(input->width) * input->height;
+  const std::vector<pcl::IndicesPtr> all_indices{
+    makeIndices(5, nr_points, 30000), makeIndices(6, nr_points, 10), makeIndices(7, nr_points, 0),
+    pcl::IndicesPtr()};
+
+  for (const bool negative : {false, true}) {
+    rclcpp::NodeOptions options;
+    options.parameter_overrides(
+    {
+      {"negative", negative},
+      {"num_threads", 4},
+    });
+    DirectExtractIndices filter(options);
+
+    for (const pcl::IndicesPtr & indices : all_indices) {
+      SCOPED_TRACE(
+        "negative " + std::to_string(negative) + " indices " +
+        (indices ? std::to_string(indices->size()) : std::string("none")));
+      PointCloud2 output;
+      ASSERT_TRUE(filter.computeOutput(input, indices, "", output));
+      expectCloudsNear(output, extractWithPCL(*input, indices, negative), 0.0f);
+
+      std::vector<int> output_indices;
+      ASSERT_TRUE(filter.filterIndices(input, indices, output_indices));
+      const pcl::Indices expected = extractIndicesWithPCL(*input, indices, negative);
+      EXPECT_EQ(output_indices, std::vector<int>(expected.begin(), expected.end()));
+    }
+  }
+}
+
+TEST_F(DirectPathsTest, BoxSetMatchesPCLCropBox)
+{
+  const PointCloud2::SharedPtr input = makeCloud(8, 50000, 1, 53);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::fromROSMsg(*input, *cloud);
+  pcl_ros::XYZOffsets xyz;
+  ASSERT_TRUE(pcl_ros::getXYZOffsets(*input, xyz));
+
+  struct BoxSetCase
+  {
+    std::string name;
+    std::vector<pcl_ros::OrientedBox> boxes;
+  };
+  // Enough boxes for the hierarchy to have several levels
+  const std::vector<BoxSetCase> cases{
+    {"rotated", makeBoxes(9, 1, 1000, 1000)},
+    {"union", makeBoxes(10, 40, 1000, 3)},
+    {"subtract only", makeBoxes(11, 5, 1, 2)},
+    {"union and subtract", makeBoxes(12, 40, 4, 3)},
+  };
+  const pcl::IndicesPtr indices = makeIndices(13, cloud->size(), 20000);
+
+  for (const BoxSetCase & test_case : cases) {
+    // The reference membership of each point, from one pcl::CropBox per box
+    std::vector<std::uint8_t> in_union(cloud->size(), 1), in_subtract(cloud->size(), 0);
+    std::vector<std::uint8_t> ambiguous(cloud->size(), 0);
+    bool has_union = false;
+    for (const pcl_ros::OrientedBox & box : test_case.boxes) {
+      has_union |= !box.subtract;
+    }
+    if (has_union) {
+      std::fill(in_union.begin(), in_union.end(), 0);
+    }
+    for (const pcl_ros::OrientedBox & box : test_case.boxes) {
+      std::vector<std::uint8_t> inside, near_face;
+      cropWithPCL(cloud, box, 1e-4f, inside, near_face);
+      for (std::size_t i = 0; i < cloud->size(); ++i) {
+        (box.subtract ? in_subtract : in_union)[i] |= inside[i];
+        ambiguous[i] |= near_face[i];
+      }
+    }
+
+    pcl_ros::BoxSet box_set;
+    box_set.assign(test_case.boxes);
+    for (const bool negative : {false, true}) {
+      SCOPED_TRACE(test_case.name + " negative " + std::to_string(negative));
+      std::vector<std::uint8_t> expected(cloud->size(), 0);
+      std::size_t nr_expected = 0;
+      for (std::size_t i = 0; i < cloud->size(); ++i) {
+        const bool in_set = in_union[i] && !in_subtract[i];
+        expected[i] = pcl::isFinite((*cloud)[i]) && in_set != negative;
+        nr_expected += expected[i];
+      }
+      EXPECT_GT(nr_expected, 0u);
+
+      // Every point
+      std::vector<int> selected;
+      box_set.select(*input, xyz, negative, nullptr, selected);
+      std::vector<std::uint8_t> actual(cloud->size(), 0);
+      for (const int index : selected) {
+        actual[index] = 1;
+      }
+      std::size_t nr_mismatches = 0;
+      for (std::size_t i = 0; i < cloud->size(); ++i) {
+        nr_mismatches += !ambiguous[i] && actual[i] != expected[i];
+      }
+      EXPECT_EQ(nr_mismatches, 0u);
+
+      // A subset of the points
+      box_set.select(*input, xyz, negative, indices.get(), selected);
+      std::vector<int> expected_selected;
+      for (const int index : *indices) {
+        if (expected[index] || (ambiguous[index] && actual[index])) {
+          expected_selected.push_back(index);
+        }
+      }
+      EXPECT_EQ(selected, expected_selected);
+
+      // keep_organized, the removed points are set to NaN in place
+      PointCloud2 masked = *input;
+      box_set.mask(masked, xyz, negative);
+      const sensor_msgs::msg::PointField & x_field = masked.fields[0];
+      nr_mismatches = 0;
+      for (std::size_t i = 0; i < cloud->size(); ++i) {
+        const bool kept = !std::isnan(readFloat(masked, i, x_field));
+        nr_mismatches += !ambiguous[i] && kept != static_cast<bool>(expected[i]);
+      }
+      EXPECT_EQ(nr_mismatches, 0u);
+    }
+  }
+}
+
+TEST_F(DirectPathsTest, PassThroughMatchesPCL)
+{
+  // An organized cloud with NaN points
+  const PointCloud2::SharedPtr input = makeCloud(14, 400, 100, 29);
+  pcl::PointCloud<pcl::PointXYZI>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::fromROSMsg(*input, *cloud);
+  // Sorted and unique, like the indices of a segmentation
+  const pcl::IndicesPtr indices = makeIndices(15, cloud->size(), 15000);
+  std::sort(indices->begin(), indices->end());
+  indices->erase(std::unique(indices->begin(), indices->end()), indices->end());
+
+  struct PassThroughCase
+  {
+    std::string name;
+    // filter_field_name, empty for none
+    Range range;
+    // filter_field_names
+    std::vector<Range> predicates;
+  };
+  const std::vector<PassThroughCase> cases{
+    {"field", {"z", -0.5, 1.0, false}, {}},
+    {"negative field", {"x", -1.0, 0.5, true}, {}},
+    {"predicates", {"", 0.0, 0.0, false},
+      {{"x", -1.0, 1.5, false}, {"intensity", 50.0, 200.0, false}}},
+    {"negative predicates", {"", 0.0, 0.0, false},
+      {{"y", -0.5, 0.5, true}, {"intensity", 100.0, 150.0, true}}},
+    {"field and predicates", {"z", -1.0, 1.0, false},
+      {{"x", -1.5, 1.5, false}, {"intensity", 20.0, 250.0, true}}},
+  };
+
+  for (const PassThroughCase & test_case : cases) {
+    std::vector<Range> ranges;
+    if (!test_case.range.field.empty()) {
+      ranges.push_back(test_case.range);
+    }
+    std::vector<std::string> fields;
+    std::vector<double> limits_min, limits_max;
+    std::vector<bool> negative;
+    for (const Range & predicate : test_case.predicates) {
+      ranges.push_back(predicate);
+      fields.push_back(predicate.field);
+      limits_min.push_back(predicate.limit_min);
+      limits_max.push_back(predicate.limit_max);
+      negative.push_back(predicate.negative);
+    }
+
+    for (const bool keep_organized : {false, true}) {
+      rclcpp::NodeOptions options;
+      options.parameter_overrides(
+      {
+        {"filter_field_name", test_case.range.field},
+        {"filter_limit_min", test_case.range.limit_min},
+        {"filter_limit_max", test_case.range.limit_max},
+        {"filter_limit_negative", test_case.range.negative},
+        {"filter_field_names", fields},
+        {"filter_limits_min", limits_min},
+        {"filter_limits_max", limits_max},
+        {"filter_limits_negative", negative},
+        {"keep_organized", keep_organized},
+      });
+      DirectPassThrough filter(options);
+
+      // keep_organized ignores the indices
+      const std::vector<pcl::IndicesPtr> all_indices = keep_organized ?
+        std::vector<pcl::IndicesPtr>{pcl::IndicesPtr()} :
+        std::vector<pcl::IndicesPtr>{indices, pcl::IndicesPtr()};
+      for (const pcl::IndicesPtr & subset : all_indices) {
+        SCOPED_TRACE(
+          test_case.name + " keep_organized " + std::to_string(keep_organized) +
+          (subset ? " with indices" : ""));
+        const pcl::Indices passing = passWithPCL(cloud, ranges, subset);
+        EXPECT_GT(passing.size(), 0u);
+
+        pcl::PointCloud<pcl::PointXYZI> expected_cloud;
+        if (keep_organized) {
+          // Like pcl::PassThrough, the x, y and z of the removed points are set to NaN
+          expected_cloud = *cloud;
+          std::vector<std::uint8_t> kept(cloud->size(), 0);
+          for (const int index : passing) {
+            kept[index] = 1;
+          }
+          const float nan = std::numeric_limits<float>::quiet_NaN();
+          for (std::size_t i = 0; i < cloud->size(); ++i) {
+            if (!kept[i]) {
+              expected_cloud[i].x = expected_cloud[i].y = expected_cloud[i].z = nan;
+            }
+          }
+        } else {
+          pcl::copyPointCloud(*cloud, passing, expected_cloud);
+        }
+        PointCloud2 expected;
+        pcl::toROSMsg(expected_cloud, expected);
+
+        PointCloud2 output;
+        ASSERT_TRUE(filter.computeOutput(input, subset, "", output));
+        expectCloudsNear(output, expected, 0.0f);
+
+        std::vector<int> output_indices;
+        ASSERT_TRUE(filter.filterIndices(input, subset, output_indices));
+        EXPECT_EQ(output_indices, std::vector<int>(passing.begin(), passing.end()));
+      }
+    }
+  }
+}
+
+TEST_F(DirectPathsTest, PassThroughNaNRangeValues)
+{
+  // Finite x, y and z everywhere, but NaN intensity on every 7th point
+  const PointCloud2::SharedPtr input = makeCloud(16, 64, 16, 0);
+  pcl::PointCloud<pcl::PointXYZI> cloud;
+  pcl::fromROSMsg(*input, cloud);
+  std::vector<int> nan_indices;
+  for (std::size_t i = 0; i < cloud.size(); i += 7) {
+    cloud[i].intensity = std::numeric_limits<float>::quiet_NaN();
+    nan_indices.push_back(static_cast<int>(i));
+  }
+  pcl::toROSMsg(cloud, *input);
+  input->header.frame_id = "";
+
+  for (const bool negative : {false, true}) {
+    for (const bool keep_organized : {false, true}) {
+      SCOPED_TRACE(
+        std::string(negative ? "negative" : "positive") + " keep_organized " +
+        std::to_string(keep_organized));
+
+      // The reference is the PCLPointCloud2 specialization used by the PCL path of the node
+      pcl::PassThrough<pcl::PCLPointCloud2> impl;
+      pcl::PCLPointCloud2::Ptr pcl_input(new pcl::PCLPointCloud2);
+      pcl_conversions::toPCL(*input, *pcl_input);
+      impl.setInputCloud(pcl_input);
+      impl.setFilterFieldName("intensity");
+      impl.setFilterLimits(50.0f, 200.0f);
+      impl.setNegative(negative);
+      impl.setKeepOrganized(keep_organized);
+      pcl::PCLPointCloud2 pcl_output;
+      impl.filter(pcl_output);
+      PointCloud2 expected;
+      pcl_conversions::moveFromPCL(pcl_output, expected);
+
+      // The single field takes the direct keep_organized path, the predicates the direct path
+      // in both modes
+      for (const bool predicate : {false, true}) {
+        rclcpp::NodeOptions options;
+        options.parameter_overrides(
+        {
+          {"filter_field_name", predicate ? std::string() : std::string("intensity")},
+          {"filter_limit_min", 50.0},
+          {"filter_limit_max", 200.0},
+          {"filter_limit_negative", negative},
+          {"filter_field_names",
+            predicate ? std::vector<std::string>{"intensity"} : std::vector<std::string>()},
+          {"filter_limits_min", predicate ? std::vector<double>{50.0} : std::vector<double>()},
+          {"filter_limits_max", predicate ? std::vector<double>{200.0} : std::vector<double>()},
+          {"filter_limits_negative",
+            predicate ? std::vector<bool>{negative} : std::vector<bool>()},
+          {"keep_organized", keep_organized},
+        });
+        DirectPassThrough filter(options);
+
+        PointCloud2 output;
+        ASSERT_TRUE(filter.computeOutput(input, nullptr, "", output));
+        expectCloudsNear(output, expected, 0.0f);
+
+        if (!predicate) {
+          continue;
+        }
+        // NaN passes both polarities, so the points with a NaN intensity are always selected
+        std::vector<int> output_indices;
+        ASSERT_TRUE(filter.filterIndices(input, nullptr, output_indices));
+        for (const int index : nan_indices) {
+          EXPECT_TRUE(
+            std::binary_search(output_indices.begin(), output_indices.end(), index)) << index;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(DirectPathsTest, PassThroughRejectsMismatchedPredicates)
+{
+  rclcpp::NodeOptions mismatched;
+  mismatched.parameter_overrides(
+  {
+    {"filter_field_names", std::vector<std::string>{"x", "y"}},
+    {"filter_limits_min", std::vector<double>{-1.0}},
+    {"filter_limits_max", std::vector<double>{1.0, 1.0}},
+  });
+  EXPECT_THROW(DirectPassThrough filter(mismatched), std::runtime_error);
+
+  rclcpp::NodeOptions options;
+  options.parameter_overrides(
+  {
+    {"filter_field_names", std::vector<std::string>{"x"}},
+    {"filter_limits_min", std::vector<double>{-1.0}},
+    {"filter_limits_max", std::vector<double>{1.0}},
+  });
+  DirectPassThrough filter(options);
+
+  // Resizing one array at a time leaves the others inconsistent
+  EXPECT_FALSE(
+    filter.set_parameter(
+      rclcpp::Parameter("filter_field_names", std::vector<std::string>{"x", "y"})).successful);
+  EXPECT_EQ(
+    filter.get_parameter("filter_field_names").as_string_array(), std::vector<std::string>{"x"});
+
+  const std::vector<rclcpp::Parameter> resized{
+    rclcpp::Parameter("filter_field_names", std::vector<std::string>{"x", "y"}),
+    rclcpp::Parameter("filter_limits_min", std::vector<double>{-1.0, -0.5}),
+    rclcpp::Parameter("filter_limits_max", std::vector<double>{1.0, 0.5}),
+  };
+  EXPECT_TRUE(filter.set_parameters_atomically(resized).successful);
+}
+
+TEST_F(DirectPathsTest, PointMaskBitmaskRoundTrip)
+{
+  // Rows of 13 points take 2 bytes, the last 3 bits of each row are padding
+  const std::uint32_t width = 13, height = 5;
+  const pcl::IndicesPtr indices = makeIndices(17, width * height, 30);
+  const pcl_ros::PointMask mask(*indices, width * height);
+
+  sensor_msgs::msg::Image image;
+  mask.toImage(width, image);
+  EXPECT_EQ(image.encoding, pcl_ros::PointMask::kBitmaskEncoding);
+  EXPECT_EQ(image.width, width);
+  EXPECT_EQ(image.height, height);
+  EXPECT_EQ(image.step, 2u);
+  ASSERT_EQ(image.data.size(), 10u);
+  // Point u of row v is bit u % 8 of byte u / 8 of the row, least significant bit first
+  for (std::uint32_t v = 0; v < height; ++v) {
+    for (std::uint32_t u = 0; u < width; ++u) {
+      const bool bit = (image.data[v * image.step + u / 8] >> (u % 8)) & 1u;
+      EXPECT_EQ(bit, mask.test(v * width + u)) << "point " << u << ", " << v;
+    }
+    EXPECT_EQ(image.data[v * image.step + 1] & 0xe0, 0);
+  }
+
+  // Padding bits set by the sender are ignored
+  for (std::uint32_t v = 0; v < height; ++v) {
+    image.data[v * image.step + 1] |= 0xe0;
+  }
+  pcl_ros::PointMask decoded;
+  ASSERT_TRUE(decoded.assign(image));
+  EXPECT_EQ(decoded.size(), mask.size());
+  EXPECT_EQ(decoded.words(), mask.words());
+
+  // One mono8 pixel per point is accepted as well
+  sensor_msgs::msg::Image mono8;
+  mono8.encoding = "mono8";
+  mono8.width = width;
+  mono8.height = height;
+  mono8.step = width;
+  mono8.data.assign(width * height, 0);
+  for (const int index : *indices) {
+    mono8.data[index] = 255;
+  }
+  ASSERT_TRUE(decoded.assign(mono8));
+  EXPECT_EQ(decoded.words(), mask.words());
+
+  // A buffer too short for its layout is rejected
+  image.data.pop_back();
+  EXPECT_FALSE(decoded.assign(image));
+}
+
+TEST_F(DirectPathsTest, MaskedPathsMatchIndices)
+{
+  // An organized cloud with NaN points
+  const PointCloud2::SharedPtr input = makeCloud(18, 300, 100, 31);
+  const std::size_t nr_points = static_cast<std::size_t>(input->width) * input->height;
+  const std::vector<pcl_ros::PointMask> masks{
+    pcl_ros::PointMask(*makeIndices(19, nr_points, 12000), nr_points),
+    pcl_ros::PointMask(nr_points, true), pcl_ros::PointMask(nr_points, false)};
+
+  for (const pcl_ros::PointMask & mask : masks) {
+    SCOPED_TRACE("mask of " + std::to_string(mask.count()) + " points");
+    for (const bool negative : {false, true}) {
+      SCOPED_TRACE("ExtractIndices negative " + std::to_string(negative));
+      rclcpp::NodeOptions options;
+      options.parameter_overrides({{"negative", negative}});
+      DirectExtractIndices filter(options);
+      expectMaskMatchesIndices(filter, input, mask);
+    }
+    {
+      SCOPED_TRACE("PassThrough");
+      rclcpp::NodeOptions options;
+      options.parameter_overrides(
+      {
+        {"filter_field_name", "z"},
+        {"filter_limit_min", -0.5},
+        {"filter_limit_max", 1.0},
+      });
+      DirectPassThrough filter(options);
+      expectMaskMatchesIndices(filter, input, mask);
+    }
+    {
+      SCOPED_TRACE("CropBox");
+      DirectCropBox filter{rclcpp::NodeOptions()};
+      expectMaskMatchesIndices(filter, input, mask);
+    }
+  }
+}
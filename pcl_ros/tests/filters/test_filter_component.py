@@ -39,6 +39,9 @@ import launch_testing.markers
 import pytest
 
 from launch_testing_ros import WaitForTopics
+from pcl_msgs.msg import PointIndices
+from point_cloud_interfaces.msg import CompressedPointCloud2
+from sensor_msgs.msg import Image
 from sensor_msgs.msg import PointCloud2
 
 
@@ -79,7 +82,11 @@ def generate_test_description():
 
 class TestFilter(unittest.TestCase):
     def test_filter_output(self):
-        wait_for_topics = WaitForTopics([('output', PointCloud2)], timeout=5.0)
+        output = os.getenv('OUTPUT', 'output')
+        output_types = {'output_indices': PointIndices, 'output_mask': Image,
+                        'output/quantized': CompressedPointCloud2}
+        output_type = output_types.get(output, PointCloud2)
+        wait_for_topics = WaitForTopics([(output, output_type)], timeout=5.0)
         assert wait_for_topics.wait()
-        assert 'output' in wait_for_topics.topics_received(), "Didn't receive message"
+        assert output in wait_for_topics.topics_received(), "Didn't receive message"
         wait_for_topics.shutdown()
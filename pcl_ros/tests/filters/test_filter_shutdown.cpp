@@ -0,0 +1,133 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Check that a filter with worker threads can be destroyed while clouds are in flight: the
+// workers must not run filter () while the state of the derived filter goes away.
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <rclcpp/rclcpp.hpp>
+#include "pcl_ros/filters/statistical_outlier_removal.hpp"
+
+namespace
+{
+sensor_msgs::msg::PointCloud2
+makeCloud(unsigned int seed)
+{
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  for (int i = 0; i < 50000; ++i) {
+    cloud.push_back(
+      pcl::PointXYZ(
+        (rand_r(&seed) % 400 - 200) * 0.01f, (rand_r(&seed) % 400 - 200) * 0.01f,
+        (rand_r(&seed) % 400 - 200) * 0.01f));
+  }
+  sensor_msgs::msg::PointCloud2 msg;
+  pcl::toROSMsg(cloud, msg);
+  // Same frame as the output, so that no transform is involved
+  msg.header.frame_id = "";
+  return msg;
+}
+}  // namespace
+
+class FilterShutdownTest : public ::testing::Test
+{
+protected:
+  static void
+  SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void
+  TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(FilterShutdownTest, DestroyWithCloudsInFlight)
+{
+  const sensor_msgs::msg::PointCloud2 cloud = makeCloud(1);
+  auto driver_node = std::make_shared<rclcpp::Node>(
+    "driver", rclcpp::NodeOptions().use_global_arguments(false));
+  std::atomic<int> nr_received(0);
+  auto pub = driver_node->create_publisher<sensor_msgs::msg::PointCloud2>("input", 10);
+  auto sub = driver_node->create_subscription<sensor_msgs::msg::PointCloud2>(
+    "output", 10, [&nr_received](sensor_msgs::msg::PointCloud2::ConstSharedPtr) {++nr_received;});
+
+  for (int round = 0; round < 10; ++round) {
+    rclcpp::NodeOptions options;
+    options.use_global_arguments(false);
+    options.parameter_overrides({{"mean_k", 32}, {"stddev", 1.0}, {"num_workers", 4}});
+    auto filter = std::make_shared<pcl_ros::StatisticalOutlierRemoval>(options);
+
+    rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2);
+    executor.add_node(filter);
+    executor.add_node(driver_node);
+    std::thread spinner([&executor]() {executor.spin();});
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (pub->get_subscription_count() == 0 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_GT(pub->get_subscription_count(), 0u);
+    // More clouds than workers, so that some are queued and some are being filtered
+    for (int i = 0; i < 8; ++i) {
+      pub->publish(cloud);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10 * round));
+
+    executor.cancel();
+    spinner.join();
+    executor.remove_node(filter);
+    executor.remove_node(driver_node);
+    // The workers still busy with clouds hold the node until their frame is done, the last of
+    // them then destroys it
+    std::weak_ptr<pcl_ros::StatisticalOutlierRemoval> destroyed = filter;
+    filter.reset();
+    while (!destroyed.expired()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  // The test passes as long as the destructions above do not crash or hang
+  SUCCEED() << nr_received.load() << " clouds filtered";
+}
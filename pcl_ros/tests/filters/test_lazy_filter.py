@@ -0,0 +1,120 @@
+#
+# Copyright (c) 2026, perception_pcl contributors.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of the copyright holder nor the names of its
+#       contributors may be used to endorse or promote products derived from
+#       this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+
+import ast
+import os
+import time
+import unittest
+
+import launch
+import launch.actions
+import launch_ros.actions
+import launch_testing.actions
+import launch_testing.markers
+import pytest
+import rclpy
+
+from sensor_msgs.msg import PointCloud2
+
+
+@pytest.mark.launch_test
+@launch_testing.markers.keep_alive
+def generate_test_description():
+    dummy_plugin = os.getenv('DUMMY_PLUGIN')
+    filter_plugin = os.getenv('FILTER_PLUGIN')
+    parameters = ast.literal_eval(os.getenv('PARAMETERS')) if 'PARAMETERS' in os.environ else {}
+    parameters['lazy'] = True
+
+    return launch.LaunchDescription([
+        launch_ros.actions.ComposableNodeContainer(
+            name='filter_container',
+            namespace='',
+            package='rclcpp_components',
+            executable='component_container',
+            composable_node_descriptions=[
+                launch_ros.descriptions.ComposableNode(
+                    package='pcl_ros_tests_filters',
+                    plugin=dummy_plugin,
+                    name='dummy_publisher',
+                ),
+                launch_ros.descriptions.ComposableNode(
+                    package='pcl_ros',
+                    plugin=filter_plugin,
+                    name='filter_node',
+                    remappings=[('/input', '/point_cloud2')],
+                    parameters=[parameters],
+                ),
+            ],
+            output='screen',
+        ),
+        launch_testing.actions.ReadyToTest()
+    ])
+
+
+class TestLazyFilter(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        rclpy.init()
+
+    @classmethod
+    def tearDownClass(cls):
+        rclpy.shutdown()
+
+    def setUp(self):
+        self.node = rclpy.create_node('test_lazy_filter')
+
+    def tearDown(self):
+        self.node.destroy_node()
+
+    def spin_until(self, condition, timeout):
+        end = time.monotonic() + timeout
+        while time.monotonic() < end:
+            if condition():
+                return True
+            rclpy.spin_once(self.node, timeout_sec=0.1)
+        return condition()
+
+    def test_lazy_subscription(self):
+        # Wait for the filter to be loaded, it creates its output publisher
+        assert self.spin_until(lambda: self.node.count_publishers('/output') > 0, 10.0)
+        # Leave time to the input subscription to show up, it must not
+        self.spin_until(lambda: False, 1.0)
+        assert self.node.count_subscribers('/point_cloud2') == 0, \
+            'Subscribed to the input without subscribers to the output'
+
+        received = []
+        subscription = self.node.create_subscription(
+            PointCloud2, '/output', received.append, 10)
+        assert self.spin_until(lambda: self.node.count_subscribers('/point_cloud2') > 0, 5.0), \
+            "Didn't subscribe to the input once the output had a subscriber"
+        assert self.spin_until(lambda: len(received) > 0, 5.0), "Didn't receive message"
+
+        self.node.destroy_subscription(subscription)
+        assert self.spin_until(lambda: self.node.count_subscribers('/point_cloud2') == 0, 5.0), \
+            "Didn't unsubscribe from the input once the output had no subscribers"
@@ -0,0 +1,195 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Check the conversions between PointCloud2 and the fixed-size BoundedPointCloud2, and that a
+// filter with loan_output publishes in loaned messages where the middleware can loan them, and on
+// output otherwise.
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <rclcpp/rclcpp.hpp>
+#include "pcl_ros/filters/passthrough.hpp"
+#include "pcl_ros/transport/bounded_point_cloud.hpp"
+
+using pcl_ros_interfaces::msg::BoundedPointCloud2;
+using sensor_msgs::msg::PointCloud2;
+
+namespace
+{
+PointCloud2
+makeCloud(unsigned int seed, int nr_points)
+{
+  pcl::PointCloud<pcl::PointXYZI> cloud;
+  for (int i = 0; i < nr_points; ++i) {
+    pcl::PointXYZI point;
+    point.x = (rand_r(&seed) % 400 - 200) * 0.01f;
+    point.y = (rand_r(&seed) % 400 - 200) * 0.01f;
+    point.z = (rand_r(&seed) % 400 - 200) * 0.01f;
+    point.intensity = static_cast<float>(rand_r(&seed) % 256);
+    cloud.push_back(point);
+  }
+  PointCloud2 msg;
+  pcl::toROSMsg(cloud, msg);
+  // Same frame as the output, so that no transform is involved
+  msg.header.frame_id = "";
+  return msg;
+}
+}  // namespace
+
+class LoanedOutputTest : public ::testing::Test
+{
+protected:
+  static void
+  SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void
+  TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(LoanedOutputTest, BoundedRoundTrip)
+{
+  PointCloud2 cloud = makeCloud(1, 1000);
+  cloud.header.stamp.sec = 12;
+  cloud.header.stamp.nanosec = 345;
+  // A frame id using the whole capacity, without terminating zero
+  cloud.header.frame_id = std::string(BoundedPointCloud2::FRAME_ID_CAPACITY, 'f');
+
+  // Too large for the stack
+  auto bounded = std::make_unique<BoundedPointCloud2>();
+  ASSERT_TRUE(pcl_ros::fitsBounded(cloud));
+  ASSERT_TRUE(pcl_ros::toBounded(cloud, *bounded));
+  EXPECT_EQ(bounded->data_size, cloud.data.size());
+
+  PointCloud2 decoded;
+  ASSERT_TRUE(pcl_ros::fromBounded(*bounded, decoded));
+  EXPECT_EQ(decoded, cloud);
+}
+
+TEST_F(LoanedOutputTest, BoundedRejectsLargeClouds)
+{
+  auto bounded = std::make_unique<BoundedPointCloud2>();
+  const PointCloud2 cloud = makeCloud(2, 100);
+
+  PointCloud2 long_frame = cloud;
+  long_frame.header.frame_id = std::string(BoundedPointCloud2::FRAME_ID_CAPACITY + 1, 'f');
+  EXPECT_FALSE(pcl_ros::toBounded(long_frame, *bounded));
+
+  PointCloud2 long_name = cloud;
+  long_name.fields[0].name =
+    std::string(pcl_ros_interfaces::msg::BoundedPointField::NAME_CAPACITY + 1, 'x');
+  EXPECT_FALSE(pcl_ros::toBounded(long_name, *bounded));
+
+  PointCloud2 many_fields = cloud;
+  many_fields.fields.resize(BoundedPointCloud2::FIELDS_CAPACITY + 1, cloud.fields[0]);
+  EXPECT_FALSE(pcl_ros::toBounded(many_fields, *bounded));
+
+  PointCloud2 large_data = cloud;
+  large_data.data.resize(BoundedPointCloud2::DATA_CAPACITY + 1);
+  EXPECT_FALSE(pcl_ros::toBounded(large_data, *bounded));
+
+  // Received messages are not trusted either
+  PointCloud2 decoded;
+  ASSERT_TRUE(pcl_ros::toBounded(cloud, *bounded));
+  bounded->nr_fields = BoundedPointCloud2::FIELDS_CAPACITY + 1;
+  EXPECT_FALSE(pcl_ros::fromBounded(*bounded, decoded));
+  bounded->nr_fields = static_cast<std::uint32_t>(cloud.fields.size());
+  bounded->data_size = BoundedPointCloud2::DATA_CAPACITY + 1;
+  EXPECT_FALSE(pcl_ros::fromBounded(*bounded, decoded));
+}
+
+TEST_F(LoanedOutputTest, FilterPublishesLoanedOrFallsBack)
+{
+  rclcpp::NodeOptions options;
+  options.parameter_overrides(
+  {
+    {"loan_output", true},
+    {"filter_field_name", "z"},
+    {"filter_limit_min", -1.0},
+    {"filter_limit_max", 1.0},
+  });
+  auto filter = std::make_shared<pcl_ros::PassThrough>(options);
+  auto listener = std::make_shared<rclcpp::Node>("loaned_output_listener");
+
+  // The filter publishes BoundedPointCloud2 messages with the same middleware and default QoS
+  const bool can_loan =
+    listener->create_publisher<BoundedPointCloud2>("loan_probe", 1)->can_loan_messages();
+
+  std::atomic<int> nr_clouds{0}, nr_bounded{0};
+  auto sub_output = listener->create_subscription<PointCloud2>(
+    "output", 10, [&nr_clouds](PointCloud2::ConstSharedPtr cloud) {
+      EXPECT_GT(cloud->width, 0u);
+      ++nr_clouds;
+    });
+  auto sub_bounded = listener->create_subscription<BoundedPointCloud2>(
+    "output_bounded", 10, [&nr_bounded](BoundedPointCloud2::ConstSharedPtr bounded) {
+      PointCloud2 cloud;
+      EXPECT_TRUE(pcl_ros::fromBounded(*bounded, cloud));
+      EXPECT_GT(cloud.width, 0u);
+      ++nr_bounded;
+    });
+  auto pub_input = listener->create_publisher<PointCloud2>("input", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(filter);
+  executor.add_node(listener);
+  const PointCloud2 input = makeCloud(3, 10000);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (nr_clouds + nr_bounded < 3 && std::chrono::steady_clock::now() < deadline) {
+    pub_input->publish(input);
+    executor.spin_some(std::chrono::milliseconds(100));
+  }
+
+  if (can_loan) {
+    EXPECT_GE(nr_bounded.load(), 3);
+    EXPECT_EQ(nr_clouds.load(), 0);
+  } else {
+    EXPECT_GE(nr_clouds.load(), 3);
+    EXPECT_EQ(nr_bounded.load(), 0);
+  }
+}
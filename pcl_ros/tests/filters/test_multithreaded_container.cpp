@@ -0,0 +1,241 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Check that filters composed in one container scale with the threads of a
+// MultiThreadedExecutor. Each StatisticalOutlierRemoval node is fed in closed loop, with its next
+// cloud as soon as its previous output is received, first with a single executor thread and then
+// with one thread per node. The speedup is recorded as a test property, and only checked to be
+// near linear if PCL_ROS_BENCHMARK is set.
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include "pcl_ros/filters/statistical_outlier_removal.hpp"
+
+namespace
+{
+const int kNrFrames = 20;
+
+sensor_msgs::msg::PointCloud2
+makeCloud(unsigned int seed)
+{
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  for (int i = 0; i < 20000; ++i) {
+    cloud.push_back(
+      pcl::PointXYZ(
+        (rand_r(&seed) % 400 - 200) * 0.01f, (rand_r(&seed) % 400 - 200) * 0.01f,
+        (rand_r(&seed) % 400 - 200) * 0.01f));
+  }
+  sensor_msgs::msg::PointCloud2 msg;
+  pcl::toROSMsg(cloud, msg);
+  // Same frame as the output, so that no transform is involved
+  msg.header.frame_id = "";
+  return msg;
+}
+
+/** \brief Feed one filter in closed loop and count its outputs. */
+class Driver
+{
+public:
+  Driver(
+    rclcpp::Node & node, const std::string & suffix,
+    const sensor_msgs::msg::PointCloud2 & cloud)
+  : cloud_(cloud), nr_received_(0)
+  {
+    pub_ = node.create_publisher<sensor_msgs::msg::PointCloud2>("input" + suffix, 1);
+    sub_ = node.create_subscription<sensor_msgs::msg::PointCloud2>(
+      "output" + suffix, 1,
+      [this](sensor_msgs::msg::PointCloud2::ConstSharedPtr) {
+        if (++nr_received_ < kNrFrames) {
+          publish();
+        }
+      });
+  }
+
+  void
+  publish()
+  {
+    pub_->publish(cloud_);
+  }
+
+  bool
+  connected() const
+  {
+    return pub_->get_subscription_count() > 0 && sub_->get_publisher_count() > 0;
+  }
+
+  bool
+  done() const
+  {
+    return nr_received_.load() >= kNrFrames;
+  }
+
+private:
+  sensor_msgs::msg::PointCloud2 cloud_;
+  std::atomic<int> nr_received_;
+  rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pub_;
+  rclcpp::Subscription<sensor_msgs::msg::PointCloud2>::SharedPtr sub_;
+};
+
+/** \brief Wait until \a condition holds, for at most \a timeout. */
+template<typename ConditionT>
+bool
+waitFor(ConditionT condition, std::chrono::seconds timeout)
+{
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+/** \brief Run \a nr_filters filters and their drivers in one executor with \a nr_threads threads.
+  * \return the time taken to process kNrFrames clouds per filter, in seconds
+  */
+double
+runContainer(int nr_filters, int nr_threads)
+{
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), nr_threads);
+  auto driver_node = std::make_shared<rclcpp::Node>(
+    "driver", rclcpp::NodeOptions().use_global_arguments(false));
+  const sensor_msgs::msg::PointCloud2 cloud = makeCloud(1);
+
+  std::vector<std::shared_ptr<pcl_ros::StatisticalOutlierRemoval>> filters;
+  std::vector<std::unique_ptr<Driver>> drivers;
+  for (int i = 0; i < nr_filters; ++i) {
+    const std::string suffix = "_" + std::to_string(i);
+    rclcpp::NodeOptions options;
+    options.use_global_arguments(false);
+    options.arguments(
+      {"--ros-args", "-r", "__node:=filter" + suffix, "-r", "input:=input" + suffix,
+        "-r", "output:=output" + suffix});
+    options.parameter_overrides({{"mean_k", 16}, {"stddev", 1.0}});
+    filters.push_back(std::make_shared<pcl_ros::StatisticalOutlierRemoval>(options));
+    executor.add_node(filters.back());
+    drivers.emplace_back(new Driver(*driver_node, suffix, cloud));
+  }
+  executor.add_node(driver_node);
+  std::thread spinner([&executor]() {executor.spin();});
+
+  const auto all = [&drivers](bool (Driver::* test)() const) {
+      return std::all_of(
+        drivers.begin(), drivers.end(),
+        [test](const std::unique_ptr<Driver> & driver) {return ((*driver).*test)();});
+    };
+  double elapsed = -1.0;
+  if (waitFor([&all]() {return all(&Driver::connected);}, std::chrono::seconds(10))) {
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto & driver : drivers) {
+      driver->publish();
+    }
+    if (waitFor([&all]() {return all(&Driver::done);}, std::chrono::seconds(120))) {
+      elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+  }
+  executor.cancel();
+  spinner.join();
+  return elapsed;
+}
+}  // namespace
+
+class MultithreadedContainerTest : public ::testing::Test
+{
+protected:
+  static void
+  SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void
+  TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(MultithreadedContainerTest, FiltersScaleWithExecutorThreads)
+{
+  // Leave a core to the middleware threads
+  const int nr_cores = static_cast<int>(std::thread::hardware_concurrency());
+  if (nr_cores < 3) {
+    GTEST_SKIP() << "Needs at least 3 cores, found " << nr_cores;
+  }
+  const int nr_filters = std::min(4, nr_cores - 1);
+
+  const double serial = runContainer(nr_filters, 1);
+  const double parallel = runContainer(nr_filters, nr_filters);
+  ASSERT_GT(serial, 0.0) << "The filters did not process all the clouds with one thread";
+  ASSERT_GT(parallel, 0.0) << "The filters did not process all the clouds with many threads";
+
+  const double speedup = serial / parallel;
+  RecordProperty("nr_filters", nr_filters);
+  RecordProperty("speedup", std::to_string(speedup));
+  std::cout << nr_filters << " filters: " << serial << " s with 1 thread, " << parallel <<
+    " s with " << nr_filters << " threads, speedup " << speedup << std::endl;
+  // Wall-clock ratios are not reliable on shared machines, only checked when benchmarking
+  if (std::getenv("PCL_ROS_BENCHMARK") != nullptr) {
+    EXPECT_GT(speedup, 0.6 * nr_filters);
+  }
+}
+
+TEST_F(MultithreadedContainerTest, TfCallbackGroupIsConfigurable)
+{
+  for (const std::string type : {"dedicated", "mutually_exclusive", "reentrant"}) {
+    rclcpp::NodeOptions options;
+    options.use_global_arguments(false);
+    options.parameter_overrides({{"tf_callback_group", type}});
+    EXPECT_NO_THROW(std::make_shared<pcl_ros::StatisticalOutlierRemoval>(options)) << type;
+  }
+  rclcpp::NodeOptions options;
+  options.use_global_arguments(false);
+  options.parameter_overrides({{"tf_callback_group", "none"}});
+  EXPECT_THROW(std::make_shared<pcl_ros::StatisticalOutlierRemoval>(options), std::runtime_error);
+}
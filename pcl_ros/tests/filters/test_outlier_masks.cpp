@@ -0,0 +1,310 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Check that the outlier masks computed on the PointCloud2 buffers give the same result as the
+// PCL filters they replace, or as a brute force count of the neighbors.
+
+#include <gtest/gtest.h>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/common/point_tests.h>
+#include <pcl/filters/statistical_outlier_removal.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/organized.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "pcl_ros/filters/outlier_masks.hpp"
+#include "pcl_ros/filters/voxel_hash.hpp"
+
+namespace
+{
+/** \brief A seeded cloud of clustered points, with sparse outliers and a few NaN points. */
+pcl::PointCloud<pcl::PointXYZ>::Ptr
+makeCloud(unsigned int seed, int nr_points)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  for (int i = 0; i < nr_points; ++i) {
+    const float scale = i % 10 == 0 ? 0.5f : 0.01f;
+    cloud->push_back(
+      pcl::PointXYZ(
+        (rand_r(&seed) % 200 - 100) * scale, (rand_r(&seed) % 200 - 100) * scale,
+        (rand_r(&seed) % 200 - 100) * scale));
+    if (i % 97 == 0) {
+      cloud->back().x = nan;
+    }
+  }
+  cloud->is_dense = false;
+  return cloud;
+}
+
+/** \brief A seeded cloud of points uniformly spread in the unit cube, with a few NaN points.
+  * The coordinates are not on a grid, so that no distance falls exactly on the radius.
+  */
+pcl::PointCloud<pcl::PointXYZ>::Ptr
+makeUniformCloud(unsigned int seed, int nr_points)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  for (int i = 0; i < nr_points; ++i) {
+    cloud->push_back(
+      pcl::PointXYZ(
+        rand_r(&seed) / static_cast<float>(RAND_MAX), rand_r(&seed) / static_cast<float>(RAND_MAX),
+        rand_r(&seed) / static_cast<float>(RAND_MAX)));
+    if (i % 97 == 0) {
+      cloud->back().z = std::numeric_limits<float>::quiet_NaN();
+    }
+  }
+  cloud->is_dense = false;
+  return cloud;
+}
+
+/** \brief The radius outlier mask by brute force: a finite candidate is an inlier if more than
+  * \a min_neighbors candidates, itself included, lie within \a radius of it.
+  */
+std::vector<std::uint8_t>
+bruteForceRadiusMask(
+  const pcl::PointCloud<pcl::PointXYZ> & cloud, const std::vector<int> & candidates,
+  float radius, int min_neighbors, bool negative)
+{
+  std::vector<std::uint8_t> keep(cloud.size(), 0);
+  for (const int i : candidates) {
+    if (!pcl::isFinite(cloud[i])) {
+      continue;
+    }
+    int found = 0;
+    for (const int j : candidates) {
+      const float dx = cloud[j].x - cloud[i].x;
+      const float dy = cloud[j].y - cloud[i].y;
+      const float dz = cloud[j].z - cloud[i].z;
+      found += dx * dx + dy * dy + dz * dz <= radius * radius;
+    }
+    keep[i] = (found > min_neighbors) != negative;
+  }
+  return keep;
+}
+
+/** \brief A seeded organized cloud, as seen by a pinhole camera, with a few NaN points. */
+pcl::PointCloud<pcl::PointXYZ>::Ptr
+makeOrganizedCloud(unsigned int seed, int width, int height)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(
+    new pcl::PointCloud<pcl::PointXYZ>(width, height));
+  const float focal = 500.0f;
+  for (int v = 0; v < height; ++v) {
+    for (int u = 0; u < width; ++u) {
+      // A slanted plane, with some depth noise and a few far returns
+      float z = 2.0f + 0.002f * u + 0.0001f * (rand_r(&seed) % 100);
+      if (rand_r(&seed) % 50 == 0) {
+        z += 1.0f;
+      }
+      pcl::PointXYZ & point = cloud->at(u, v);
+      point.x = (u - width / 2) * z / focal;
+      point.y = (v - height / 2) * z / focal;
+      point.z = z;
+      if (rand_r(&seed) % 101 == 0) {
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN();
+      }
+    }
+  }
+  cloud->is_dense = false;
+  return cloud;
+}
+
+/** \brief The mask of the points kept by the PCLPointCloud2 version of
+  * pcl::StatisticalOutlierRemoval, the one run by the filter nodes.
+  */
+std::vector<std::uint8_t>
+pclStatisticalMask(
+  const pcl::PointCloud<pcl::PointXYZ> & cloud, int mean_k, double stddev_mult, bool negative)
+{
+  pcl::PCLPointCloud2::Ptr input(new pcl::PCLPointCloud2);
+  pcl::toPCLPointCloud2(cloud, *input);
+  pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2> sor;
+  sor.setInputCloud(input);
+  sor.setMeanK(mean_k);
+  sor.setStddevMulThresh(stddev_mult);
+  sor.setNegative(negative);
+  pcl::Indices indices;
+  sor.filter(indices);
+  std::vector<std::uint8_t> keep(cloud.size(), 0);
+  for (const auto index : indices) {
+    keep[index] = 1;
+  }
+  return keep;
+}
+}  // namespace
+
+TEST(OutlierMasks, StatisticalMatchesPCL)
+{
+  const pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = makeCloud(1, 5000);
+  pcl::search::KdTree<pcl::PointXYZ> search;
+  search.setInputCloud(cloud);
+
+  for (const int mean_k : {2, 8, 30}) {
+    for (const bool negative : {false, true}) {
+      const std::vector<std::uint8_t> expected = pclStatisticalMask(*cloud, mean_k, 1.0, negative);
+      // The kdtree and parallel engines
+      for (const unsigned int num_threads : {1u, 4u}) {
+        std::vector<std::uint8_t> keep(cloud->size(), 1);
+        pcl_ros::markStatisticalOutliers(
+          search, *cloud, mean_k, 1.0, negative, num_threads, nullptr, keep);
+        std::size_t nr_different = 0;
+        for (std::size_t i = 0; i < keep.size(); ++i) {
+          nr_different += (keep[i] != 0) != (expected[i] != 0);
+        }
+        EXPECT_EQ(nr_different, 0u) << "mean_k " << mean_k << ", negative " << negative <<
+          ", " << num_threads << " threads";
+      }
+    }
+  }
+}
+
+TEST(OutlierMasks, StatisticalKeepsNonFinitePoints)
+{
+  const pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = makeCloud(2, 1000);
+  pcl::search::KdTree<pcl::PointXYZ> search;
+  search.setInputCloud(cloud);
+
+  std::vector<std::uint8_t> keep(cloud->size(), 1);
+  pcl_ros::markStatisticalOutliers(search, *cloud, 8, 1.0, false, 1, nullptr, keep);
+  std::vector<std::uint8_t> keep_negative(cloud->size(), 1);
+  pcl_ros::markStatisticalOutliers(search, *cloud, 8, 1.0, true, 1, nullptr, keep_negative);
+  for (std::size_t i = 0; i < cloud->size(); i += 97) {
+    EXPECT_TRUE(keep[i]) << "point " << i;
+    EXPECT_FALSE(keep_negative[i]) << "point " << i;
+  }
+}
+
+TEST(OutlierMasks, StatisticalOrganizedMatchesPCL)
+{
+  // PCL searches organized clouds in their image rather than with a kd-tree
+  const pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = makeOrganizedCloud(3, 64, 48);
+  pcl::search::OrganizedNeighbor<pcl::PointXYZ> search;
+  search.setInputCloud(cloud);
+
+  const std::vector<std::uint8_t> expected = pclStatisticalMask(*cloud, 8, 1.0, false);
+  std::vector<std::uint8_t> keep(cloud->size(), 1);
+  pcl_ros::markStatisticalOutliers(search, *cloud, 8, 1.0, false, 1, nullptr, keep);
+  EXPECT_EQ(keep, expected);
+}
+
+TEST(OutlierMasks, RadiusMatchesBruteForce)
+{
+  const pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = makeUniformCloud(4, 3000);
+  sensor_msgs::msg::PointCloud2 msg;
+  pcl::toROSMsg(*cloud, msg);
+  pcl_ros::XYZOffsets xyz;
+  ASSERT_TRUE(pcl_ros::getXYZOffsets(msg, xyz));
+  pcl::search::KdTree<pcl::PointXYZ> search;
+  search.setInputCloud(cloud);
+
+  std::vector<int> all(cloud->size()), half;
+  for (int i = 0; i < static_cast<int>(cloud->size()); ++i) {
+    all[i] = i;
+    if (i % 2 == 0) {
+      half.push_back(i);
+    }
+  }
+
+  for (const float radius : {0.05f, 0.1f}) {
+    for (const bool negative : {false, true}) {
+      const std::vector<std::uint8_t> expected =
+        bruteForceRadiusMask(*cloud, all, radius, 4, negative);
+
+      // The kdtree engine, which only runs on whole clouds
+      std::vector<std::uint8_t> keep(cloud->size(), 1);
+      pcl_ros::markRadiusOutliers(search, *cloud, radius, 4, negative, nullptr, keep);
+      EXPECT_EQ(keep, expected) << "kdtree, radius " << radius << ", negative " << negative;
+
+      // On the survivors of a previous test, which are the only points tested and counted
+      std::vector<std::uint8_t> survivors(cloud->size(), 0);
+      for (const int i : half) {
+        survivors[i] = 1;
+      }
+      keep = survivors;
+      pcl_ros::markRadiusOutliers(search, *cloud, radius, 4, negative, &survivors, keep);
+      EXPECT_EQ(keep, bruteForceRadiusMask(*cloud, half, radius, 4, negative)) <<
+        "kdtree on survivors, radius " << radius << ", negative " << negative;
+
+      // The voxel_hash engine, with and without indices
+      for (const unsigned int num_threads : {1u, 4u}) {
+        keep.assign(cloud->size(), 1);
+        pcl_ros::markRadiusOutliersVoxelHash(
+          msg, xyz, nullptr, radius, 4, negative, false, num_threads, keep);
+        EXPECT_EQ(keep, expected) << "voxel_hash, radius " << radius << ", negative " <<
+          negative << ", " << num_threads << " threads";
+
+        keep.assign(cloud->size(), 0);
+        for (const int index : half) {
+          keep[index] = 1;
+        }
+        pcl_ros::markRadiusOutliersVoxelHash(
+          msg, xyz, &half, radius, 4, negative, false, num_threads, keep);
+        EXPECT_EQ(keep, bruteForceRadiusMask(*cloud, half, radius, 4, negative)) <<
+          "voxel_hash with indices, radius " << radius << ", negative " << negative << ", " <<
+          num_threads << " threads";
+      }
+    }
+  }
+}
+
+TEST(OutlierMasks, RadiusVoxelHashRejectsBadRadius)
+{
+  const pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = makeUniformCloud(5, 100);
+  cloud->back().x = 3.0e38f;
+  sensor_msgs::msg::PointCloud2 msg;
+  pcl::toROSMsg(*cloud, msg);
+  pcl_ros::XYZOffsets xyz;
+  ASSERT_TRUE(pcl_ros::getXYZOffsets(msg, xyz));
+
+  for (const double radius : {0.0, -1.0, 1e-320}) {
+    std::vector<std::uint8_t> keep(cloud->size(), 1);
+    pcl_ros::markRadiusOutliersVoxelHash(msg, xyz, nullptr, radius, 0, false, false, 1, keep);
+    EXPECT_EQ(keep, std::vector<std::uint8_t>(cloud->size(), 0)) << "radius " << radius;
+  }
+  // Points far outside of the range of the cells still get the exact count
+  std::vector<std::uint8_t> keep(cloud->size(), 1);
+  pcl_ros::markRadiusOutliersVoxelHash(msg, xyz, nullptr, 1e-30, 0, false, false, 1, keep);
+  std::vector<int> all(cloud->size());
+  for (int i = 0; i < static_cast<int>(cloud->size()); ++i) {
+    all[i] = i;
+  }
+  EXPECT_EQ(keep, bruteForceRadiusMask(*cloud, all, 1e-30f, 0, false));
+}
@@ -0,0 +1,130 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Check that parallelFor covers every item once on the persistent threads of a ThreadPool, from
+// concurrent and nested calls.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "pcl_ros/filters/parallel_for.hpp"
+
+TEST(ParallelFor, CoversEveryItemOnce)
+{
+  pcl_ros::ThreadPool pool;
+  pcl_ros::ThreadPool::Scope scope(pool);
+  for (std::size_t size : {0, 1, 7, 100, 1001}) {
+    for (unsigned int num_threads : {1, 3, 8}) {
+      std::vector<int> counts(size, 0);
+      pcl_ros::parallelFor(
+        size, num_threads, 10, [&counts](std::size_t begin, std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i) {
+            ++counts[i];
+          }
+        });
+      for (int count : counts) {
+        ASSERT_EQ(count, 1);
+      }
+    }
+  }
+}
+
+TEST(ParallelFor, ReusesThePoolThreads)
+{
+  pcl_ros::ThreadPool pool;
+  pcl_ros::ThreadPool::Scope scope(pool);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  for (int run = 0; run < 50; ++run) {
+    pcl_ros::parallelFor(
+      4000, 4, 1000, [&mutex, &threads](std::size_t, std::size_t) {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+      });
+  }
+  // The calling thread and at most 3 workers, whatever the number of calls
+  EXPECT_LE(threads.size(), 4u);
+}
+
+TEST(ParallelFor, ConcurrentAndNestedCalls)
+{
+  pcl_ros::ThreadPool pool;
+  std::atomic<std::size_t> total(0);
+  std::vector<std::thread> callers;
+  for (int caller = 0; caller < 4; ++caller) {
+    callers.emplace_back(
+      [&pool, &total]() {
+        pcl_ros::ThreadPool::Scope scope(pool);
+        for (int run = 0; run < 20; ++run) {
+          pcl_ros::parallelFor(
+            1000, 4, 100, [&total](std::size_t begin, std::size_t end) {
+              total += end - begin;
+              pcl_ros::parallelFor(
+                64, 3, 8, [&total](std::size_t inner_begin, std::size_t inner_end) {
+                  total += inner_end - inner_begin;
+                });
+            });
+        }
+      });
+  }
+  for (std::thread & caller : callers) {
+    caller.join();
+  }
+  // 4 outer chunks of 250 items, each running the 64 inner items
+  EXPECT_EQ(total.load(), 4u * 20u * (1000u + 4u * 64u));
+}
+
+TEST(ParallelFor, RethrowsTheExceptionOfAChunk)
+{
+  pcl_ros::ThreadPool pool;
+  pcl_ros::ThreadPool::Scope scope(pool);
+  EXPECT_THROW(
+    pcl_ros::parallelFor(
+      100, 4, 1, [](std::size_t begin, std::size_t) {
+        if (begin > 0) {
+          throw std::runtime_error("chunk failed");
+        }
+      }), std::runtime_error);
+  // The pool is still usable
+  std::atomic<std::size_t> total(0);
+  pcl_ros::parallelFor(
+    100, 4, 1, [&total](std::size_t begin, std::size_t end) {total += end - begin;});
+  EXPECT_EQ(total.load(), 100u);
+}
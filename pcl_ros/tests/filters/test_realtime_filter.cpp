@@ -0,0 +1,287 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+// Check that the processing path of a filter in realtime mode does not allocate once warmed up,
+// by counting the calls to malloc made by the test thread.
+
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include "pcl_ros/filters/passthrough.hpp"
+
+extern "C" {
+void * __libc_malloc(std::size_t size);
+void * __libc_calloc(std::size_t count, std::size_t size);
+void * __libc_realloc(void * ptr, std::size_t size);
+}
+
+namespace
+{
+// Only the test thread is counted, the middleware threads allocate on their own
+thread_local bool t_counting = false;
+thread_local std::size_t t_allocations = 0;
+
+/** \brief Count the allocations made by the test thread while in scope. */
+class AllocationCounter
+{
+public:
+  AllocationCounter()
+  {
+    t_allocations = 0;
+    t_counting = true;
+  }
+
+  ~AllocationCounter()
+  {
+    t_counting = false;
+  }
+
+  std::size_t
+  count() const
+  {
+    return t_allocations;
+  }
+};
+}  // namespace
+
+// glibc lets the program replace malloc, the C++ operator new goes through it as well
+extern "C" void *
+malloc(std::size_t size)
+{
+  if (t_counting) {
+    ++t_allocations;
+  }
+  return __libc_malloc(size);
+}
+
+extern "C" void *
+calloc(std::size_t count, std::size_t size)
+{
+  if (t_counting) {
+    ++t_allocations;
+  }
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *
+realloc(void * ptr, std::size_t size)
+{
+  if (t_counting) {
+    ++t_allocations;
+  }
+  return __libc_realloc(ptr, size);
+}
+
+namespace
+{
+/** \brief Expose the processing path of PassThrough without the subscriptions. */
+class RealtimePassThrough : public pcl_ros::PassThrough
+{
+public:
+  explicit RealtimePassThrough(const rclcpp::NodeOptions & options)
+  : PassThrough(options) {}
+
+  using pcl_ros::Filter::computeOutput;
+  using pcl_ros::Filter::input_indices_callback;
+  using pcl_ros::PassThrough::filterIndices;
+};
+
+sensor_msgs::msg::PointCloud2::ConstSharedPtr
+makeCloud(unsigned int seed)
+{
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  for (int i = 0; i < 10000; ++i) {
+    cloud.push_back(
+      pcl::PointXYZ(
+        (rand_r(&seed) % 400 - 200) * 0.01f, (rand_r(&seed) % 400 - 200) * 0.01f,
+        (rand_r(&seed) % 400 - 200) * 0.01f));
+  }
+  auto msg = std::make_shared<sensor_msgs::msg::PointCloud2>();
+  pcl::toROSMsg(cloud, *msg);
+  // Same frame as the output, so that no transform is involved
+  msg->header.frame_id = "";
+  return msg;
+}
+
+/** \brief Subscribe \a node to the output of \a output_mode, counting the received messages. */
+rclcpp::SubscriptionBase::SharedPtr
+subscribeOutput(
+  const rclcpp::Node::SharedPtr & node, const std::string & output_mode,
+  const std::shared_ptr<std::atomic<int>> & nr_received)
+{
+  if (output_mode == "indices") {
+    return node->create_subscription<pcl_msgs::msg::PointIndices>(
+      "output_indices", 10, [nr_received](pcl_msgs::msg::PointIndices::ConstSharedPtr) {
+        ++*nr_received;
+      });
+  }
+  if (output_mode == "mask") {
+    return node->create_subscription<sensor_msgs::msg::Image>(
+      "output_mask", 10, [nr_received](sensor_msgs::msg::Image::ConstSharedPtr) {
+        ++*nr_received;
+      });
+  }
+  return node->create_subscription<sensor_msgs::msg::PointCloud2>(
+    "output", 10, [nr_received](sensor_msgs::msg::PointCloud2::ConstSharedPtr) {
+      ++*nr_received;
+    });
+}
+
+std::shared_ptr<RealtimePassThrough>
+makeFilter(const std::string & output_mode)
+{
+  rclcpp::NodeOptions options;
+  options.parameter_overrides(
+  {
+    {"realtime", true},
+    {"output_mode", output_mode},
+    {"reserve_output_bytes", 10000 * 16},
+    {"reserve_output_indices", 10000},
+    {"filter_field_names", std::vector<std::string>{"x", "z"}},
+    {"filter_limits_min", std::vector<double>{-1.0, -1.0}},
+    {"filter_limits_max", std::vector<double>{1.0, 1.0}},
+  });
+  return std::make_shared<RealtimePassThrough>(options);
+}
+}  // namespace
+
+class RealtimeFilterTest : public ::testing::Test
+{
+protected:
+  static void
+  SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void
+  TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(RealtimeFilterTest, ComputeOutputDoesNotAllocate)
+{
+  auto filter = makeFilter("cloud");
+  std::vector<sensor_msgs::msg::PointCloud2::ConstSharedPtr> inputs{
+    makeCloud(1), makeCloud(2), makeCloud(3)};
+  sensor_msgs::msg::PointCloud2 output;
+
+  // Warm up, the output grows to the largest result
+  for (const auto & input : inputs) {
+    ASSERT_TRUE(filter->computeOutput(input, nullptr, "", output));
+  }
+  const std::size_t nr_warm = output.width;
+
+  AllocationCounter counter;
+  for (int frame = 0; frame < 100; ++frame) {
+    filter->computeOutput(inputs[frame % inputs.size()], nullptr, "", output);
+  }
+  const std::size_t nr_allocations = counter.count();
+  EXPECT_EQ(nr_allocations, 0u);
+  EXPECT_GT(nr_warm, 0u);
+}
+
+TEST_F(RealtimeFilterTest, FilterIndicesDoesNotAllocate)
+{
+  auto filter = makeFilter("indices");
+  std::vector<sensor_msgs::msg::PointCloud2::ConstSharedPtr> inputs{
+    makeCloud(4), makeCloud(5), makeCloud(6)};
+  std::vector<int> output_indices;
+
+  for (const auto & input : inputs) {
+    ASSERT_TRUE(filter->filterIndices(input, nullptr, output_indices));
+  }
+
+  AllocationCounter counter;
+  for (int frame = 0; frame < 100; ++frame) {
+    filter->filterIndices(inputs[frame % inputs.size()], nullptr, output_indices);
+  }
+  const std::size_t nr_allocations = counter.count();
+  EXPECT_EQ(nr_allocations, 0u);
+}
+
+TEST_F(RealtimeFilterTest, InputCallbackDoesNotAllocate)
+{
+  auto listener = std::make_shared<rclcpp::Node>("realtime_listener");
+  // The whole path of a received message: the checks, the reset of the output message, the
+  // filter and the publish to a matched subscription
+  for (const std::string output_mode : {"cloud", "indices", "mask"}) {
+    SCOPED_TRACE("output_mode " + output_mode);
+    auto filter = makeFilter(output_mode);
+    auto nr_received = std::make_shared<std::atomic<int>>(0);
+    auto subscription = subscribeOutput(listener, output_mode, nr_received);
+    const std::string topic = subscription->get_topic_name();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (filter->count_subscribers(topic) == 0 && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_GT(filter->count_subscribers(topic), 0u);
+
+    std::vector<sensor_msgs::msg::PointCloud2::ConstSharedPtr> inputs{
+      makeCloud(7), makeCloud(8), makeCloud(9)};
+    // Warm up, the outputs and the middleware buffers grow to the largest result
+    for (int frame = 0; frame < 30; ++frame) {
+      filter->input_indices_callback(inputs[frame % inputs.size()], nullptr);
+    }
+
+    std::size_t nr_allocations;
+    {
+      AllocationCounter counter;
+      for (int frame = 0; frame < 100; ++frame) {
+        filter->input_indices_callback(inputs[frame % inputs.size()], nullptr);
+      }
+      nr_allocations = counter.count();
+    }
+    EXPECT_EQ(nr_allocations, 0u);
+
+    // The frames were published, not dropped before the filter
+    while (*nr_received == 0 && std::chrono::steady_clock::now() < deadline) {
+      rclcpp::spin_some(listener);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GT(*nr_received, 0);
+  }
+}
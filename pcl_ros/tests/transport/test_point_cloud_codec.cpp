@@ -0,0 +1,379 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, perception_pcl contributors.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp/serialization.hpp>
+#include "pcl_ros/transport/compressed_point_cloud.hpp"
+#include "pcl_ros/transport/point_cloud_codec.hpp"
+
+using point_cloud_interfaces::msg::CompressedPointCloud2;
+using sensor_msgs::msg::PointCloud2;
+using sensor_msgs::msg::PointField;
+
+namespace
+{
+/** \brief The point layout of a spinning lidar, padded to 32 bytes. */
+struct LidarPoint
+{
+  float x;
+  float y;
+  float z;
+  float intensity;
+  std::uint16_t ring;
+  std::uint8_t padding[6];
+  double timestamp;
+};
+
+PointField
+makeField(const std::string & name, std::uint32_t offset, std::uint8_t datatype)
+{
+  PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = 1;
+  return field;
+}
+
+/** \brief Make an organized scan of \a nr_rings rings, with a few NaN returns, and \a row_padding
+  * bytes at the end of each row.
+  */
+PointCloud2
+makeScan(std::uint32_t nr_rings, std::uint32_t nr_columns, std::uint32_t row_padding = 0)
+{
+  PointCloud2 cloud;
+  cloud.header.frame_id = "lidar";
+  cloud.height = nr_rings;
+  cloud.width = nr_columns;
+  cloud.fields = {
+    makeField("x", 0, PointField::FLOAT32), makeField("y", 4, PointField::FLOAT32),
+    makeField("z", 8, PointField::FLOAT32), makeField("intensity", 12, PointField::FLOAT32),
+    makeField("ring", 16, PointField::UINT16), makeField("timestamp", 24, PointField::FLOAT64)};
+  cloud.point_step = sizeof(LidarPoint);
+  cloud.row_step = nr_columns * cloud.point_step + row_padding;
+  cloud.is_dense = false;
+  cloud.data.assign(std::size_t(cloud.row_step) * nr_rings, 0xab);
+  for (std::uint32_t ring = 0; ring < nr_rings; ++ring) {
+    const float elevation = -0.4f + 0.8f * ring / nr_rings;
+    for (std::uint32_t column = 0; column < nr_columns; ++column) {
+      const float azimuth = 6.2831853f * column / nr_columns;
+      const float range = 10.0f + 3.0f * std::sin(azimuth * 5.0f) + 0.01f * (column % 7);
+      LidarPoint point;
+      std::memset(&point, 0, sizeof(point));
+      point.x = range * std::cos(elevation) * std::cos(azimuth);
+      point.y = range * std::cos(elevation) * std::sin(azimuth);
+      point.z = range * std::sin(elevation);
+      if ((ring * nr_columns + column) % 97 == 0) {
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN();
+      }
+      point.intensity = static_cast<float>((column * 13 + ring * 7) % 256);
+      point.ring = static_cast<std::uint16_t>(ring);
+      point.timestamp = 1.7e9 + column * 1e-5;
+      std::memcpy(
+        cloud.data.data() + ring * cloud.row_step + column * cloud.point_step, &point,
+        sizeof(point));
+    }
+  }
+  return cloud;
+}
+
+const LidarPoint &
+pointAt(const PointCloud2 & cloud, std::size_t row, std::size_t column)
+{
+  return *reinterpret_cast<const LidarPoint *>(
+    cloud.data.data() + row * cloud.row_step + column * cloud.point_step);
+}
+
+/** \brief Check that \a decoded holds the points of \a cloud, with x, y and z within half of
+  * \a precision.
+  */
+void
+expectSamePoints(const PointCloud2 & cloud, const PointCloud2 & decoded, double precision)
+{
+  ASSERT_EQ(decoded.height, cloud.height);
+  ASSERT_EQ(decoded.width, cloud.width);
+  ASSERT_EQ(decoded.point_step, cloud.point_step);
+  ASSERT_EQ(decoded.row_step, cloud.width * cloud.point_step);
+  ASSERT_EQ(decoded.data.size(), std::size_t(decoded.row_step) * decoded.height);
+  const float tolerance = static_cast<float>(precision / 2) + 1e-5f;
+  for (std::size_t row = 0; row < cloud.height; ++row) {
+    for (std::size_t column = 0; column < cloud.width; ++column) {
+      const LidarPoint & expected = pointAt(cloud, row, column);
+      const LidarPoint & actual = pointAt(decoded, row, column);
+      const float expected_xyz[3] = {expected.x, expected.y, expected.z};
+      const float actual_xyz[3] = {actual.x, actual.y, actual.z};
+      for (int i = 0; i < 3; ++i) {
+        if (std::isnan(expected_xyz[i])) {
+          ASSERT_TRUE(std::isnan(actual_xyz[i]));
+        } else {
+          ASSERT_NEAR(actual_xyz[i], expected_xyz[i], tolerance);
+        }
+      }
+      ASSERT_EQ(actual.intensity, expected.intensity);
+      ASSERT_EQ(actual.ring, expected.ring);
+      ASSERT_EQ(actual.timestamp, expected.timestamp);
+      // The padding is not transmitted
+      ASSERT_EQ(actual.padding[0], 0);
+    }
+  }
+}
+
+double
+elapsedMs(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+         .count();
+}
+}  // namespace
+
+TEST(PointCloudCodec, QuantizedRoundTrip)
+{
+  const PointCloud2 cloud = makeScan(16, 1000, 8);
+  for (pcl_ros::Compressor compressor :
+    {pcl_ros::Compressor::None, pcl_ros::Compressor::Lz4, pcl_ros::Compressor::Zstd})
+  {
+    pcl_ros::CodecOptions options;
+    options.compressor = compressor;
+    options.block_points = 3000;
+    CompressedPointCloud2 compressed;
+    ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, compressed));
+    EXPECT_EQ(compressed.format, pcl_ros::kQuantizedFormat);
+    EXPECT_EQ(compressed.header.frame_id, "lidar");
+    PointCloud2 decoded;
+    ASSERT_TRUE(pcl_ros::decodePointCloud(compressed, decoded));
+    expectSamePoints(cloud, decoded, options.precision);
+  }
+}
+
+TEST(PointCloudCodec, LosslessRoundTrip)
+{
+  const PointCloud2 cloud = makeScan(16, 1000);
+  pcl_ros::CodecOptions options;
+  options.precision = 0.0;
+  options.field_codecs["intensity"] = pcl_ros::FieldCodec::Delta;
+  options.field_codecs["timestamp"] = pcl_ros::FieldCodec::Delta;
+  CompressedPointCloud2 compressed;
+  ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, compressed));
+  PointCloud2 decoded;
+  ASSERT_TRUE(pcl_ros::decodePointCloud(compressed, decoded));
+  expectSamePoints(cloud, decoded, 0.0);
+}
+
+TEST(PointCloudCodec, UnroundableValuesStayExact)
+{
+  PointCloud2 cloud = makeScan(2, 100);
+  const float infinity = std::numeric_limits<float>::infinity();
+  std::memcpy(cloud.data.data(), &infinity, sizeof(infinity));
+  pcl_ros::CodecOptions options;
+  CompressedPointCloud2 compressed;
+  ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, compressed));
+  PointCloud2 decoded;
+  ASSERT_TRUE(pcl_ros::decodePointCloud(compressed, decoded));
+  EXPECT_EQ(pointAt(decoded, 0, 0).x, infinity);
+  EXPECT_EQ(pointAt(decoded, 0, 1).x, pointAt(cloud, 0, 1).x);
+}
+
+TEST(PointCloudCodec, ThreadsDoNotChangeTheEncoding)
+{
+  const PointCloud2 cloud = makeScan(16, 2000);
+  pcl_ros::CodecOptions options;
+  options.block_points = 4096;
+  CompressedPointCloud2 serial, parallel;
+  ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, serial));
+  options.num_threads = 4;
+  ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, parallel));
+  EXPECT_EQ(serial.compressed_data, parallel.compressed_data);
+  PointCloud2 decoded;
+  ASSERT_TRUE(pcl_ros::decodePointCloud(parallel, decoded, 4));
+  expectSamePoints(cloud, decoded, options.precision);
+}
+
+TEST(PointCloudCodec, RejectsInvalidInput)
+{
+  PointCloud2 cloud = makeScan(4, 100);
+  pcl_ros::CodecOptions options;
+  CompressedPointCloud2 compressed;
+  ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, compressed));
+  PointCloud2 decoded;
+
+  CompressedPointCloud2 truncated = compressed;
+  truncated.compressed_data.pop_back();
+  EXPECT_FALSE(pcl_ros::decodePointCloud(truncated, decoded));
+  CompressedPointCloud2 other_format = compressed;
+  other_format.format = "draco";
+  EXPECT_FALSE(pcl_ros::decodePointCloud(other_format, decoded));
+  CompressedPointCloud2 corrupted = compressed;
+  corrupted.compressed_data[0] = 'X';
+  EXPECT_FALSE(pcl_ros::decodePointCloud(corrupted, decoded));
+
+  cloud.data.resize(cloud.data.size() / 2);
+  EXPECT_FALSE(pcl_ros::encodePointCloud(cloud, options, compressed));
+}
+
+TEST(PointCloudCodec, RejectsLayoutsLargerThanTheData)
+{
+  const PointCloud2 cloud = makeScan(4, 100);
+  for (pcl_ros::Compressor compressor :
+    {pcl_ros::Compressor::None, pcl_ros::Compressor::Lz4, pcl_ros::Compressor::Zstd})
+  {
+    pcl_ros::CodecOptions options;
+    options.compressor = compressor;
+    CompressedPointCloud2 compressed;
+    ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, compressed));
+
+    // The row step overflows 32 bits
+    CompressedPointCloud2 huge_step = compressed;
+    huge_step.point_step = 0x40000000u;
+    PointCloud2 decoded;
+    EXPECT_FALSE(pcl_ros::decodePointCloud(huge_step, decoded));
+    EXPECT_TRUE(decoded.data.empty());
+
+    // Fits in 32 bits, but the points would be mostly padding that the data does not code
+    CompressedPointCloud2 padded = compressed;
+    padded.point_step = 4096;
+    EXPECT_FALSE(pcl_ros::decodePointCloud(padded, decoded));
+    EXPECT_TRUE(decoded.data.empty());
+
+    // More points than the blocks code
+    CompressedPointCloud2 wide = compressed;
+    wide.width = 0xffffffffu;
+    EXPECT_FALSE(pcl_ros::decodePointCloud(wide, decoded));
+    EXPECT_TRUE(decoded.data.empty());
+  }
+}
+
+TEST(PointCloudCodec, Benchmark)
+{
+  // A 128 ring scan of 2048 columns, 262144 points
+  const PointCloud2 cloud = makeScan(128, 2048);
+  rclcpp::Serialization<PointCloud2> raw_serialization;
+  rclcpp::Serialization<CompressedPointCloud2> compressed_serialization;
+  const int nr_runs = 5;
+
+  rclcpp::SerializedMessage raw;
+  auto start = std::chrono::steady_clock::now();
+  for (int run = 0; run < nr_runs; ++run) {
+    raw_serialization.serialize_message(&cloud, &raw);
+  }
+  const double raw_ms = elapsedMs(start) / nr_runs;
+  std::cout << "raw: " << raw.size() << " bytes, serialize " << raw_ms << " ms" << std::endl;
+
+  for (pcl_ros::Compressor compressor : {pcl_ros::Compressor::Lz4, pcl_ros::Compressor::Zstd}) {
+    for (int num_threads : {1, 4}) {
+      pcl_ros::CodecOptions options;
+      options.compressor = compressor;
+      options.num_threads = num_threads;
+      CompressedPointCloud2 compressed;
+      rclcpp::SerializedMessage serialized;
+      start = std::chrono::steady_clock::now();
+      for (int run = 0; run < nr_runs; ++run) {
+        ASSERT_TRUE(pcl_ros::encodePointCloud(cloud, options, compressed));
+        compressed_serialization.serialize_message(&compressed, &serialized);
+      }
+      const double encode_ms = elapsedMs(start) / nr_runs;
+
+      PointCloud2 decoded;
+      start = std::chrono::steady_clock::now();
+      for (int run = 0; run < nr_runs; ++run) {
+        ASSERT_TRUE(pcl_ros::decodePointCloud(compressed, decoded, num_threads));
+      }
+      const double decode_ms = elapsedMs(start) / nr_runs;
+      expectSamePoints(cloud, decoded, options.precision);
+
+      const double ratio = static_cast<double>(raw.size()) / serialized.size();
+      std::cout << (compressor == pcl_ros::Compressor::Lz4 ? "lz4" : "zstd") << ", " <<
+        num_threads << " threads: " << serialized.size() << " bytes (" << ratio <<
+        "x smaller), encode and serialize " << encode_ms << " ms, decode " << decode_ms <<
+        " ms" << std::endl;
+      // Padding alone is a fifth of the raw size
+      EXPECT_GT(ratio, 2.0);
+    }
+  }
+}
+
+class CompressedTopicTest : public ::testing::Test
+{
+protected:
+  static void
+  SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void
+  TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(CompressedTopicTest, SubscriberReceivesDecodedClouds)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "compressed_topic_test", rclcpp::NodeOptions().use_global_arguments(false));
+  const PointCloud2 cloud = makeScan(16, 500);
+  pcl_ros::CompressedPublisher publisher(
+    *node, "points", rclcpp::QoS(1), pcl_ros::CodecOptions());
+
+  PointCloud2::ConstSharedPtr received;
+  pcl_ros::CompressedSubscriber subscriber(
+    *node, "points", "quantized", rclcpp::QoS(1),
+    [&received](const PointCloud2::ConstSharedPtr & decoded) {received = decoded;});
+  EXPECT_EQ(subscriber.getTopic(), "/points/quantized");
+  EXPECT_THROW(
+    pcl_ros::CompressedSubscriber(
+      *node, "points", "draco", rclcpp::QoS(1), [](const PointCloud2::ConstSharedPtr &) {}),
+    std::runtime_error);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!received && std::chrono::steady_clock::now() < deadline) {
+    publisher.publish(cloud);
+    executor.spin_some(std::chrono::milliseconds(50));
+  }
+  ASSERT_TRUE(received);
+  EXPECT_EQ(publisher.getNumSubscribers(), 1u);
+  expectSamePoints(cloud, *received, pcl_ros::CodecOptions().precision);
+}
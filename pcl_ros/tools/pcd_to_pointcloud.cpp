@@ -45,6 +45,7 @@
 
 // STL
 #include <chrono>
+#include <memory>
 #include <string>
 #include <thread>
 
@@ -58,6 +59,7 @@
 #include "rclcpp_components/register_node_macro.hpp"
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <pcl_conversions/pcl_conversions.h>
+#include "pcl_ros/transport/compressed_point_cloud.hpp"
 
 namespace pcl_ros
 {
@@ -74,6 +76,7 @@ public:
   size_t period_ms_;
 
   std::shared_ptr<rclcpp::Publisher<sensor_msgs::msg::PointCloud2>> pub_;
+  std::unique_ptr<CompressedPublisher> compressed_pub_;
   rclcpp::TimerBase::SharedPtr timer_;
 
   ////////////////////////////////////////////////////////////////////////////////
@@ -99,6 +102,11 @@ public:
       this->get_node_topics_interface()->resolve_topic_name(cloud_topic_);
 
     pub_ = this->create_publisher<sensor_msgs::msg::PointCloud2>(cloud_topic_, 10);
+    if (this->declare_parameter("compressed", false)) {
+      // Also publish on cloud_pcd/quantized, see the compression.* parameters
+      compressed_pub_ = std::make_unique<CompressedPublisher>(
+        *this, cloud_topic_, rclcpp::QoS(10), declareCodecParameters(*this, "compression"));
+    }
     timer_ = this->create_wall_timer(
       std::chrono::milliseconds(period_ms_),
       [this]() {
@@ -120,6 +128,9 @@ public:
   {
     cloud_.header.stamp = this->get_clock()->now();
     pub_->publish(cloud_);
+    if (compressed_pub_) {
+      compressed_pub_->publish(cloud_);
+    }
   }
 };
 }  // namespace pcl_ros